@@ -0,0 +1,173 @@
+#include "codec.h"
+#include "game.h"
+#include "game_batch.h"
+#include "instruction.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+
+//Builds a bomber which fills its program with writes of 0xFFFF, an invalid instruction, to every
+// 0x0107th pair of bytes ahead of it. Nearly every instruction it runs writes to RAM and changes
+// who owns it, which is the worst case for keeping RAM and its owners up to date.
+static std::string bomber(uint16_t size) {
+    Memory ram;
+    uint16_t addr = 0;
+    Instruction::constructInstruction(ram, addr, OPCode::MOV, AccessMode::DIRECT, AccessMode::DIRECT,
+                                      Location::BX, Location::IMD);
+    ram[addr + 2] = 0xFF; ram[addr + 3] = 0xFF;
+    for(addr += 4; addr + 6 <= size; addr += 6) {
+        Instruction::constructInstruction(ram, addr, OPCode::MOV, AccessMode::RELATIVE, AccessMode::DIRECT,
+                                          Location::PAX, Location::BX);
+        Instruction::constructInstruction(ram, addr + 2, OPCode::ADD, AccessMode::DIRECT, AccessMode::DIRECT,
+                                          Location::AX, Location::IMD);
+        ram[addr + 4] = 0x01; ram[addr + 5] = 0x07;
+    }
+
+    uint8_t bytes[0x10000];
+    ram.copyBytes(0, addr, bytes);
+    return Codec::base64Encode(bytes, addr);
+}
+
+//Builds a warrior which only moves BX to AX, it never writes RAM so it lives until the game ends.
+static std::string mover(uint16_t size) {
+    Memory ram;
+    uint16_t addr;
+    for(addr = 0; addr + 2 <= size; addr += 2)
+        Instruction::constructInstruction(ram, addr, OPCode::MOV, AccessMode::DIRECT, AccessMode::DIRECT,
+                                          Location::AX, Location::BX);
+
+    uint8_t bytes[0x10000];
+    ram.copyBytes(0, addr, bytes);
+    return Codec::base64Encode(bytes, addr);
+}
+
+//Enough bombers to fill RAM so there is no empty space for them to run through
+static const uint8_t PLAYERS = 16;
+//Players in the free-for-all
+static const uint8_t FFA_PLAYERS = 200;
+//Forks of one game which are all kept at once
+static const uint32_t FORKS = 1000;
+
+//Times games between bombers with the layout of Memory this was built with, each constructed
+// alone, then played by a GameBatch one at a time and then in lockstep, then a free-for-all with each scheduler, then forks of
+// a game played a little further each
+//usage: oblivios_benchmark [games], 100 if not given
+int main(int argc, char** argv) {
+    const uint32_t games = argc > 1 ? (uint32_t)std::strtoul(argv[1], nullptr, 10) : 100;
+    const std::string warrior = bomber(4096);
+
+    Json config = {
+        {"max_player_size", 4096},
+        {"cycles_per_turn", 100},
+        {"max_cycles", 1000000},
+        {"ram_access_cycles", 8},
+        {"ram_double_access_penalty", 8},
+        {"score_for_killing_thread", 1000},
+        {"score_for_killing_process", 1000000},
+        {"score_for_owning_ram", 0.1},
+        {"num_players", PLAYERS},
+        {"player_settings", Json::array()},
+        {"warriors", std::vector<std::string>(PLAYERS, warrior)},
+        {"op_cycles", { {"NOP", 1}, {"MOV", 2}, {"ADD", 4} }},
+        {"dispatch", "threaded"},
+        {"log_events", "none"}
+    };
+
+#if defined(OBLIVIOS_PAGED_MEMORY)
+    std::cout << "layout: paged" << std::endl;
+#elif defined(OBLIVIOS_INTERLEAVED_MEMORY)
+    std::cout << "layout: interleaved" << std::endl;
+#else
+    std::cout << "layout: split" << std::endl;
+#endif
+
+    std::ostream log(nullptr);
+    uint64_t scores = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for(uint32_t x = 0; x < games; ++x) {
+        config["seed"] = x;
+        Game game(config);
+        game.run(log);
+        for(uint8_t pid = 1; pid <= PLAYERS; ++pid) scores += game.score(pid);
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << "games: " << games << std::endl;
+    std::cout << "seconds: " << elapsed.count() << std::endl;
+    std::cout << "ms per game: " << (games ? elapsed.count() * 1000 / games : 0) << std::endl;
+    std::cout << "total score: " << scores << std::endl;
+
+    //the same games reusing one game's memory
+    std::vector<Json> changes;
+    for(uint32_t x = 0; x < games; ++x) changes.push_back({{"seed", x}});
+    GameBatch batch(config);
+    uint64_t reused_scores = 0;
+    const auto reused_start = std::chrono::steady_clock::now();
+    for(const Json& game : changes)
+        for(uint32_t score : batch.play(game).scores) reused_scores += score;
+    const std::chrono::duration<double> reused_elapsed = std::chrono::steady_clock::now() - reused_start;
+
+    std::cout << "reused ms per game: " << (games ? reused_elapsed.count() * 1000 / games : 0) << std::endl;
+    std::cout << "reused total score: " << reused_scores << std::endl;
+
+    //and played in lockstep, reusing a game for each lane
+    uint64_t batch_scores = 0;
+    const auto batch_start = std::chrono::steady_clock::now();
+    for(const GameBatch::Result& result : batch.run(changes))
+        for(uint32_t score : result.scores) batch_scores += score;
+    const std::chrono::duration<double> batch_elapsed = std::chrono::steady_clock::now() - batch_start;
+
+    std::cout << "batched ms per game: " << (games ? batch_elapsed.count() * 1000 / games : 0) << std::endl;
+    std::cout << "batched total score: " << batch_scores << std::endl;
+
+    //a free-for-all of warriors whose instructions take several turns, so most turns only stall
+    Json ffa = config;
+    ffa["max_cycles"] = 20000000;
+    ffa["max_player_size"] = 256;
+    ffa["cycles_per_turn"] = 40;
+    ffa["num_players"] = FFA_PLAYERS;
+    ffa["player_settings"] = std::vector<Json>(FFA_PLAYERS, {{"name", "Mover"}, {"cycle_modifer", 1}, {"max_threads", 8}});
+    ffa["warriors"] = std::vector<std::string>(FFA_PLAYERS, mover(256));
+    ffa["op_cycles"] = { {"NOP", 1}, {"MOV", 1000} };
+    for(const char* scheduler : {"rounds", "events"}) {
+        ffa["scheduler"] = scheduler;
+        uint64_t ffa_scores = 0;
+        const auto ffa_start = std::chrono::steady_clock::now();
+        for(uint32_t x = 0; x < games; ++x) {
+            ffa["seed"] = x;
+            Game game(ffa);
+            game.run(log);
+            for(uint8_t pid = 1; pid <= FFA_PLAYERS; ++pid) ffa_scores += game.score(pid);
+        }
+        const std::chrono::duration<double> ffa_elapsed = std::chrono::steady_clock::now() - ffa_start;
+
+        std::cout << "free-for-all " << scheduler << " ms per game: "
+                  << (games ? ffa_elapsed.count() * 1000 / games : 0) << std::endl;
+        std::cout << "free-for-all " << scheduler << " total score: " << ffa_scores << std::endl;
+    }
+
+    //branches of a game part way through, which share the RAM they do not write when it is paged
+    config["seed"] = 0;
+    Game paused(config);
+    paused.pauseAt(20000);
+    paused.run(log);
+    std::vector<Game*> forks;
+    uint64_t fork_scores = 0;
+    const auto fork_start = std::chrono::steady_clock::now();
+    for(uint32_t x = 0; x < FORKS; ++x) {
+        forks.push_back(paused.fork());
+        forks.back()->pauseAt(20000 + 100 * (x % 50));
+        forks.back()->run(log);
+        for(uint8_t pid = 1; pid <= PLAYERS; ++pid) fork_scores += forks.back()->score(pid);
+    }
+    const std::chrono::duration<double> fork_elapsed = std::chrono::steady_clock::now() - fork_start;
+    for(Game* fork : forks) delete fork;
+
+    std::cout << "forks: " << FORKS << std::endl;
+    std::cout << "ms per fork: " << fork_elapsed.count() * 1000 / FORKS << std::endl;
+    std::cout << "fork total score: " << fork_scores << std::endl;
+    return 0;
+}
@@ -0,0 +1,33 @@
+#include "binary_log.h"
+#include "event_log.h"
+
+#include <fstream>
+#include <iostream>
+
+
+//Converts a binary log back into the JSON stream viewers read
+//usage: oblivios_logdump [binary log], reads from stdin if no file is given
+int main(int argc, char** argv) {
+    std::ios::sync_with_stdio(false);
+
+    std::ifstream file;
+    if(argc > 1) {
+        file.open(argv[1], std::ios::binary);
+        if(!file) {
+            std::cerr << "Could not open " << argv[1] << std::endl;
+            return 1;
+        }
+    }
+
+    JsonEventLog json(std::cout);
+    try {
+        BinaryLogReader reader(argc > 1 ? file : std::cin);
+        reader.replay(json);
+    }
+    catch(std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
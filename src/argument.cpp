@@ -1,40 +1,37 @@
 #include "argument.h"
 
 #include "instruction.h"
+#include "instruction_cache.h"
 #include "thread.h"
 
+#include <stdexcept>
+
 #define REGISTER(loc, reg, type)    \
     Location::loc:                  \
-    loc_type = type;                \
+    loc_type = ArgType::type;       \
     location.r = &thread.reg;
 
-//size of the current instruction, needed in relative addressing because the IP will not be
-// incremented until after the arguments are determined.
-#define INS_SIZE Instruction::getSize(ram, thread.ip)
-
+//relative addressing is from the end of the instruction because the IP will not be incremented
+// until after the arguments are determined.
 #define REGISTER_PTR(loc, reg)           \
     Location::loc:                       \
-    loc_type = M;                        \
-    if(mode == AccessMode::RELATIVE)     \
+    loc_type = ArgType::M;               \
+    if(arg.mode == AccessMode::RELATIVE) \
         location.m = thread.ip +         \
-        INS_SIZE +                       \
+        ins.size +                       \
         (int16_t)thread.reg;             \
     else location.m = thread.reg;
 
-Argument::Argument(Thread& thread, uint8_t* ram, uint8_t argn) : ram(ram), loc_type(NONE), read_only(false) {
-    Location loc;
-    AccessMode mode;
-    if(argn == 1) {
-        loc = Instruction::getArg1Loc(ram, thread.ip);
-        mode = Instruction::getArg1Mode(ram, thread.ip);
-    }
-    else if(argn == 2) {
-        loc = Instruction::getArg2Loc(ram, thread.ip);
-        mode = Instruction::getArg2Mode(ram, thread.ip);
-    }
-    else throw std::out_of_range("Invalid argument number " + argn);
+Argument::Argument(Thread& thread, Memory& ram, uint8_t argn) :
+        Argument(thread, ram, DecodedInstruction(ram, thread.ip), argn) {}
 
-    switch(loc) {
+Argument::Argument(Thread& thread, Memory& ram, const DecodedInstruction& ins, uint8_t argn,
+                   InstructionCache* cache, Ownership* ownership) : ram(ram), loc_type(ArgType::NONE),
+        read_only(false), cache(cache), ownership(ownership) {
+    if(argn != 1 && argn != 2) throw std::out_of_range("Invalid argument number " + argn);
+    const DecodedArgument& arg = ins.arg(argn);
+
+    switch(arg.loc) {
         case REGISTER(AL, ax, R8L); break;
         case REGISTER(AH, ax, R8H); break;
         case REGISTER(BL, bx, R8L); break;
@@ -51,95 +48,36 @@ Argument::Argument(Thread& thread, uint8_t* ram, uint8_t argn) : ram(ram), loc_t
         case REGISTER_PTR(PCX, cx); break;
 
         case Location::IMD:
-            loc_type = M16;
-            location.m = Instruction::getImdAddress(ram, thread.ip, argn);
+            loc_type = ArgType::M16;
+            location.m = arg.addr;
             break;
 
         case Location::PIMD:
-            loc_type = M;
-
-            uint16_t imd;
-            imd = Instruction::getImdAddress(ram, thread.ip, argn); //the address of the imd
-            imd = (ram[imd] << 8) | (ram[(uint16_t)(imd + 1)]); //the value stored at the imd
-
-            if(mode == AccessMode::RELATIVE) {
-                //add to the ip the value stored in the memory location of the immediate value
-                location.m = thread.ip + INS_SIZE + imd;
-            } else {
-                //take the value of immediate as the address
-                location.m = imd;
-            }
+            loc_type = ArgType::M;
+            location.m = arg.addr;
             break;
 
-        case Location::NONE: throw std::invalid_argument("Invalid location"); break;
+        case Location::NONE: break; //reported by the decoder as Fault::INVALID_LOCATION
     }
 }
 
-uint16_t Argument::read(bool force8) const {
-    uint16_t v = 0x0000;
-    switch(loc_type) {
-        case R16:
-            v = *location.r;
-            if(force8) v &= 0x00FF;
-            break;
-        case R8L:
-            v = (uint8_t)(*location.r);
-            break;
-        case R8H:
-            v = *location.r >> 8;
-            break;
-        case M:
-            v = ram[location.m];
-            if(!force8) {
-                v <<= 8;
-                v |= ram[(uint16_t)(location.m + 1)];
-            }
-            break;
-        case M16:
-            if(!force8) {
-                v = ram[location.m];
-                v <<= 8;
-            }
-            v |= ram[(uint16_t)(location.m + 1)];
-            break;
-        case NONE:
-            throw std::runtime_error("Program attempted to read from invalid memory");
+//Calls the version of func for the argument's type
+#define TYPED(func, args)                                       \
+    switch(loc_type) {                                          \
+        case ArgType::M:    return func<ArgType::M>args;        \
+        case ArgType::M16:  return func<ArgType::M16>args;      \
+        case ArgType::R8L:  return func<ArgType::R8L>args;      \
+        case ArgType::R8H:  return func<ArgType::R8H>args;      \
+        case ArgType::R16:  return func<ArgType::R16>args;      \
+        default:            return func<ArgType::NONE>args;     \
     }
-    return v;
+
+uint16_t Argument::read(bool force8) const {
+    TYPED(readAs, (force8))
 }
 
 uint16_t Argument::write(uint16_t v, const bool memforce8) {
-    if(read_only) throw std::runtime_error("Program attempted to write to read-only memory");
-
-    switch(loc_type) {
-        case R16:
-            *location.r = v;
-            break;
-        case R8L:
-            *location.r &= 0xFF00;
-            v &= 0x00FF;
-            *location.r += v;
-            break;
-        case R8H:
-            *location.r &= 0x00FF;
-            v <<= 8;
-            *location.r += v;
-            break;
-        case M:
-            if(memforce8) {
-                v &= 0x00FF;
-                ram[location.m] = (uint8_t)v;
-                break;
-            }
-            // else follow M16 case
-        case M16:
-            ram[(uint16_t)(location.m + 1)] = (uint8_t)v;
-            ram[location.m] = (uint8_t)(v >> 8);
-            break;
-        case NONE:
-            throw std::runtime_error("Program attempted to write to invalid memory");
-    }
-    return v;
+    TYPED(writeAs, (v, memforce8))
 }
 
 void Argument::swp(Argument& other) {
@@ -149,24 +87,11 @@ void Argument::swp(Argument& other) {
 }
 
 bool Argument::is8Bit() const {
-    switch(loc_type) {
-        //technically M is defaulted to 8bit, but can be 16bit
-        case M: case R8L: case R8H:
-            return true;
-
-        case M16: case R16: case NONE:
-            return false;
-    }
+    TYPED(is8BitAs, ())
 }
 
 bool Argument::isMem() const {
-    switch(loc_type) {
-        case M: case M16:
-            return true;
-
-        case R8L: case R8H: case R16: case NONE:
-            return false;
-    }
+    TYPED(isMemAs, ())
 }
 
 bool Argument::isReg() const {
@@ -174,18 +99,23 @@ bool Argument::isReg() const {
 }
 
 bool Argument::sign(bool force8) const {
-    const uint16_t v = read();
-    //force8 only alters M16 and R16 because they are guaranteed to be truncated from high-order
-    // bits, whereas if RAM is treated as 16bits, it expands into the low order rather than the
-    // high-order. (Thus RAM truncates lower-order).
-    switch(loc_type) {
-        case M:
-            return (v & 0x8000) != 0;
-        case R8L: case R8H:
-            return (v & 0x0080) != 0;
-        case M16: case R16:
-            return force8 ? (v & 0x0080) != 0 : (v & 0x8000) != 0;
-        case NONE:
-            return false;
+    TYPED(signAs, (force8))
+}
+
+ArgType Argument::typeOf(Location loc) {
+    switch(loc) {
+        case Location::AL: case Location::BL: case Location::CL:
+            return ArgType::R8L;
+        case Location::AH: case Location::BH: case Location::CH:
+            return ArgType::R8H;
+        case Location::AX: case Location::BX: case Location::CX: case Location::IP:
+            return ArgType::R16;
+        case Location::PAX: case Location::PBX: case Location::PCX: case Location::PIMD:
+            return ArgType::M;
+        case Location::IMD:
+            return ArgType::M16;
+        case Location::NONE:
+        default:
+            return ArgType::NONE;
     }
-}
\ No newline at end of file
+}
@@ -1,7 +1,17 @@
 #pragma once
 struct Thread;
+struct DecodedInstruction;
 
 #include <cstdint>
+#include "instruction_cache.h"
+#include "ownership.h"
+
+
+/**
+ * The kind of storage an argument refers to. M refers to scalable memory/RAM, M16 refers to memory
+ * which is only 16bits (immediates), R to registers, and NONE only happens if route value is invalid
+ */
+enum class ArgType : uint8_t { M, M16, R8L, R8H, R16, NONE };
 
 
 /**
@@ -17,20 +27,23 @@ struct Thread;
  */
 class Argument {
     /// stores reference to game's ram to reduce number of params
-    uint8_t* ram;
+    Memory& ram;
 
     /// m just stores the index into ram, r is a pointer to the register in the thread
     union { uint16_t m; uint16_t* r; } location;
 
-    /**
-     * M refers to scalable memory/RAM, M16 refers to memory which is only 16bits,
-     * R to registers, and NONE only happens if route value is invalid
-     */
-    enum { M, M16, R8L, R8H, R16, NONE } loc_type;
+    /// What kind of storage the location refers to
+    ArgType loc_type;
 
     /// true if it should not be written to
     bool read_only;
 
+    /// cache to invalidate when RAM is written, may be null
+    InstructionCache* cache;
+
+    /// ownership to give RAM which is written to the writer, may be null
+    Ownership* ownership;
+
 public:
 
     /**
@@ -41,6 +54,13 @@ public:
      */
     static inline bool is8BitOp(const Argument& arg1, const Argument& arg2);
 
+    /**
+     * Gets the type of argument a location will resolve to.
+     * @param loc The location of the argument.
+     * @return The type, NONE if the location is not valid.
+     */
+    static ArgType typeOf(Location loc);
+
     //Do not allow default construction
     Argument() = delete;
 
@@ -48,16 +68,29 @@ public:
      * Constructs an argument using values in thread and RAM. This will store a pointer/reference to
      * the value it wants to keep, but not take ownership of it.
      * @param thread The current thread, includes the IP
-     * @param ram A pointer to the beginning of RAM
+     * @param ram The game's RAM
+     * @param argn The number of the argument, starting at 1 (currently only 1 and 2 are valid)
+     */
+    Argument(Thread& thread, Memory& ram, uint8_t argn = 1);
+
+    /**
+     * Constructs an argument from an already decoded instruction rather than decoding it from RAM.
+     * @param thread The current thread, includes the IP
+     * @param ram The game's RAM
+     * @param ins The decoded instruction at the thread's IP
      * @param argn The number of the argument, starting at 1 (currently only 1 and 2 are valid)
+     * @param cache If set, cached instructions are invalidated whenever this argument writes to RAM
+     * @param ownership If set, RAM this argument writes to belongs to the writer from then on
      */
-    Argument(Thread& thread, uint8_t* ram, uint8_t argn = 1);
+    Argument(Thread& thread, Memory& ram, const DecodedInstruction& ins, uint8_t argn,
+             InstructionCache* cache = nullptr, Ownership* ownership = nullptr);
 
     /**
      * Reads up to 16 bits. If the data stores less, it will pad the most significant bits with 0s.
      * @param force8 Will force reading the value as 8bits rather than 16bits.
-     * @throws std::runtime_error if the memory is invalid and cannot be read.
-     * @return The value read.
+     * @return The value read, 0 if the location is invalid.
+     *
+     * @note Invalid locations are reported as Fault::INVALID_LOCATION when decoding.
      */
     uint16_t read(bool force8 = false) const;
 
@@ -65,8 +98,10 @@ public:
      * Writes to this argument the value of data
      * @param src Place to copy from
      * @param memforce8 Forces a write to memory to use only 8 bits instead of 16 bits
-     * @throws std::runtime_exception if this argument is read-only
-     * @throws std::invalid_argument if number of bits is invalid
+     *
+     * @note
+     *  Writes to read-only or invalid locations are ignored, the decoder reports them as
+     *  Fault::READ_ONLY or Fault::INVALID_LOCATION before the instruction is run.
      *
      * @note Uses a Bigendian interpretation of RAM
      *
@@ -111,11 +146,74 @@ public:
      * Swaps the data stored at the location. This is not a true object swap such as std::swap,
      * rather it is functionality for the SWPx opcodes.
      * @param other The place to swap with
-     * @param bits The number of bits to read/write (8, 16, 32)
-     * @throws std::runtime_exception if either Argument is read-only or invalid
-     * @throws std::invalid_argument if the number of bits is invalid
      */
     void swp(Argument& other);
+
+    /**
+     * @return The kind of storage this argument refers to.
+     */
+    ArgType type() const { return loc_type; }
+
+    /**
+     * @return The address of the first byte in RAM, only meaningful if isMem().
+     */
+    uint16_t address() const { return location.m; }
+
+    /**
+     * Reads as if the argument were of type T, without checking what it actually is.
+     * @see read
+     */
+    template<ArgType T> inline uint16_t readAs(bool force8 = false) const;
+
+    /**
+     * Writes as if the argument were of type T, without checking what it actually is.
+     * @see write
+     */
+    template<ArgType T> inline uint16_t writeAs(uint16_t data, bool memforce8 = true);
+
+    /// @see sign
+    template<ArgType T> inline bool signAs(bool force8 = false) const;
+
+    /// @see is8Bit
+    template<ArgType T> static constexpr bool is8BitAs();
+
+    /// @see isMem
+    template<ArgType T> static constexpr bool isMemAs();
+};
+
+
+/**
+ * A view of an Argument whose type is known at compile time, so none of its operations need to
+ * check what kind of storage it is. It has the same interface as Argument so the operators can be
+ * written once for both.
+ * @warning T must be the type of the Argument.
+ */
+template<ArgType T>
+class TypedArgument {
+    Argument& arg;
+
+public:
+    explicit TypedArgument(Argument& arg) : arg(arg) {}
+
+    uint16_t read(bool force8 = false) const { return arg.readAs<T>(force8); }
+
+    uint16_t write(uint16_t data, bool memforce8 = true) { return arg.writeAs<T>(data, memforce8); }
+
+    template<class A> uint16_t write(const A& src) { return write(src.read(), src.is8Bit()); }
+
+    static constexpr bool is8Bit() { return Argument::is8BitAs<T>(); }
+
+    static constexpr bool isMem() { return Argument::isMemAs<T>(); }
+
+    static constexpr bool isReg() { return !isMem(); }
+
+    bool sign(bool force8 = false) const { return arg.signAs<T>(force8); }
+
+    template<class A> void swp(A& other) {
+        const uint16_t t = other.read();
+        other.write(*this);
+        write(t, other.is8Bit());
+    }
 };
 
 
@@ -133,3 +231,115 @@ inline bool Argument::is8BitOp(const Argument& arg1, const Argument& arg2) {
 
     return !_16b;
 }
+
+
+
+template<ArgType T>
+inline uint16_t Argument::readAs(bool force8) const {
+    //read through a const Memory so a page of RAM shared with a fork is not copied to be read
+    const Memory& memory = ram;
+    uint16_t v = 0x0000;
+    switch(T) {
+        case ArgType::R16:
+            v = *location.r;
+            if(force8) v &= 0x00FF;
+            break;
+        case ArgType::R8L:
+            v = (uint8_t)(*location.r);
+            break;
+        case ArgType::R8H:
+            v = *location.r >> 8;
+            break;
+        case ArgType::M:
+            v = memory[location.m];
+            if(!force8) {
+                v <<= 8;
+                v |= memory[(uint16_t)(location.m + 1)];
+            }
+            break;
+        case ArgType::M16:
+            if(!force8) {
+                v = memory[location.m];
+                v <<= 8;
+            }
+            v |= memory[(uint16_t)(location.m + 1)];
+            break;
+        case ArgType::NONE:
+            break;
+    }
+    return v;
+}
+
+template<ArgType T>
+inline uint16_t Argument::writeAs(uint16_t v, const bool memforce8) {
+    if(read_only) return v;
+
+    switch(T) {
+        case ArgType::R16:
+            *location.r = v;
+            break;
+        case ArgType::R8L:
+            *location.r &= 0xFF00;
+            v &= 0x00FF;
+            *location.r += v;
+            break;
+        case ArgType::R8H:
+            *location.r &= 0x00FF;
+            v <<= 8;
+            *location.r += v;
+            break;
+        case ArgType::M:
+            if(memforce8) {
+                v &= 0x00FF;
+                if(ownership) ownership->overwrite(location.m, (uint8_t)v);
+                ram[location.m] = (uint8_t)v;
+                if(cache) cache->invalidate(location.m);
+                if(ownership) ownership->write(location.m);
+                break;
+            }
+            // else follow M16 case
+            //fallthrough
+        case ArgType::M16:
+            if(ownership) {
+                ownership->overwrite((uint16_t)(location.m + 1), (uint8_t)v);
+                ownership->overwrite(location.m, (uint8_t)(v >> 8));
+            }
+            ram[(uint16_t)(location.m + 1)] = (uint8_t)v;
+            ram[location.m] = (uint8_t)(v >> 8);
+            if(cache) cache->invalidate(location.m, 2);
+            if(ownership) ownership->write(location.m, 2);
+            break;
+        case ArgType::NONE:
+            break;
+    }
+    return v;
+}
+
+template<ArgType T>
+inline bool Argument::signAs(bool force8) const {
+    const uint16_t v = readAs<T>();
+    //force8 only alters M16 and R16 because they are guaranteed to be truncated from high-order
+    // bits, whereas if RAM is treated as 16bits, it expands into the low order rather than the
+    // high-order. (Thus RAM truncates lower-order).
+    switch(T) {
+        case ArgType::M:
+            return (v & 0x8000) != 0;
+        case ArgType::R8L: case ArgType::R8H:
+            return (v & 0x0080) != 0;
+        case ArgType::M16: case ArgType::R16:
+            return force8 ? (v & 0x0080) != 0 : (v & 0x8000) != 0;
+        case ArgType::NONE:
+            return false;
+    }
+}
+
+template<ArgType T>
+constexpr bool Argument::is8BitAs() {
+    //technically M is defaulted to 8bit, but can be 16bit
+    return T == ArgType::M || T == ArgType::R8L || T == ArgType::R8H;
+}
+
+template<ArgType T>
+constexpr bool Argument::isMemAs() {
+    return T == ArgType::M || T == ArgType::M16;
+}
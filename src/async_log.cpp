@@ -0,0 +1,146 @@
+#include "async_log.h"
+
+#include <chrono>
+#include <stdexcept>
+
+
+AsyncEventLog::Policy AsyncEventLog::PolicyFromString(const std::string& s) {
+    if(s == "block") return Policy::BLOCK;
+    if(s == "drop") return Policy::DROP;
+    if(s == "coalesce") return Policy::COALESCE;
+    throw std::invalid_argument(s + " is not a valid log policy");
+}
+
+AsyncEventLog::AsyncEventLog(EventLog* sink, size_t capacity, Policy policy) : sink(sink),
+        policy(policy), ring(capacity), pushed(0), written(0), done(false), dropped_events(0) {
+    skipping.count = 0;
+    writer = std::thread(&AsyncEventLog::write, this);
+}
+
+AsyncEventLog::~AsyncEventLog() {
+    if(skipping.count) pushBlocking(skipping);
+    done.store(true, std::memory_order_release);
+    writer.join();
+    delete sink;
+}
+
+void AsyncEventLog::write() {
+    LogEvent batch[BATCH_SIZE];
+    std::vector<uint16_t> starts;
+
+    for(;;) {
+        const size_t n = ring.pop(batch, BATCH_SIZE);
+        if(!n) {
+            //the game is done once it stops pushing, but anything it pushed before that is kept
+            if(done.load(std::memory_order_acquire) && ring.empty()) break;
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+            continue;
+        }
+
+        for(size_t x = 0; x < n; ++x) {
+            const LogEvent& e = batch[x];
+            switch(e.kind) {
+                case LogEvent::Kind::INIT:
+                    starts.push_back(e.ip);
+                    if(starts.size() == e.count) {
+                        sink->init(e.cycle, starts);
+                        starts.clear();
+                    }
+                    break;
+                case LogEvent::Kind::EXEC:    sink->exec(e.cycle, e.pid, e.ip, e.end); break;
+                case LogEvent::Kind::STALL:   sink->stall(e.cycle, e.pid, e.ip); break;
+                case LogEvent::Kind::FAULT:   sink->fault(e.cycle, e.pid, e.ip, e.fault); break;
+                case LogEvent::Kind::TURN:    sink->turn(e.cycle, e.end, e.pid, e.count); break;
+                case LogEvent::Kind::SCORE:   sink->score(e.cycle, e.pid, e.count); break;
+                case LogEvent::Kind::END:     sink->end(e.cycle, (GameEnd)e.count, e.pid); break;
+                case LogEvent::Kind::SKIPPED: sink->skipped(e.cycle, e.end, e.count); break;
+                case LogEvent::Kind::FLUSH:   sink->flush(); break;
+            }
+        }
+        written.fetch_add(n, std::memory_order_release);
+    }
+
+    sink->flush();
+}
+
+void AsyncEventLog::pushBlocking(const LogEvent& e) {
+    while(!ring.push(e)) std::this_thread::yield();
+    ++pushed;
+}
+
+void AsyncEventLog::push(const LogEvent& e, bool droppable) {
+    //events left out must be reported before anything after them
+    if(skipping.count) {
+        if(ring.push(skipping)) {
+            ++pushed;
+            skipping.count = 0;
+        }
+        else if(droppable) {
+            ++dropped_events;
+            ++skipping.count;
+            skipping.end = e.end;
+            return;
+        }
+        else {
+            pushBlocking(skipping);
+            skipping.count = 0;
+        }
+    }
+
+    if(ring.push(e)) {
+        ++pushed;
+        return;
+    }
+
+    if(!droppable || policy == Policy::BLOCK) {
+        pushBlocking(e);
+        return;
+    }
+
+    ++dropped_events;
+    if(policy == Policy::COALESCE) {
+        skipping = { LogEvent::Kind::SKIPPED, 0, 0, Fault::NONE, 1, e.cycle, e.end };
+    }
+}
+
+void AsyncEventLog::init(uint64_t cycle, const std::vector<uint16_t>& starts) {
+    for(uint16_t start : starts)
+        push({ LogEvent::Kind::INIT, 0, start, Fault::NONE, (uint32_t)starts.size(), cycle, cycle }, false);
+}
+
+void AsyncEventLog::exec(uint64_t cycle, uint8_t pid, uint16_t ip, uint64_t end) {
+    push({ LogEvent::Kind::EXEC, pid, ip, Fault::NONE, 0, cycle, end });
+}
+
+void AsyncEventLog::stall(uint64_t cycle, uint8_t pid, uint16_t ip) {
+    push({ LogEvent::Kind::STALL, pid, ip, Fault::NONE, 0, cycle, cycle });
+}
+
+void AsyncEventLog::fault(uint64_t cycle, uint8_t pid, uint16_t ip, Fault fault) {
+    push({ LogEvent::Kind::FAULT, pid, ip, fault, 0, cycle, cycle }, false);
+}
+
+void AsyncEventLog::turn(uint64_t cycle, uint64_t end, uint8_t pid, uint32_t count) {
+    push({ LogEvent::Kind::TURN, pid, 0, Fault::NONE, count, cycle, end });
+}
+
+void AsyncEventLog::score(uint64_t cycle, uint8_t pid, uint32_t score) {
+    push({ LogEvent::Kind::SCORE, pid, 0, Fault::NONE, score, cycle, cycle }, false);
+}
+
+void AsyncEventLog::end(uint64_t cycle, GameEnd reason, uint8_t winner) {
+    push({ LogEvent::Kind::END, winner, 0, Fault::NONE, (uint32_t)reason, cycle, cycle }, false);
+}
+
+void AsyncEventLog::skipped(uint64_t cycle, uint64_t end, uint32_t count) {
+    push({ LogEvent::Kind::SKIPPED, 0, 0, Fault::NONE, count, cycle, end }, false);
+}
+
+void AsyncEventLog::flush() {
+    if(skipping.count) {
+        pushBlocking(skipping);
+        skipping.count = 0;
+    }
+    pushBlocking({ LogEvent::Kind::FLUSH, 0, 0, Fault::NONE, 0, 0, 0 });
+    while(written.load(std::memory_order_acquire) < pushed) std::this_thread::yield();
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "event_log.h"
+#include "spsc_ring.h"
+
+
+/**
+ * An event as it is passed from the game to the writer thread.
+ */
+struct LogEvent {
+    enum class Kind : uint8_t { INIT, EXEC, STALL, FAULT, TURN, SCORE, END, SKIPPED, FLUSH };
+
+    Kind kind;
+    uint8_t pid;
+    /// the instruction, or for INIT the start of the player's thread
+    uint16_t ip;
+    Fault fault;
+    /// INIT: number of players, TURN: instructions run, SCORE: the score, END: the GameEnd,
+    /// SKIPPED: events left out
+    uint32_t count;
+    uint64_t cycle, end;
+};
+
+
+/**
+ * Hands events to another thread which sends them to the actual log, so a slow log destination
+ * does not slow down the game. Events go through a lock-free ring and the writer thread sends
+ * them on in batches.
+ */
+class AsyncEventLog : public EventLog {
+public:
+    /// What to do with an event when the ring is full
+    enum class Policy : uint8_t {
+        /// Wait for the writer to make room, nothing is lost
+        BLOCK,
+        /// Leave out instructions and turns and count them, other events still wait
+        DROP,
+        /// Same as DROP but each run of left out events is replaced with a single skipped event
+        COALESCE
+    };
+
+    /**
+     * @param s The name of a policy, "block", "drop", or "coalesce".
+     * @throws std::invalid_argument if it is not a policy.
+     */
+    static Policy PolicyFromString(const std::string& s);
+
+private:
+    /// Most events the writer takes from the ring at a time
+    static const size_t BATCH_SIZE = 256;
+
+    EventLog* const sink;
+    const Policy policy;
+    SpscRing<LogEvent> ring;
+
+    /// Events pushed by the game and events handled by the writer
+    uint64_t pushed;
+    std::atomic<uint64_t> written;
+
+    std::atomic<bool> done;
+    uint64_t dropped_events;
+    /// Events left out since the last skipped event, only used when coalescing
+    LogEvent skipping;
+
+    std::thread writer;
+
+    /// Loop run by the writer thread.
+    void write();
+
+    /**
+     * Sends an event to the writer.
+     * @param droppable True if the event can be left out when the ring is full.
+     */
+    void push(const LogEvent& e, bool droppable = true);
+
+    /// Waits until the ring has room for the event.
+    void pushBlocking(const LogEvent& e);
+
+public:
+    AsyncEventLog(const AsyncEventLog&) = delete;
+    AsyncEventLog& operator=(const AsyncEventLog&) = delete;
+
+    /**
+     * Starts the writer thread.
+     * @param sink Where events are sent, deleted along with this.
+     * @param capacity Number of events the ring can hold.
+     * @param policy What to do when the ring is full.
+     */
+    AsyncEventLog(EventLog* sink, size_t capacity, Policy policy);
+
+    /// Waits for every event to be written, then stops the writer.
+    ~AsyncEventLog();
+
+    void init(uint64_t cycle, const std::vector<uint16_t>& starts) override;
+    void exec(uint64_t cycle, uint8_t pid, uint16_t ip, uint64_t end) override;
+    void stall(uint64_t cycle, uint8_t pid, uint16_t ip) override;
+    void fault(uint64_t cycle, uint8_t pid, uint16_t ip, Fault fault) override;
+    void turn(uint64_t cycle, uint64_t end, uint8_t pid, uint32_t count) override;
+    void score(uint64_t cycle, uint8_t pid, uint32_t score) override;
+    void end(uint64_t cycle, GameEnd reason, uint8_t winner) override;
+    void skipped(uint64_t cycle, uint64_t end, uint32_t count) override;
+
+    /// Waits until everything sent so far has been written and flushed by the sink.
+    void flush() override;
+
+    /// @return The number of events which were left out because the ring was full.
+    uint64_t dropped() const { return dropped_events; }
+};
@@ -0,0 +1,241 @@
+#include "binary_log.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+using BinaryLog::Record;
+using BinaryLog::RECORD_SIZE;
+
+
+static const char MAGIC[] = {'O', 'B', 'L', 'V'};
+
+static inline void write16(uint8_t* dst, uint16_t v) {
+    dst[0] = (uint8_t)v;
+    dst[1] = (uint8_t)(v >> 8);
+}
+
+static inline uint16_t read16(const uint8_t* src) {
+    return (uint16_t)(src[0] | (src[1] << 8));
+}
+
+//absolute cycles are stored in 56 bits after the type
+static inline void write56(uint8_t* dst, uint64_t v) {
+    for(int x = 0; x < 7; ++x) dst[x] = (uint8_t)(v >> (8 * x));
+}
+
+static inline uint64_t read56(const uint8_t* src) {
+    uint64_t v = 0;
+    for(int x = 0; x < 7; ++x) v |= (uint64_t)src[x] << (8 * x);
+    return v;
+}
+
+
+BinaryEventLog::BinaryEventLog(std::ostream& out) : out(out), buffered(0), last_cycle(0) {
+    std::fill_n(last_ip, 256, 0);
+
+    uint8_t* r = next();
+    std::fill_n(r, RECORD_SIZE, 0);
+    r[0] = (uint8_t)Record::HEADER;
+    std::copy(MAGIC, MAGIC + 4, r + 1);
+    r[5] = BinaryLog::VERSION;
+}
+
+BinaryEventLog::~BinaryEventLog() {
+    flush();
+}
+
+uint8_t* BinaryEventLog::next() {
+    if(buffered == BUFFER_RECORDS) drain();
+    return buffer + RECORD_SIZE * buffered++;
+}
+
+void BinaryEventLog::drain() {
+    out.write((const char*)buffer, RECORD_SIZE * buffered);
+    buffered = 0;
+}
+
+void BinaryEventLog::flush() {
+    drain();
+    out.flush();
+}
+
+void BinaryEventLog::absolute(Record type, uint64_t cycle) {
+    uint8_t* r = next();
+    r[0] = (uint8_t)type;
+    write56(r + 1, cycle);
+}
+
+void BinaryEventLog::record(Record type, uint8_t pid, uint16_t ip, uint64_t cycle, uint16_t aux) {
+    if(cycle < last_cycle || cycle - last_cycle > 0xFFFF) {
+        absolute(Record::SYNC, cycle);
+        last_cycle = cycle;
+    }
+
+    uint8_t* r = next();
+    r[0] = (uint8_t)type;
+    r[1] = pid;
+    write16(r + 2, ip);
+    write16(r + 4, (uint16_t)(cycle - last_cycle));
+    write16(r + 6, aux);
+    last_cycle = cycle;
+}
+
+void BinaryEventLog::init(uint64_t cycle, const std::vector<uint16_t>& starts) {
+    for(size_t x = 0; x < starts.size(); ++x) {
+        const uint8_t pid = (uint8_t)(x + 1);
+        record(Record::INIT, pid, starts[x], cycle, 0);
+        last_ip[pid] = starts[x];
+    }
+}
+
+void BinaryEventLog::exec(uint64_t cycle, uint8_t pid, uint16_t ip, uint64_t end) {
+    const uint64_t duration = end - cycle;
+    if(duration < BinaryLog::LONG_EXEC) {
+        record(Record::EXEC, pid, (uint16_t)(ip - last_ip[pid]), cycle, (uint16_t)duration);
+    } else {
+        record(Record::EXEC, pid, (uint16_t)(ip - last_ip[pid]), cycle, BinaryLog::LONG_EXEC);
+        absolute(Record::END, end);
+    }
+    last_ip[pid] = ip;
+    last_cycle = end;
+}
+
+void BinaryEventLog::stall(uint64_t cycle, uint8_t pid, uint16_t ip) {
+    record(Record::STALL, pid, (uint16_t)(ip - last_ip[pid]), cycle, 0);
+    last_ip[pid] = ip;
+}
+
+void BinaryEventLog::fault(uint64_t cycle, uint8_t pid, uint16_t ip, Fault fault) {
+    record(Record::FAULT, pid, (uint16_t)(ip - last_ip[pid]), cycle, (uint16_t)fault);
+    last_ip[pid] = ip;
+}
+
+void BinaryEventLog::turn(uint64_t cycle, uint64_t end, uint8_t pid, uint32_t count) {
+    record(Record::TURN, pid, (uint16_t)count, cycle, (uint16_t)(count >> 16));
+    absolute(Record::END, end);
+    last_cycle = end;
+}
+
+void BinaryEventLog::score(uint64_t cycle, uint8_t pid, uint32_t score) {
+    record(Record::SCORE, pid, (uint16_t)score, cycle, (uint16_t)(score >> 16));
+}
+
+void BinaryEventLog::end(uint64_t cycle, GameEnd reason, uint8_t winner) {
+    record(Record::GAME_OVER, winner, (uint16_t)reason, cycle, 0);
+}
+
+void BinaryEventLog::skipped(uint64_t cycle, uint64_t end, uint32_t count) {
+    record(Record::SKIPPED, 0, (uint16_t)count, cycle, (uint16_t)(count >> 16));
+    absolute(Record::END, end);
+    last_cycle = end;
+}
+
+
+BinaryLogReader::BinaryLogReader(std::istream& in) : in(in) {
+    reset();
+}
+
+void BinaryLogReader::reset() {
+    last_cycle = 0;
+    std::fill_n(last_ip, 256, 0);
+}
+
+bool BinaryLogReader::read(uint8_t* record) {
+    in.read((char*)record, RECORD_SIZE);
+    if(in.gcount() == 0) return false;
+    if(in.gcount() != (std::streamsize)RECORD_SIZE) throw std::runtime_error("Truncated record");
+    return true;
+}
+
+void BinaryLogReader::replay(EventLog& log) {
+    uint8_t r[RECORD_SIZE];
+    bool header = false;
+
+    //consecutive INITs are gathered into a single init event
+    std::vector<uint16_t> starts;
+    uint64_t init_cycle = 0;
+
+    while(read(r)) {
+        const Record type = (Record)r[0];
+        if(type != Record::INIT && !starts.empty()) {
+            log.init(init_cycle, starts);
+            starts.clear();
+        }
+
+        if(type == Record::HEADER) {
+            if(!std::equal(MAGIC, MAGIC + 4, r + 1)) throw std::runtime_error("Not a binary log");
+            if(r[5] != BinaryLog::VERSION) throw std::runtime_error("Unsupported binary log version");
+            reset();
+            header = true;
+            continue;
+        }
+        if(!header) throw std::runtime_error("Not a binary log");
+
+        if(type == Record::SYNC) {
+            last_cycle = read56(r + 1);
+            continue;
+        }
+
+        const uint8_t pid = r[1];
+        const uint16_t ip = (uint16_t)(last_ip[pid] + read16(r + 2));
+        const uint64_t cycle = last_cycle + read16(r + 4);
+        const uint16_t aux = read16(r + 6);
+        last_cycle = cycle;
+
+        switch(type) {
+            case Record::INIT:
+                if(starts.empty()) init_cycle = cycle;
+                starts.push_back(read16(r + 2));
+                last_ip[pid] = read16(r + 2);
+                break;
+
+            case Record::EXEC: {
+                uint64_t end = cycle + aux;
+                if(aux == BinaryLog::LONG_EXEC) {
+                    if(!read(r) || (Record)r[0] != Record::END) throw std::runtime_error("Missing END record");
+                    end = read56(r + 1);
+                }
+                log.exec(cycle, pid, ip, end);
+                last_ip[pid] = ip;
+                last_cycle = end;
+                break;
+            }
+
+            case Record::STALL:
+                log.stall(cycle, pid, ip);
+                last_ip[pid] = ip;
+                break;
+
+            case Record::FAULT:
+                if(aux >= NUM_FAULTS) throw std::runtime_error("Invalid fault");
+                log.fault(cycle, pid, ip, (Fault)aux);
+                last_ip[pid] = ip;
+                break;
+
+            case Record::SKIPPED:
+            case Record::TURN: {
+                const uint32_t count = read16(r + 2) | ((uint32_t)aux << 16);
+                if(!read(r) || (Record)r[0] != Record::END) throw std::runtime_error("Missing END record");
+                last_cycle = read56(r + 1);
+                if(type == Record::TURN) log.turn(cycle, last_cycle, pid, count);
+                else log.skipped(cycle, last_cycle, count);
+                break;
+            }
+
+            case Record::SCORE:
+                log.score(cycle, pid, read16(r + 2) | ((uint32_t)aux << 16));
+                break;
+
+            case Record::GAME_OVER:
+                if(read16(r + 2) >= NUM_GAME_ENDS) throw std::runtime_error("Invalid game end");
+                log.end(cycle, (GameEnd)read16(r + 2), pid);
+                break;
+
+            default:
+                throw std::runtime_error("Invalid record type");
+        }
+    }
+
+    if(!starts.empty()) log.init(init_cycle, starts);
+    log.flush();
+}
@@ -0,0 +1,140 @@
+#pragma once
+#include <cstdint>
+#include <istream>
+#include <ostream>
+
+#include "event_log.h"
+
+
+/**
+ * The binary log is a sequence of fixed size little-endian records. It starts with a HEADER record,
+ * after which the layout of every record other than SYNC and END is
+ *
+ *      byte 0      type
+ *      byte 1      pid
+ *      bytes 2-3   ip, as the difference from the last ip of the same pid (absolute for INIT)
+ *      bytes 4-5   cycle, as the difference from the previous event's cycle
+ *      bytes 6-7   EXEC: end - cycle, FAULT: the fault, otherwise 0
+ *
+ * The previous event's cycle is its end for EXEC, SKIPPED, and TURN and its cycle otherwise. SYNC
+ * and END store an absolute cycle in bytes 1-7 for values which do not fit in 16 bits. SKIPPED and
+ * TURN store the low 16 bits of their count in place of the ip and the high 16 bits in bytes 6-7,
+ * SCORE stores its score the same way.
+ */
+namespace BinaryLog {
+    /// Size of every record in bytes
+    constexpr size_t RECORD_SIZE = 8;
+
+    /// Version written in the header, increment if the format changes
+    constexpr uint8_t VERSION = 2;
+
+    enum class Record : uint8_t {
+        /// Start of a log: "OBLV" in bytes 1-4 and the version in byte 5, resets all state
+        HEADER,
+        /// Starting address of a player's first thread, consecutive INITs form one init event
+        INIT,
+        /// An instruction which completed
+        EXEC,
+        /// An instruction which could not complete before the turn ended
+        STALL,
+        /// An instruction a thread died running
+        FAULT,
+        /// Sets the previous cycle when the next event's cycle is too far from it
+        SYNC,
+        /// Follows an EXEC whose duration is 0xFFFF, a SKIPPED, or a TURN, holding its absolute end
+        END,
+        /// Events which were left out, always followed by an END
+        SKIPPED,
+        /// A thread's turn, always followed by an END
+        TURN,
+        /// A player's final score
+        SCORE,
+        /// The game is over, the winner in place of the pid and why it ended in place of the ip
+        GAME_OVER
+    };
+
+    /// Duration of an EXEC meaning an END record follows with the real end
+    constexpr uint16_t LONG_EXEC = 0xFFFF;
+}
+
+
+/**
+ * Writes events as binary records, see BinaryLog. Records are buffered and written in blocks.
+ */
+class BinaryEventLog : public EventLog {
+    static const size_t BUFFER_RECORDS = 4096;
+
+    std::ostream& out;
+    uint8_t buffer[BUFFER_RECORDS * BinaryLog::RECORD_SIZE];
+    size_t buffered;
+
+    uint64_t last_cycle;
+    uint16_t last_ip[256];
+
+    /**
+     * Adds a record with the common layout to the buffer, preceded by a SYNC if the cycle is too
+     * far from the previous one.
+     */
+    void record(BinaryLog::Record type, uint8_t pid, uint16_t ip, uint64_t cycle, uint16_t aux);
+
+    /// Adds a record holding an absolute cycle to the buffer.
+    void absolute(BinaryLog::Record type, uint64_t cycle);
+
+    /// Makes room for one more record and gets where it goes.
+    uint8_t* next();
+
+    /// Writes out the buffer without flushing the stream.
+    void drain();
+
+public:
+    BinaryEventLog(const BinaryEventLog&) = delete;
+    BinaryEventLog& operator=(const BinaryEventLog&) = delete;
+
+    /**
+     * Starts a new log with a header.
+     * @param out Stream to write to, should be opened in binary mode.
+     */
+    BinaryEventLog(std::ostream& out);
+    ~BinaryEventLog();
+
+    void init(uint64_t cycle, const std::vector<uint16_t>& starts) override;
+    void exec(uint64_t cycle, uint8_t pid, uint16_t ip, uint64_t end) override;
+    void stall(uint64_t cycle, uint8_t pid, uint16_t ip) override;
+    void fault(uint64_t cycle, uint8_t pid, uint16_t ip, Fault fault) override;
+    void turn(uint64_t cycle, uint64_t end, uint8_t pid, uint32_t count) override;
+    void score(uint64_t cycle, uint8_t pid, uint32_t score) override;
+    void end(uint64_t cycle, GameEnd reason, uint8_t winner) override;
+    void skipped(uint64_t cycle, uint64_t end, uint32_t count) override;
+    void flush() override;
+};
+
+
+/**
+ * Reads a binary log and replays its events.
+ */
+class BinaryLogReader {
+    std::istream& in;
+
+    uint64_t last_cycle;
+    uint16_t last_ip[256];
+
+    /**
+     * Reads the next record.
+     * @return False if there are no more records.
+     * @throws std::runtime_error if the stream ends part way through a record.
+     */
+    bool read(uint8_t* record);
+
+    /// Resets the state to what it is at the start of a log.
+    void reset();
+
+public:
+    BinaryLogReader(std::istream& in);
+
+    /**
+     * Replays every event in the log.
+     * @param log Where the events are sent.
+     * @throws std::runtime_error if the log is not valid.
+     */
+    void replay(EventLog& log);
+};
@@ -0,0 +1,177 @@
+#include "checkpoint.h"
+
+#include "game.h"
+#include "player.h"
+#include "speculative_turns.h"
+#include "thread.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+static const char MAGIC[] = {'O', 'B', 'C', 'K'};
+
+//the named offsets must move with the fields written before them
+static_assert(Checkpoint::MAX_THREADS_OFFSET == 4 + 4 && Checkpoint::NUM_THREADS_OFFSET == 4 + 4 + 1 + 4 + 4 + 4,
+              "Player layout does not match its offsets");
+static_assert(Checkpoint::THREAD_SIZE == Checkpoint::CYCLES_OFFSET + 4, "Thread layout does not match its offsets");
+
+//appends the low bytes of a value, lowest first
+static inline void put(std::string& out, uint64_t v, int bytes) {
+    for(int x = 0; x < bytes; ++x) out.push_back((char)(uint8_t)(v >> (8 * x)));
+}
+
+static inline uint64_t get(const uint8_t* src, int bytes) {
+    uint64_t v = 0;
+    for(int x = 0; x < bytes; ++x) v |= (uint64_t)src[x] << (8 * x);
+    return v;
+}
+
+//gets where the next bytes of the image are and moves past them
+static inline const uint8_t* take(const uint8_t* image, size_t size, size_t& offset, size_t bytes) {
+    if(size - offset < bytes) throw std::runtime_error("Truncated checkpoint");
+    offset += bytes;
+    return image + offset - bytes;
+}
+
+
+Json Checkpoint::config(const uint8_t* image, size_t size) {
+    if(size < CONFIG_OFFSET || !std::equal(MAGIC, MAGIC + 4, image)) throw std::runtime_error("Not a checkpoint");
+    if(image[4] != VERSION) throw std::runtime_error("Unsupported checkpoint version");
+
+    size_t offset = CONFIG_OFFSET;
+    const size_t config_size = get(image + CONFIG_SIZE_OFFSET, 4);
+    const char* text = (const char*)take(image, size, offset, config_size);
+    try { return Json::parse(text, text + config_size); }
+    catch(std::exception& e) { throw std::runtime_error("Invalid checkpoint config"); }
+}
+
+
+Game::Game(const uint8_t* image, size_t size) : Game(Checkpoint::config(image, size)) {
+    restore(image, size);
+}
+
+void Game::checkpoint(std::ostream& out) const {
+    std::string image(MAGIC, 4);
+    put(image, Checkpoint::VERSION, 1);
+    put(image, num_players, 1);
+    put(image, (uint8_t)end_reason, 1);
+    put(image, 0, 1);
+    put(image, cycle, 8);
+    put(image, skipped_cycles, 8);
+    put(image, dropped_events, 8);
+    put(image, last_activity, 8);
+
+    const std::string config = base_config->dump();
+    put(image, config.size(), 4);
+
+    //the rest of the header is 0, RAM and the pids fill the space after it
+    image.resize(Checkpoint::CONFIG_OFFSET, 0);
+    ram.copyBytes(0, Memory::SIZE, (uint8_t*)&image[Checkpoint::RAM_OFFSET]);
+    ram.copyOwners(0, Memory::SIZE, (uint8_t*)&image[Checkpoint::OWNERS_OFFSET]);
+    image += config;
+
+    for(uint8_t x = 0; x < num_players; ++x) {
+        const Player& player = players[x];
+        const size_t name_size = std::min<size_t>(player.name.size(), UINT16_MAX);
+        put(image, name_size, 2);
+        image.append(player.name, 0, name_size);
+        uint32_t modifier;
+        std::memcpy(&modifier, &player.cycle_modifer, sizeof(modifier));
+        put(image, modifier, 4);
+        put(image, player.turn_cycles, 4);
+        put(image, player.max_threads, 1);
+        put(image, player.killed_threads, 4);
+        put(image, player.killed_processes, 4);
+        put(image, player.score, 4);
+
+        put(image, player.threads.size(), 1);
+        if(player.threads.empty()) continue;
+        const Thread* thread = &player.threads.front();
+        for(size_t t = 0; t < player.threads.size(); ++t, thread = thread->next) {
+            put(image, thread->ax, 2);
+            put(image, thread->bx, 2);
+            put(image, thread->cx, 2);
+            put(image, thread->ip, 2);
+            put(image, thread->o | thread->s << 1 | thread->z << 2 | thread->c << 3, 1);
+            put(image, (uint8_t)thread->pending.op, 1);
+            put(image, thread->pending.ebit, 1);
+            put(image, 0, 1);
+            put(image, thread->pending.arg1, 2);
+            put(image, thread->pending.arg2, 2);
+            put(image, thread->pending.result, 2);
+            put(image, thread->cycles, 4);
+        }
+    }
+
+    out.write(image.data(), (std::streamsize)image.size());
+    out.flush();
+}
+
+void Game::restore(const uint8_t* image, size_t size) {
+    if(image[Checkpoint::NUM_PLAYERS_OFFSET] != num_players) throw std::runtime_error("Invalid checkpoint players");
+    if(image[6] >= NUM_GAME_ENDS) throw std::runtime_error("Invalid game end");
+    end_reason = (GameEnd)image[6];
+    cycle = get(image + 8, 8);
+    skipped_cycles = get(image + 16, 8);
+    dropped_events = get(image + 24, 8);
+    last_activity = get(image + 32, 8);
+
+    for(uint32_t addr = 0; addr < Memory::SIZE; ++addr) {
+        ram[(uint16_t)addr] = image[Checkpoint::RAM_OFFSET + addr];
+        ram.owner((uint16_t)addr) = image[Checkpoint::OWNERS_OFFSET + addr];
+        if(ram.owner((uint16_t)addr) > num_players) throw std::runtime_error("Invalid checkpoint owner");
+    }
+
+    //the players are read before their threads since the threads' slots depend on every max_threads
+    size_t offset = Checkpoint::CONFIG_OFFSET + get(image + Checkpoint::CONFIG_SIZE_OFFSET, 4);
+    std::vector<size_t> thread_offsets(num_players);
+    for(uint8_t x = 0; x < num_players; ++x) {
+        Player& player = players[x];
+        const size_t name_size = get(take(image, size, offset, 2), 2);
+        player.name.assign((const char*)take(image, size, offset, name_size), name_size);
+        const uint32_t modifier = (uint32_t)get(take(image, size, offset, 4), 4);
+        std::memcpy(&player.cycle_modifer, &modifier, sizeof(modifier));
+        player.turn_cycles = (uint32_t)get(take(image, size, offset, 4), 4);
+        player.max_threads = *take(image, size, offset, 1);
+        player.killed_threads = (uint32_t)get(take(image, size, offset, 4), 4);
+        player.killed_processes = (uint32_t)get(take(image, size, offset, 4), 4);
+        player.score = (uint32_t)get(take(image, size, offset, 4), 4);
+        if(!player.turn_cycles) throw std::runtime_error("Invalid checkpoint player");
+
+        const uint8_t threads = *take(image, size, offset, 1);
+        if(threads > std::max<uint8_t>(player.max_threads, 1)) throw std::runtime_error("Invalid checkpoint player");
+        thread_offsets[x] = offset;
+        take(image, size, offset, threads * Checkpoint::THREAD_SIZE);
+    }
+    allocateThreads();
+
+    for(uint8_t x = 0; x < num_players; ++x) {
+        const uint8_t* t = image + thread_offsets[x];
+        for(uint8_t threads = t[-1]; threads > 0; --threads, t += Checkpoint::THREAD_SIZE) {
+            const uint8_t* pending = t + Checkpoint::PENDING_OFFSET;
+            if(pending[0] > (uint8_t)FlagOp::LOGIC) throw std::runtime_error("Invalid checkpoint thread");
+            Thread& thread = *players[x].threads.spawn((uint16_t)get(t + Checkpoint::IP_OFFSET, 2));
+            thread.ax = (uint16_t)get(t + Checkpoint::AX_OFFSET, 2);
+            thread.bx = (uint16_t)get(t + Checkpoint::BX_OFFSET, 2);
+            thread.cx = (uint16_t)get(t + Checkpoint::CX_OFFSET, 2);
+            const uint8_t flags = t[Checkpoint::FLAGS_OFFSET];
+            thread.o = (flags & 1) != 0;
+            thread.s = (flags & 2) != 0;
+            thread.z = (flags & 4) != 0;
+            thread.c = (flags & 8) != 0;
+            thread.pending = {(FlagOp)pending[0], pending[1] != 0, (uint16_t)get(pending + 3, 2),
+                              (uint16_t)get(pending + 5, 2), (uint16_t)get(pending + 7, 2)};
+            thread.cycles = (uint32_t)get(t + Checkpoint::CYCLES_OFFSET, 4);
+        }
+    }
+
+    //what each player owns is counted again from the pids, and nothing decoded before is kept
+    ownership.setPlayers(players, num_players);
+    cache.clear();
+    cache.dirtyPages().clear();
+    if(speculation) speculation->sync();
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include <json.hpp>
+using Json = nlohmann::json;
+
+#include "memory.h"
+
+
+/**
+ * A checkpoint is everything needed to carry on a game somewhere else, see Game::checkpoint. It is
+ * a little-endian image which starts with a header of HEADER_SIZE bytes
+ *
+ *      bytes 0-3   "OBCK"
+ *      byte 4      version
+ *      byte 5      number of players
+ *      byte 6      why the game last ended, see GameEnd
+ *      byte 7      0
+ *      bytes 8-15  cycle
+ *      bytes 16-23 cycles skipped in loops
+ *      bytes 24-31 events dropped from the log
+ *      bytes 32-39 the last cycle something happened, for the idle termination
+ *      bytes 40-43 size of the config
+ *      bytes 44-63 0
+ *
+ * followed by all of RAM and then all of the pids at fixed offsets, so a viewer can map the file
+ * and look at them in place. Then comes the config the game was constructed with as JSON text,
+ * which holds the settings, and then for each player
+ *
+ *      2 bytes     size of the name, followed by the name
+ *      4 bytes     cycle_modifer, as the bits of the float
+ *      4 bytes     turn_cycles
+ *      1 byte      max_threads
+ *      4 bytes     killed_threads
+ *      4 bytes     killed_processes
+ *      4 bytes     score from kills
+ *      1 byte      number of threads, followed by them in the order they take turns
+ *
+ * where each thread is THREAD_SIZE bytes
+ *
+ *      bytes 0-7   ax, bx, cx, ip
+ *      byte 8      the flags, o, s, z and c from the lowest bit
+ *      byte 9      the operation whose flags are pending, see FlagOp
+ *      byte 10     1 if it was 8 bit
+ *      byte 11     0
+ *      bytes 12-17 its first operand, second operand and result
+ *      bytes 18-21 cycles left of the instruction it stopped in
+ *
+ * The bytes each player owns are counted again from the pids rather than stored.
+ */
+namespace Checkpoint {
+    /// Version written in the header, increment if the format changes
+    constexpr uint8_t VERSION = 1;
+
+    constexpr size_t HEADER_SIZE = 64;
+    constexpr size_t THREAD_SIZE = 22;
+
+    /// Offsets in the header of the number of players and of the size of the config
+    constexpr size_t NUM_PLAYERS_OFFSET = 5;
+    constexpr size_t CONFIG_SIZE_OFFSET = 40;
+
+    /// Offsets in a player, from the end of its name, of max_threads and of the number of threads
+    constexpr size_t MAX_THREADS_OFFSET = 8;
+    constexpr size_t NUM_THREADS_OFFSET = 21;
+
+    /// Offsets of the fields of a thread
+    constexpr size_t AX_OFFSET = 0;
+    constexpr size_t BX_OFFSET = 2;
+    constexpr size_t CX_OFFSET = 4;
+    constexpr size_t IP_OFFSET = 6;
+    constexpr size_t FLAGS_OFFSET = 8;
+    constexpr size_t PENDING_OFFSET = 9;
+    constexpr size_t CYCLES_OFFSET = 18;
+
+    /// Offsets of RAM and of the pids from the start of the image
+    constexpr size_t RAM_OFFSET = HEADER_SIZE;
+    constexpr size_t OWNERS_OFFSET = RAM_OFFSET + Memory::SIZE;
+    /// Offset of the config, the players follow it
+    constexpr size_t CONFIG_OFFSET = OWNERS_OFFSET + Memory::SIZE;
+
+    /**
+     * Reads the config the game in a checkpoint was constructed with.
+     * @param image The checkpoint.
+     * @param size Number of bytes in it.
+     * @return The config.
+     * @throws std::runtime_error if the image is not a checkpoint of this version.
+     */
+    Json config(const uint8_t* image, size_t size);
+}
@@ -0,0 +1,223 @@
+#include "codec.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+
+static const char HEX_DIGITS[] = "0123456789ABCDEF";
+static const char BASE64_ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+//The value of each base64 character, -1 if it is not one
+struct Base64Values {
+    int8_t values[256];
+
+    Base64Values() {
+        for(int x = 0; x < 256; ++x) values[x] = -1;
+        for(int8_t x = 0; x < 64; ++x) values[(uint8_t)BASE64_ALPHABET[x]] = x;
+    }
+};
+static const Base64Values BASE64_VALUES;
+
+
+#if defined(__SSE2__)
+//Converts each nibble to its hex digit, digits above 9 are moved up to 'A'
+static inline __m128i hexDigits(__m128i nibbles) {
+    const __m128i letters = _mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9));
+    return _mm_add_epi8(_mm_add_epi8(nibbles, _mm_set1_epi8('0')),
+                        _mm_and_si128(letters, _mm_set1_epi8('A' - '0' - 10)));
+}
+#endif
+
+#if defined(__AVX2__)
+static inline __m256i hexDigits(__m256i nibbles) {
+    const __m256i letters = _mm256_cmpgt_epi8(nibbles, _mm256_set1_epi8(9));
+    return _mm256_add_epi8(_mm256_add_epi8(nibbles, _mm256_set1_epi8('0')),
+                           _mm256_and_si256(letters, _mm256_set1_epi8('A' - '0' - 10)));
+}
+#endif
+
+void Codec::toHex(const uint8_t* src, size_t size, char* dst) {
+    size_t x = 0;
+
+#if defined(__AVX2__)
+    const __m256i low_nibble = _mm256_set1_epi8(0x0F);
+    for(; x + 32 <= size; x += 32) {
+        const __m256i bytes = _mm256_loadu_si256((const __m256i*)(src + x));
+        const __m256i hi = hexDigits(_mm256_and_si256(_mm256_srli_epi16(bytes, 4), low_nibble));
+        const __m256i lo = hexDigits(_mm256_and_si256(bytes, low_nibble));
+        //unpacking works within each 128 bit lane so the lanes are put back in order after
+        const __m256i first = _mm256_unpacklo_epi8(hi, lo);
+        const __m256i second = _mm256_unpackhi_epi8(hi, lo);
+        _mm256_storeu_si256((__m256i*)(dst + 2 * x), _mm256_permute2x128_si256(first, second, 0x20));
+        _mm256_storeu_si256((__m256i*)(dst + 2 * x + 32), _mm256_permute2x128_si256(first, second, 0x31));
+    }
+#endif
+
+#if defined(__SSE2__)
+    const __m128i low_nibble_128 = _mm_set1_epi8(0x0F);
+    for(; x + 16 <= size; x += 16) {
+        const __m128i bytes = _mm_loadu_si128((const __m128i*)(src + x));
+        const __m128i hi = hexDigits(_mm_and_si128(_mm_srli_epi16(bytes, 4), low_nibble_128));
+        const __m128i lo = hexDigits(_mm_and_si128(bytes, low_nibble_128));
+        _mm_storeu_si128((__m128i*)(dst + 2 * x), _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128((__m128i*)(dst + 2 * x + 16), _mm_unpackhi_epi8(hi, lo));
+    }
+#endif
+
+    for(; x < size; ++x) {
+        dst[2 * x] = HEX_DIGITS[src[x] >> 4];
+        dst[2 * x + 1] = HEX_DIGITS[src[x] & 0x0F];
+    }
+}
+
+void Codec::hexDump(std::ostream& os, const uint8_t* src, size_t size, size_t row) {
+    //convert a chunk at a time and write each chunk at once
+    const size_t CHUNK = 1024;
+    char digits[2 * CHUNK];
+    char text[3 * CHUNK];
+
+    size_t column = 0;
+    for(size_t offset = 0; offset < size; offset += CHUNK) {
+        const size_t n = std::min(CHUNK, size - offset);
+        toHex(src + offset, n, digits);
+        for(size_t x = 0; x < n; ++x) {
+            text[3 * x] = digits[2 * x];
+            text[3 * x + 1] = digits[2 * x + 1];
+            if(++column == row) {
+                text[3 * x + 2] = '\n';
+                column = 0;
+            }
+            else text[3 * x + 2] = ' ';
+        }
+        os.write(text, 3 * n);
+    }
+}
+
+
+std::string Codec::base64Encode(const uint8_t* src, size_t size) {
+    std::string out((size + 2) / 3 * 4, '=');
+    char* dst = &out[0];
+    size_t x = 0;
+
+#if defined(__SSSE3__)
+    //12 bytes become 16 characters, 16 bytes are read so the last 4 must exist
+    for(; x + 16 <= size; x += 12, dst += 16) {
+        __m128i in = _mm_loadu_si128((const __m128i*)(src + x));
+        in = _mm_shuffle_epi8(in, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+
+        //move each 6 bit group into its own byte
+        const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0FC0FC00));
+        const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+        const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003F03F0));
+        const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+        const __m128i indices = _mm_or_si128(t1, t3);
+
+        //work out which range of the alphabet each index is in and add that range's offset
+        __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+        const __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+        range = _mm_or_si128(range, _mm_and_si128(upper, _mm_set1_epi8(13)));
+        const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                              '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                              '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+        const __m128i chars = _mm_add_epi8(_mm_shuffle_epi8(offsets, range), indices);
+        _mm_storeu_si128((__m128i*)dst, chars);
+    }
+#endif
+
+    for(; x + 3 <= size; x += 3, dst += 4) {
+        const uint32_t v = (uint32_t)src[x] << 16 | (uint32_t)src[x + 1] << 8 | src[x + 2];
+        dst[0] = BASE64_ALPHABET[v >> 18];
+        dst[1] = BASE64_ALPHABET[(v >> 12) & 0x3F];
+        dst[2] = BASE64_ALPHABET[(v >> 6) & 0x3F];
+        dst[3] = BASE64_ALPHABET[v & 0x3F];
+    }
+
+    //the padding is already in place
+    if(x < size) {
+        const uint32_t v = (uint32_t)src[x] << 16 | (x + 1 < size ? (uint32_t)src[x + 1] << 8 : 0);
+        dst[0] = BASE64_ALPHABET[v >> 18];
+        dst[1] = BASE64_ALPHABET[(v >> 12) & 0x3F];
+        if(x + 1 < size) dst[2] = BASE64_ALPHABET[(v >> 6) & 0x3F];
+    }
+    return out;
+}
+
+std::string Codec::base64Decode(const std::string& in) {
+    const uint8_t* src = (const uint8_t*)in.data();
+    const size_t size = in.size();
+    //room for a whole 16 byte store past the end of the last block
+    std::string out(size / 4 * 3 + 16, '\0');
+    uint8_t* dst = (uint8_t*)&out[0];
+    size_t x = 0;
+
+#if defined(__SSSE3__)
+    //16 characters become 12 bytes, a block with anything outside the alphabet is left to the
+    // scalar code so it stops in the same place
+    const __m128i lut_lo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                         0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m128i lut_hi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                         0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m128i lut_roll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i mask_2F = _mm_set1_epi8(0x2F);
+
+    for(; x + 16 <= size; x += 16, dst += 12) {
+        const __m128i chars = _mm_loadu_si128((const __m128i*)(src + x));
+        const __m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(chars, 4), mask_2F);
+        const __m128i lo_nibbles = _mm_and_si128(chars, mask_2F);
+
+        //each character's low nibble and high nibble rule out different invalid characters
+        const __m128i invalid = _mm_and_si128(_mm_shuffle_epi8(lut_lo, lo_nibbles),
+                                              _mm_shuffle_epi8(lut_hi, hi_nibbles));
+        if(_mm_movemask_epi8(_mm_cmpeq_epi8(invalid, _mm_setzero_si128())) != 0xFFFF) break;
+
+        //'/' shares its high nibble with '+' so it gets its own offset
+        const __m128i eq_2F = _mm_cmpeq_epi8(chars, mask_2F);
+        const __m128i roll = _mm_shuffle_epi8(lut_roll, _mm_add_epi8(eq_2F, hi_nibbles));
+        const __m128i values = _mm_add_epi8(chars, roll);
+
+        //pack the 6 bit values into 3 bytes per 4 characters
+        const __m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+        const __m128i groups = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+        const __m128i bytes = _mm_shuffle_epi8(groups, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8,
+                                                                     14, 13, 12, -1, -1, -1, -1));
+        _mm_storeu_si128((__m128i*)dst, bytes);
+    }
+#endif
+
+    //whole groups of 4 while they are valid
+    for(; x + 4 <= size; x += 4, dst += 3) {
+        const int8_t a = BASE64_VALUES.values[src[x]], b = BASE64_VALUES.values[src[x + 1]],
+                     c = BASE64_VALUES.values[src[x + 2]], d = BASE64_VALUES.values[src[x + 3]];
+        if((a | b | c | d) < 0) break;
+        const uint32_t v = (uint32_t)a << 18 | (uint32_t)b << 12 | (uint32_t)c << 6 | (uint32_t)d;
+        dst[0] = (uint8_t)(v >> 16);
+        dst[1] = (uint8_t)(v >> 8);
+        dst[2] = (uint8_t)v;
+    }
+
+    //what is left is a partial group, decoded as far as the first character outside the alphabet
+    uint32_t v = 0;
+    int bits = -8;
+    for(; x < size; ++x) {
+        const int8_t value = BASE64_VALUES.values[src[x]];
+        if(value < 0) break;
+        v = (v << 6) | (uint32_t)value;
+        bits += 6;
+        if(bits >= 0) {
+            *dst++ = (uint8_t)(v >> bits);
+            bits -= 8;
+        }
+    }
+
+    out.resize(dst - (uint8_t*)&out[0]);
+    return out;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+
+/**
+ * Hex and base64 conversions for RAM dumps and warriors. They use SIMD where the target has it:
+ * hex needs SSE2 (AVX2 when available) and base64 needs SSSE3 for its byte shuffles, everything
+ * else falls back to scalar code which gives the same results. Build with OBLIVIOS_NATIVE_ARCH to
+ * enable whatever the host CPU supports.
+ */
+namespace Codec {
+    /**
+     * Writes each byte as two uppercase hex digits.
+     * @param src Bytes to convert.
+     * @param size Number of bytes.
+     * @param dst Where the 2 * size digits are written, not null terminated.
+     */
+    void toHex(const uint8_t* src, size_t size, char* dst);
+
+    /**
+     * Writes bytes as uppercase hex pairs, each followed by a space or by a newline at the end of
+     * a row, the format operator<<(std::ostream&, const Game&) prints RAM in.
+     * @param os Stream to write to.
+     * @param src Bytes to write.
+     * @param size Number of bytes.
+     * @param row Bytes in each row.
+     */
+    void hexDump(std::ostream& os, const uint8_t* src, size_t size, size_t row = 64);
+
+    /**
+     * @param src Bytes to encode.
+     * @param size Number of bytes.
+     * @return The bytes as base64 padded with '='.
+     */
+    std::string base64Encode(const uint8_t* src, size_t size);
+
+    /**
+     * Decodes base64, stopping at the first character which is not part of the alphabet such as
+     * the padding. This matches base64::decode.
+     * @param in The base64 text.
+     * @return The decoded bytes, empty if nothing could be decoded.
+     */
+    std::string base64Decode(const std::string& in);
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+
+
+/**
+ * One bit for each page of RAM, set when any byte in the page is written. Used to send only the
+ * parts of RAM which changed, see SnapshotWriter.
+ */
+class DirtyPages {
+public:
+    /// Bytes in a page
+    static const uint32_t PAGE_SIZE = 0x100;
+    /// Pages in RAM
+    static const uint32_t NUM_PAGES = 0x10000 / PAGE_SIZE;
+
+private:
+    uint64_t bits[NUM_PAGES / 64];
+
+public:
+    DirtyPages() { clear(); }
+
+    /**
+     * Marks the pages holding the bytes written.
+     * @param addr Address of the first byte which was written.
+     * @param len Number of bytes written, no more than PAGE_SIZE.
+     */
+    inline void mark(uint16_t addr, uint8_t len = 1) {
+        markPage(addr / PAGE_SIZE);
+        markPage((uint16_t)(addr + len - 1) / PAGE_SIZE);
+    }
+
+    /// Marks every page.
+    void markAll() { std::fill_n(bits, NUM_PAGES / 64, ~(uint64_t)0); }
+
+    /// Unmarks every page.
+    void clear() { std::fill_n(bits, NUM_PAGES / 64, 0); }
+
+    /// Marks every page which is marked in other.
+    DirtyPages& operator|=(const DirtyPages& other) {
+        for(uint32_t x = 0; x < NUM_PAGES / 64; ++x) bits[x] |= other.bits[x];
+        return *this;
+    }
+
+    /// @return True if the page has been written since the last clear.
+    bool isDirty(uint32_t page) const { return (bits[page / 64] >> (page % 64)) & 1; }
+
+    /// @return True if any page has been written since the last clear.
+    bool any() const {
+        return std::any_of(bits, bits + NUM_PAGES / 64, [](uint64_t b){ return b != 0; });
+    }
+
+private:
+    inline void markPage(uint32_t page) { bits[page / 64] |= (uint64_t)1 << (page % 64); }
+};
@@ -0,0 +1,186 @@
+#include "game.h"
+
+#include "argument.h"
+#include "event_log.h"
+#include "instruction_cache.h"
+#include "operator.h"
+#include "thread.h"
+
+//Direct threaded dispatch for Game. Every handler ends by fetching the next instruction and jumping
+// straight to its handler, so each handler gets its own indirect branch rather than all of them
+// sharing the one in execIns's switch. Without labels as values the same handlers are placed in a
+// switch inside a loop which behaves identically. The operators themselves are the handlers picked
+// for the argument types at decode time, so they do not check the types again while running.
+
+#if defined(OBLIVIOS_COMPUTED_GOTO) && !defined(__GNUC__)
+#undef OBLIVIOS_COMPUTED_GOTO
+#endif
+
+
+//The cycle the game is on, it is only stored back into cycle when the turn ends
+#define CYCLE       (turn_end - remaining_cycles)
+
+//Decode the instruction at IP and note where and when it started for its event
+#define DECODE()                                                                \
+    ins = &cache.fetch(ram, thread.ip);                                         \
+    if(Policy::reads) log.read(thread.ip, ins->size);                           \
+    start = CYCLE;                                                              \
+    ip = thread.ip;
+
+//Start the next instruction, the turn ends if no cycles are left or the instruction cannot be
+// completed, in which case the rest of its cost is carried over to the thread's next turn
+#define FETCH()                                                                 \
+    if(!remaining_cycles) goto end;                                             \
+    DECODE();                                                                   \
+    if(ins->cycles > remaining_cycles) {                                        \
+        thread.cycles = ins->cycles - remaining_cycles;                         \
+        remaining_cycles = 0;                                                   \
+        if(Policy::instructions) log.stall(start, pid, ip);                     \
+        goto end;                                                               \
+    }                                                                           \
+    remaining_cycles -= ins->cycles;
+
+//Resolve the arguments and then inc IP now that we have decided to process the instruction, faults
+// found when decoding are raised without running the operator
+#define ARGS                                                                    \
+    Argument arg1(thread, ram, *ins, 1, &cache, &ownership);                    \
+    Argument arg2(thread, ram, *ins, 2, &cache, &ownership);                    \
+    if(Policy::reads) reportReads(arg1, arg2, log);                             \
+    thread.ip += ins->size;                                                     \
+    fault = ins->fault;                                                         \
+    if(fault != Fault::NONE) goto fault;
+
+//Conditional jumps read the flags so any which were left to be computed lazily are computed first
+#define FLAGS                                                                   \
+    ARGS;                                                                       \
+    thread.resolveFlags();
+
+//Run the operator specialized for the argument types when the instruction was decoded
+#define EXEC                                                                    \
+    ARGS;                                                                       \
+    fault = ins->handler(thread, arg1, arg2);                                   \
+    if(fault != Fault::NONE) goto fault;
+
+#ifdef OBLIVIOS_COMPUTED_GOTO
+#define OP(name)    op_##name
+#define RESUME()    goto *handlers[(uint8_t)ins->opcode]
+#define DISPATCH()  FETCH(); RESUME()
+#else
+#define OP(name)    case OPCode::name
+#define RESUME()    goto resume
+#define DISPATCH()  continue
+#endif
+
+//Log or count the completed instruction and move on to the next
+#define NEXT()                                                                  \
+    if(Policy::instructions) log.exec(start, pid, ip, CYCLE);                   \
+    if(Policy::turns) ++turn_instructions;                                      \
+    DISPATCH()
+
+
+template<class Policy>
+bool Game::execTurnThreaded(Thread& thread, const uint8_t pid, uint32_t& remaining_cycles, EventLog& log) {
+#ifdef OBLIVIOS_COMPUTED_GOTO
+    static const void* const handlers[] = {
+#define X(name, params) &&op_##name
+#include "opcodes"
+#undef X
+    };
+#endif
+
+    //the budget is charged per instruction and the game's cycle is worked out from what is left
+    const uint64_t turn_end = cycle + remaining_cycles;
+    uint64_t start;
+    uint16_t ip;
+    const DecodedInstruction* ins;
+    Fault fault;
+
+    //an instruction started in an earlier turn only has the rest of its cost left to pay
+    if(thread.cycles) {
+        DECODE();
+        if(thread.cycles > remaining_cycles) {
+            thread.cycles -= remaining_cycles;
+            remaining_cycles = 0;
+            if(Policy::instructions) log.stall(start, pid, ip);
+            goto end;
+        }
+        remaining_cycles -= thread.cycles;
+        thread.cycles = 0;
+        RESUME();
+    }
+
+#ifdef OBLIVIOS_COMPUTED_GOTO
+    DISPATCH();
+    {
+#else
+    for(;;) {
+        FETCH();
+    resume:
+        switch(ins->opcode) {
+#endif
+
+    OP(NOP):  { ARGS; } NEXT();
+
+    OP(INT):  { EXEC; } NEXT();
+    OP(MOV):  { EXEC; } NEXT();
+    OP(SWP):  { EXEC; } NEXT();
+    OP(ADD):  { EXEC; } NEXT();
+    OP(SUB):  { EXEC; } NEXT();
+    OP(MUL):  { EXEC; } NEXT();
+    OP(IMUL): { EXEC; } NEXT();
+    OP(DIV):  { EXEC; } NEXT();
+    OP(IDIV): { EXEC; } NEXT();
+    OP(SHL):  { EXEC; } NEXT();
+    OP(SHR):  { EXEC; } NEXT();
+    OP(NEG):  { EXEC; } NEXT();
+    OP(NOT):  { EXEC; } NEXT();
+    OP(AND):  { EXEC; } NEXT();
+    OP(OR):   { EXEC; } NEXT();
+    OP(XOR):  { EXEC; } NEXT();
+    OP(INC):  { EXEC; } NEXT();
+    OP(DEC):  { EXEC; } NEXT();
+    OP(CMP):  { EXEC; } NEXT();
+    OP(TEST): { EXEC; } NEXT();
+
+    OP(JMP):  { ARGS; } NEXT();
+    OP(JA):   { FLAGS; } NEXT();
+    OP(JAE):  { FLAGS; } NEXT();
+    OP(JB):   { FLAGS; } NEXT();
+    OP(JBE):  { FLAGS; } NEXT();
+    OP(JG):   { FLAGS; } NEXT();
+    OP(JGE):  { FLAGS; } NEXT();
+    OP(JL):   { FLAGS; } NEXT();
+    OP(JLE):  { FLAGS; } NEXT();
+    OP(JE):   { FLAGS; } NEXT();
+    OP(JNE):  { FLAGS; } NEXT();
+    OP(JC):   { FLAGS; } NEXT();
+    OP(JNC):  { FLAGS; } NEXT();
+    OP(JO):   { FLAGS; } NEXT();
+    OP(JNO):  { FLAGS; } NEXT();
+    OP(JMPA): { ARGS; } NEXT();
+
+    //These should not happen, ever; a non-valid opcode is currently returned as a NOP
+    OP(DAT):
+    OP(NONE): { EXEC; }
+
+#ifndef OBLIVIOS_COMPUTED_GOTO
+        }
+#endif
+    }
+
+end:
+    cycle = CYCLE;
+    return true;
+
+fault:
+    cycle = CYCLE;
+    if(Policy::deaths) log.fault(start, pid, ip, fault);
+    return false;
+}
+
+//Game::run and SpeculativeTurns are in other files and need the engine for every policy
+#define X(name, policy, str) \
+    template bool Game::execTurnThreaded<LogPolicy::policy>(Thread&, const uint8_t, uint32_t&, EventLog&); \
+    template bool Game::execTurnThreaded<LogPolicy::Speculative<LogPolicy::policy>>(Thread&, const uint8_t, uint32_t&, EventLog&);
+#include "log_policies"
+#undef X
@@ -0,0 +1,198 @@
+#include "event_log.h"
+
+#include <cstring>
+
+
+//Room for any event other than init's starts and fault's message, which reserve their own
+static const size_t MAX_EVENT_SIZE = 128;
+
+static const char DIGIT_PAIRS[] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+//Copies a string literal without its terminator
+template<size_t N>
+static inline char* put(char* dst, const char (&str)[N]) {
+    std::memcpy(dst, str, N - 1);
+    return dst + N - 1;
+}
+
+//Writes an integer in decimal two digits at a time
+static inline char* putUInt(char* dst, uint64_t v) {
+    char digits[20];
+    char* const end = digits + 20;
+    char* d = end;
+    while(v >= 100) {
+        d -= 2;
+        std::memcpy(d, DIGIT_PAIRS + 2 * (v % 100), 2);
+        v /= 100;
+    }
+    if(v >= 10) {
+        d -= 2;
+        std::memcpy(d, DIGIT_PAIRS + 2 * v, 2);
+    }
+    else *--d = (char)('0' + v);
+
+    std::memcpy(dst, d, (size_t)(end - d));
+    return dst + (end - d);
+}
+
+//Writes a quoted string escaped the way nlohmann::json escapes it, needs 2 + 6 * length bytes
+static char* putString(char* dst, const char* str) {
+    static const char HEX[] = "0123456789abcdef";
+    *dst++ = '"';
+    for(; *str; ++str) {
+        const uint8_t c = (uint8_t)*str;
+        switch(c) {
+            case '"':  dst = put(dst, "\\\""); break;
+            case '\\': dst = put(dst, "\\\\"); break;
+            case '\b': dst = put(dst, "\\b"); break;
+            case '\f': dst = put(dst, "\\f"); break;
+            case '\n': dst = put(dst, "\\n"); break;
+            case '\r': dst = put(dst, "\\r"); break;
+            case '\t': dst = put(dst, "\\t"); break;
+            default:
+                if(c < 0x20) {
+                    dst = put(dst, "\\u00");
+                    *dst++ = HEX[c >> 4];
+                    *dst++ = HEX[c & 0xF];
+                }
+                else *dst++ = (char)c;
+        }
+    }
+    *dst++ = '"';
+    return dst;
+}
+
+
+JsonEventLog::~JsonEventLog() {
+    flush();
+}
+
+char* JsonEventLog::reserve(size_t size) {
+    if(BUFFER_SIZE - buffered < size) drain();
+    return buffer + buffered;
+}
+
+void JsonEventLog::drain() {
+    out.write(buffer, buffered);
+    buffered = 0;
+}
+
+void JsonEventLog::flush() {
+    drain();
+    out.flush();
+}
+
+void JsonEventLog::init(uint64_t cycle, const std::vector<uint16_t>& starts) {
+    char* p = reserve(MAX_EVENT_SIZE);
+    p = put(p, "{\"cycle\":");
+    p = putUInt(p, cycle);
+    //like nlohmann::json, there is no starts array when there are no starts
+    if(!starts.empty()) {
+        p = put(p, ",\"starts\":[");
+        for(size_t x = 0; x < starts.size(); ++x) {
+            buffered = p - buffer;
+            p = reserve(MAX_EVENT_SIZE);
+            if(x) *p++ = ',';
+            p = putUInt(p, starts[x]);
+        }
+        *p++ = ']';
+    }
+    p = put(p, ",\"type\":\"init\"}");
+    buffered = p - buffer;
+}
+
+void JsonEventLog::exec(uint64_t cycle, uint8_t pid, uint16_t ip, uint64_t end) {
+    char* p = reserve(MAX_EVENT_SIZE);
+    p = put(p, "{\"cycle\":");
+    p = putUInt(p, cycle);
+    p = put(p, ",\"end\":");
+    p = putUInt(p, end);
+    p = put(p, ",\"ins\":");
+    p = putUInt(p, ip);
+    p = put(p, ",\"pid\":");
+    p = putUInt(p, pid);
+    p = put(p, ",\"type\":\"exec\"}");
+    buffered = p - buffer;
+}
+
+void JsonEventLog::stall(uint64_t cycle, uint8_t pid, uint16_t ip) {
+    char* p = reserve(MAX_EVENT_SIZE);
+    p = put(p, "{\"cycle\":");
+    p = putUInt(p, cycle);
+    p = put(p, ",\"ins\":");
+    p = putUInt(p, ip);
+    p = put(p, ",\"pid\":");
+    p = putUInt(p, pid);
+    p = put(p, ",\"type\":\"exec\"}");
+    buffered = p - buffer;
+}
+
+void JsonEventLog::fault(uint64_t cycle, uint8_t pid, uint16_t ip, Fault fault) {
+    const char* error = Fault_Strings[(uint8_t)fault];
+    char* p = reserve(MAX_EVENT_SIZE + 6 * std::strlen(error));
+    p = put(p, "{\"cycle\":");
+    p = putUInt(p, cycle);
+    p = put(p, ",\"error\":");
+    p = putString(p, error);
+    p = put(p, ",\"ins\":");
+    p = putUInt(p, ip);
+    p = put(p, ",\"pid\":");
+    p = putUInt(p, pid);
+    p = put(p, ",\"type\":\"exec\"}");
+    buffered = p - buffer;
+}
+
+void JsonEventLog::turn(uint64_t cycle, uint64_t end, uint8_t pid, uint32_t count) {
+    char* p = reserve(MAX_EVENT_SIZE);
+    p = put(p, "{\"count\":");
+    p = putUInt(p, count);
+    p = put(p, ",\"cycle\":");
+    p = putUInt(p, cycle);
+    p = put(p, ",\"end\":");
+    p = putUInt(p, end);
+    p = put(p, ",\"pid\":");
+    p = putUInt(p, pid);
+    p = put(p, ",\"type\":\"turn\"}");
+    buffered = p - buffer;
+}
+
+void JsonEventLog::score(uint64_t cycle, uint8_t pid, uint32_t score) {
+    char* p = reserve(MAX_EVENT_SIZE);
+    p = put(p, "{\"cycle\":");
+    p = putUInt(p, cycle);
+    p = put(p, ",\"pid\":");
+    p = putUInt(p, pid);
+    p = put(p, ",\"score\":");
+    p = putUInt(p, score);
+    p = put(p, ",\"type\":\"score\"}");
+    buffered = p - buffer;
+}
+
+void JsonEventLog::end(uint64_t cycle, GameEnd reason, uint8_t winner) {
+    char* p = reserve(MAX_EVENT_SIZE);
+    p = put(p, "{\"cycle\":");
+    p = putUInt(p, cycle);
+    p = put(p, ",\"reason\":");
+    p = putString(p, GameEnd_Strings[(uint8_t)reason]);
+    p = put(p, ",\"type\":\"end\",\"winner\":");
+    p = putUInt(p, winner);
+    *p++ = '}';
+    buffered = p - buffer;
+}
+
+void JsonEventLog::skipped(uint64_t cycle, uint64_t end, uint32_t count) {
+    char* p = reserve(MAX_EVENT_SIZE);
+    p = put(p, "{\"count\":");
+    p = putUInt(p, count);
+    p = put(p, ",\"cycle\":");
+    p = putUInt(p, cycle);
+    p = put(p, ",\"end\":");
+    p = putUInt(p, end);
+    p = put(p, ",\"type\":\"skipped\"}");
+    buffered = p - buffer;
+}
@@ -0,0 +1,153 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "fault.h"
+#include "game_end.h"
+
+
+/**
+ * Where a game reports what happens while it runs. Every event the game produces goes through one
+ * of these, so the format of the log can be chosen without the game knowing about it.
+ */
+class EventLog {
+public:
+    virtual ~EventLog() {}
+
+    /**
+     * The game is starting.
+     * @param cycle The cycle the game starts on.
+     * @param starts Address each player's first thread starts at, indexed by pid - 1.
+     */
+    virtual void init(uint64_t cycle, const std::vector<uint16_t>& starts) = 0;
+
+    /**
+     * An instruction was run.
+     * @param cycle The cycle the instruction started on.
+     * @param pid The pid of the player whose thread ran it.
+     * @param ip Address of the instruction.
+     * @param end The cycle the instruction finished on.
+     */
+    virtual void exec(uint64_t cycle, uint8_t pid, uint16_t ip, uint64_t end) = 0;
+
+    /**
+     * An instruction was started but the turn ended before it could be completed.
+     * @param cycle The cycle the instruction started on.
+     * @param pid The pid of the player whose thread is running it.
+     * @param ip Address of the instruction.
+     */
+    virtual void stall(uint64_t cycle, uint8_t pid, uint16_t ip) = 0;
+
+    /**
+     * A thread died running an instruction.
+     * @param cycle The cycle the instruction started on.
+     * @param pid The pid of the player whose thread died.
+     * @param ip Address of the instruction.
+     * @param fault What the thread died of.
+     */
+    virtual void fault(uint64_t cycle, uint8_t pid, uint16_t ip, Fault fault) = 0;
+
+    /**
+     * A thread's turn ended, reported instead of each instruction when only turns are logged.
+     * @param cycle The cycle the turn started on.
+     * @param end The cycle the turn ended on.
+     * @param pid The pid of the player whose thread ran.
+     * @param count The number of instructions which were run.
+     */
+    virtual void turn(uint64_t cycle, uint64_t end, uint8_t pid, uint32_t count) = 0;
+
+    /**
+     * A player's score at the end of the game.
+     * @param cycle The cycle the game ended on.
+     * @param pid The pid of the player.
+     * @param score The player's score.
+     */
+    virtual void score(uint64_t cycle, uint8_t pid, uint32_t score) = 0;
+
+    /**
+     * The game is over, reported after the final scores.
+     * @param cycle The cycle the game ended on.
+     * @param reason Why it ended.
+     * @param winner The pid of the player with the highest score, 0 if more than one has it.
+     */
+    virtual void end(uint64_t cycle, GameEnd reason, uint8_t winner) = 0;
+
+    /**
+     * Events were left out of the log because it could not keep up, see AsyncEventLog, or because
+     * the game skipped the rounds they were in, see LoopDetector.
+     * @param cycle The cycle the first event left out started on.
+     * @param end The cycle the last event left out ended on.
+     * @param count The number of events left out, or of turns if rounds were skipped.
+     */
+    virtual void skipped(uint64_t cycle, uint64_t end, uint32_t count) = 0;
+
+    /**
+     * An instruction read bytes of RAM, only reported when turns are run speculatively so a turn
+     * can be checked against the turns before it, see SpeculativeTurns. The bytes an instruction
+     * writes are reported too.
+     * @param addr Address of the first byte, the bytes wrap around the end of RAM.
+     * @param len Number of bytes.
+     */
+    virtual void read(uint16_t addr, uint8_t len) {}
+
+    /// Writes out anything which has been buffered.
+    virtual void flush() {}
+};
+
+
+/**
+ * Writes each event as a JSON object, the format viewers read. The objects are written by hand
+ * straight into a buffer which goes to the stream in large blocks; the output is exactly what
+ * nlohmann::json writes for the same objects, keys sorted and no whitespace.
+ */
+class JsonEventLog : public EventLog {
+    static const size_t BUFFER_SIZE = 0x10000;
+
+    std::ostream& out;
+    char buffer[BUFFER_SIZE];
+    size_t buffered;
+
+    /**
+     * Makes room in the buffer, writing it out if needed.
+     * @param size Most bytes which will be added, no more than BUFFER_SIZE.
+     * @return Where to add them, buffered must be moved past what was added.
+     */
+    char* reserve(size_t size);
+
+    /// Writes out the buffer without flushing the stream.
+    void drain();
+
+public:
+    JsonEventLog(const JsonEventLog&) = delete;
+    JsonEventLog& operator=(const JsonEventLog&) = delete;
+
+    JsonEventLog(std::ostream& out) : out(out), buffered(0) {}
+    ~JsonEventLog();
+
+    void init(uint64_t cycle, const std::vector<uint16_t>& starts) override;
+    void exec(uint64_t cycle, uint8_t pid, uint16_t ip, uint64_t end) override;
+    void stall(uint64_t cycle, uint8_t pid, uint16_t ip) override;
+    void fault(uint64_t cycle, uint8_t pid, uint16_t ip, Fault fault) override;
+    void turn(uint64_t cycle, uint64_t end, uint8_t pid, uint32_t count) override;
+    void score(uint64_t cycle, uint8_t pid, uint32_t score) override;
+    void end(uint64_t cycle, GameEnd reason, uint8_t winner) override;
+    void skipped(uint64_t cycle, uint64_t end, uint32_t count) override;
+    void flush() override;
+};
+
+
+/**
+ * Discards every event.
+ */
+class NullEventLog : public EventLog {
+public:
+    void init(uint64_t cycle, const std::vector<uint16_t>& starts) override {}
+    void exec(uint64_t cycle, uint8_t pid, uint16_t ip, uint64_t end) override {}
+    void stall(uint64_t cycle, uint8_t pid, uint16_t ip) override {}
+    void fault(uint64_t cycle, uint8_t pid, uint16_t ip, Fault fault) override {}
+    void turn(uint64_t cycle, uint64_t end, uint8_t pid, uint32_t count) override {}
+    void score(uint64_t cycle, uint8_t pid, uint32_t score) override {}
+    void end(uint64_t cycle, GameEnd reason, uint8_t winner) override {}
+    void skipped(uint64_t cycle, uint64_t end, uint32_t count) override {}
+};
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+
+/**
+ * Reasons a thread can die. Faults are returned rather than thrown because warriors cause them
+ * constantly; exceptions are only used for configuration errors.
+ */
+enum class Fault : uint8_t {
+#define X(name, str) name
+#include "faults"
+#undef X
+};
+
+constexpr const char* Fault_Strings[] {
+#define X(name, str) str
+#include "faults"
+#undef X
+};
+
+/// Number of faults including NONE
+constexpr size_t NUM_FAULTS = sizeof(Fault_Strings) / sizeof(Fault_Strings[0]);
+
+/**
+ * Converts a fault to the message which is logged when a thread dies of it.
+ * @param f The fault
+ * @return A string describing the fault, empty for NONE
+ */
+inline std::string FaultToString(Fault f) {
+    return Fault_Strings[(uint8_t)f];
+}
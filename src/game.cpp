@@ -1,68 +1,167 @@
 #include "game.h"
 
 #include "argument.h"
+#include "binary_log.h"
+#include "codec.h"
+#include "event_log.h"
 #include "instruction.h"
+#include "loop_detector.h"
 #include "operator.h"
 #include "player.h"
+#include "scheduler.h"
+#include "snapshot.h"
+#include "speculative_turns.h"
 #include "thread.h"
 
-#include <base.hpp>
-
+#include <algorithm>
+#include <numeric>
 #include <random>
+#include <vector>
+
 
-//Used only for the Game constructor
-template<typename T>
-T readNum(const Json& j, std::string field, const int64_t min_value = INT64_MIN,
-          const int64_t max_value = INT64_MAX) {
+Game::Game(const Json& config) : cycle(0), settings(config), base_config(std::make_shared<const Json>(config)),
+        cache(settings), ownership(ram), num_players(readNum<uint8_t>(config, "num_players", 1, UINT8_MAX)) {
+
+    //Choose the dispatch engine, the switch in execIns is kept as the reference
     try {
-        int64_t t = j.at(field);
-        if(t > max_value || t < min_value) throw std::invalid_argument(field + " is out of bounds");
-        return (T)t;
-    } catch(std::out_of_range& e) {
-        throw std::invalid_argument(field + " is not set");
-    } catch(std::domain_error& e) {
-        throw std::invalid_argument(field + " is invalid");
+        const std::string dispatch =
+                config.count("dispatch") ? config.at("dispatch").get<std::string>() : "threaded";
+        if(dispatch != "threaded" && dispatch != "switch") throw std::invalid_argument("Invalid dispatch");
+        threaded_dispatch = dispatch == "threaded";
     }
-}
+    catch(Json::type_error& e) { throw std::invalid_argument("Invalid dispatch"); }
+
+    //Choose whether the threaded engine computes flags only once they are read, results are the same
+    try {
+        const std::string flags = config.count("flags") ? config.at("flags").get<std::string>() : "lazy";
+        if(flags != "lazy" && flags != "eager") throw std::invalid_argument("Invalid flags");
+        cache.setLazyFlags(flags == "lazy");
+    }
+    catch(Json::type_error& e) { throw std::invalid_argument("Invalid flags"); }
 
-template<typename T>
-T readReal(const Json& j, std::string field, const double min_value = -1e99,
-          const double max_value = 1e99 ) {
+    //Choose the log format, binary logs can be converted back to JSON with oblivios_logdump
     try {
-        double t = j.at(field);
-        if(t > max_value || t < min_value) throw std::invalid_argument(field + " is out of bounds");
-        return (T)t;
-    } catch(std::out_of_range& e) {
-        throw std::invalid_argument(field + " is not set");
-    } catch(std::domain_error& e) {
-        throw std::invalid_argument(field + " is invalid");
+        const std::string format =
+                config.count("log_format") ? config.at("log_format").get<std::string>() : "json";
+        if(format != "json" && format != "binary") throw std::invalid_argument("Invalid log format");
+        binary_log = format == "binary";
     }
+    catch(Json::type_error& e) { throw std::invalid_argument("Invalid log format"); }
+
+    //Optionally write the log from another thread, choosing what happens when it falls behind
+    try {
+        async_log = config.count("log_async") != 0;
+        if(async_log) log_async_policy = AsyncEventLog::PolicyFromString(config.at("log_async"));
+    }
+    catch(Json::type_error& e) { throw std::invalid_argument("Invalid log policy"); }
+
+    //Choose which events are logged, the others are compiled out of the game loop
+    try {
+        log_events = config.count("log_events") ?
+                     LogEventsFromString(config.at("log_events")) : LogEvents::FULL;
+    }
+    catch(Json::type_error& e) { throw std::invalid_argument("Invalid log events"); }
+    log_ring_size = config.count("log_ring_size") ?
+                    readNum<uint32_t>(config, "log_ring_size", 1, UINT32_MAX) : 0x10000;
+    keyframe_cycles = config.count("keyframe_cycles") ?
+                      readNum<uint64_t>(config, "keyframe_cycles", 1) : 10000;
+
+    players = nullptr;
+    thread_slots = nullptr;
+
+    //Optionally run the turns of each round on several threads, the results are the same
+    const uint8_t parallel_turns = config.count("parallel_turns") ?
+                                   readNum<uint8_t>(config, "parallel_turns", 0, UINT8_MAX) : 0;
+    speculation = parallel_turns ? new SpeculativeTurns(*this, parallel_turns) : nullptr;
+
+    //Choose whether rounds skip dead players and stalled turns, walking every player is kept as the reference
+    try {
+        const std::string schedule = config.count("scheduler") ? config.at("scheduler").get<std::string>() : "events";
+        if(schedule != "events" && schedule != "rounds") throw std::invalid_argument("Invalid scheduler");
+        scheduler = schedule == "events" ? new Scheduler(*this) : nullptr;
+    }
+    catch(Json::type_error& e) { throw std::invalid_argument("Invalid scheduler"); }
+
+    //Optionally look for the game going round in a loop, which costs a little on every write and turn
+    loops = settings.repetition != GameSettings::Repetition::IGNORE ? new LoopDetector : nullptr;
+    ownership.setDetector(loops);
+
+    reset(config);
 }
 
+Game::Game(const Game& master, const SpeculativeTurns& speculation) : ram(master.ram), cycle(0),
+        settings(master.settings), cache(settings), ownership(ram),
+        threaded_dispatch(master.threaded_dispatch), turn_instructions(0),
+        num_players(master.num_players), players(new Player[num_players]), thread_slots(nullptr),
+        speculation(nullptr), scheduler(nullptr), loops(nullptr), skipped_cycles(0), last_activity(0), end_reason(GameEnd::MAX_CYCLES), pause_cycle(UINT64_MAX) {
+    cache.setLazyFlags(master.cache.lazyFlags());
+    //what a lane's players own is never looked at, they are only somewhere for ownership to count
+    ownership.setPlayers(players, num_players);
+}
 
-Game::Game(const Json& config) : cycle(0),
-        num_players(readNum<uint8_t>(config, "num_players", 1, UINT8_MAX)),
-        cycles_per_turn(readNum<uint16_t>(config, "cycles_per_turn", 1, UINT16_MAX)),
-        max_cycles(readNum<int64_t>(config, "max_cycles", 1)),
-        ram_access_cycles(readNum<uint16_t>(config, "ram_access_cycles", 0, UINT16_MAX)),
-        ram_double_access_penalty(readNum<uint16_t>(config, "ram_double_access_penalty", 0, UINT16_MAX)),
-        score_for_killing_thread(readNum<uint32_t>(config, "score_for_killing_thread", 0, UINT32_MAX)),
-        score_for_killing_process(readNum<uint32_t>(config, "score_for_killing_process", 0, UINT32_MAX)),
-        score_for_owning_ram(readReal<float>(config, "score_for_owning_ram", 0.0, (double)UINT32_MAX)) {
+Game::Game(const Game& parent) : ram(parent.ram), cycle(parent.cycle), settings(parent.settings),
+        base_config(parent.base_config), cache(settings), ownership(ram),
+        threaded_dispatch(parent.threaded_dispatch), binary_log(parent.binary_log), async_log(parent.async_log),
+        log_async_policy(parent.log_async_policy), log_ring_size(parent.log_ring_size),
+        log_events(parent.log_events), turn_instructions(0), dropped_events(parent.dropped_events),
+        keyframe_cycles(parent.keyframe_cycles), num_players(parent.num_players),
+        players(new Player[num_players]), thread_slots(nullptr), speculation(nullptr), scheduler(nullptr),
+        loops(nullptr), skipped_cycles(parent.skipped_cycles), last_activity(parent.last_activity),
+        end_reason(parent.end_reason), pause_cycle(parent.pause_cycle) {
+    cache.setLazyFlags(parent.cache.lazyFlags());
+
+    //the players' threads are put in slots of the fork's own in the same order
+    std::copy(parent.players, parent.players + num_players, players);
+    allocateThreads();
+    for(uint8_t x = 0; x < num_players; ++x) {
+        const RunList& threads = parent.players[x].threads;
+        if(threads.empty()) continue;
+        const Thread* thread = &threads.front();
+        for(size_t t = 0; t < threads.size(); ++t, thread = thread->next) {
+            Thread& copy = *players[x].threads.spawn(thread->ip);
+            Thread* const next = copy.next;
+            Thread* const prev = copy.prev;
+            copy = *thread;
+            copy.next = next;
+            copy.prev = prev;
+        }
+    }
+    ownership.setPlayers(players, num_players, false);
 
-    loadOPCodeCycles(config);
+    speculation = parent.speculation ? new SpeculativeTurns(*this, parent.speculation->numLanes()) : nullptr;
+    scheduler = parent.scheduler ? new Scheduler(*this) : nullptr;
+    loops = parent.loops ? new LoopDetector : nullptr;
+    ownership.setDetector(loops);
+}
+
+void Game::reset(const Json& config) {
+    cycle = 0;
+    dropped_events = 0;
+    skipped_cycles = 0;
+    last_activity = 0;
+    end_reason = GameEnd::MAX_CYCLES;
+    pause_cycle = UINT64_MAX;
+    ram.clear();
+    cache.clear();
+    cache.dirtyPages().clear();
 
-    std::fill_n(pid, 0x10000, 0);
+    delete[] players;
+    delete[] thread_slots;
+    thread_slots = nullptr;
     players = new Player[num_players];
 
     //Read player configuration
-    try {
+    if(config.count("player_settings")) try {
         const Json& settings = config.at("player_settings");
         for (uint8_t x = 0; x < num_players && x < settings.size(); ++x)
             players[x] = Player(settings[x], (uint8_t)(x + 1));
     }
-    catch(std::domain_error& e) { throw std::invalid_argument("Invalid player settings"); }
-    catch(std::out_of_range& e) {}
+    catch(Json::type_error& e) { throw std::invalid_argument("Invalid player settings"); }
+
+    //work out each player's turn budget once rather than every turn
+    for(uint8_t x = 0; x < num_players; ++x)
+        players[x].turn_cycles = std::max<uint32_t>((uint32_t)((double)settings.cycles_per_turn * players[x].cycle_modifer), 1);
+    allocateThreads();
 
     //Convert the quotable bytecode into a binary string
     //Create array of binary strings
@@ -75,17 +174,17 @@ Game::Game(const Json& config) : cycle(0),
         //Decode the strings
         for(uint8_t x = 0; x < num_players; ++x) {
             //Store the decoded string, and check if the size is zero, there was a problem 
-            if( !(programs[x] = base64::decode(warriors[x].get<std::string>())).size() )
+            if( !(programs[x] = Codec::base64Decode(warriors[x].get<std::string>())).size() )
                 throw std::invalid_argument(players[x].name + " did not decode properly");
         }
     }
-    catch(std::domain_error& e) { throw std::invalid_argument("Invalid warriors array"); }
+    catch(Json::type_error& e) { throw std::invalid_argument("Invalid warriors array"); }
 
     //Read the max player size from the configuration
     uint16_t max_size; //0 means no limit, as long as they all fit
-    try { max_size = config.at("max_player_size"); }
-    catch(std::out_of_range& e) { max_size = (uint8_t)(0x10000 / num_players); }
-    catch(std::domain_error& e) { throw std::invalid_argument("Invalid max player size"); }
+    try { max_size = config.count("max_player_size") ? config.at("max_player_size").get<uint16_t>() :
+                     (uint8_t)(0x10000 / num_players); }
+    catch(Json::type_error& e) { throw std::invalid_argument("Invalid max player size"); }
 
     //Count the space needed by the warriors and make sure that they are not over the max
     uint32_t total_size = 0;
@@ -93,7 +192,6 @@ Game::Game(const Json& config) : cycle(0),
         const size_t size = programs[x].size();
         if(size > (max_size ? max_size : 0x10000)) //default maxsize to RAM size if 0
             throw std::invalid_argument(players[x].name + " is larger than the max size");
-        players[x].owned_ram = (uint32_t)size;
         total_size += size;
         if(total_size > 0x10000)
             throw std::invalid_argument("Total size of warriors exceeds RAM capacity");
@@ -103,9 +201,12 @@ Game::Game(const Json& config) : cycle(0),
     //Now we put them into RAM
     //start by creating a non-repeating rand with random_shuffle which defines the order of programs
     uint8_t* order = new uint8_t[num_players];
-    std::generate(order, order+num_players, [](){ static uint8_t x = 0; return x++; } );
+    std::iota(order, order+num_players, 0);
     std::default_random_engine generator;
-    generator.seed((unsigned long)time(nullptr));
+    try { //for reproducible games
+        generator.seed(config.count("seed") ? config.at("seed").get<unsigned long>() : (unsigned long)time(nullptr));
+    }
+    catch(Json::type_error& e) { throw std::invalid_argument("Invalid seed"); }
     std::shuffle(order, order+num_players, generator);
 
     const uint16_t max_gap = (uint16_t)((0x10000 - total_size) / num_players);
@@ -116,114 +217,336 @@ Game::Game(const Json& config) : cycle(0),
         const std::string& cur_code = programs[cur_pid - 1];
         cur_offset += distribution(generator); //random offset that will not allow out of range indexing
 
-        //copy binary data into ram at the location
-        std::copy(cur_code.begin(), cur_code.end(), ram+cur_offset);
-        //update who "owns" the RAM we just wrote
-        std::fill_n(pid+cur_offset, cur_code.size(), cur_pid);
+        //copy binary data into ram at the location, it is "owned" by the player who wrote it
+        ram.load(cur_offset, (const uint8_t*)cur_code.data(), cur_code.size(), cur_pid);
 
         //add thread to player
-        players[cur_pid - 1].threads.push(new Thread(cur_offset));
+        players[cur_pid - 1].threads.spawn(cur_offset);
         cur_offset += cur_code.size();
     }
 
     delete[] order;
     delete[] programs;
+
+    //count what each warrior owns now that they are loaded
+    ownership.setPlayers(players, num_players);
+    if(speculation) speculation->sync();
+}
+
+void Game::allocateThreads() {
+    //every thread any player can have is allocated now so none are allocated while running
+    delete[] thread_slots;
+    size_t total_threads = 0;
+    for(uint8_t x = 0; x < num_players; ++x) total_threads += std::max<uint8_t>(players[x].max_threads, 1);
+    thread_slots = new Thread[total_threads];
+    size_t offset = 0;
+    for(uint8_t x = 0; x < num_players; ++x) {
+        const uint8_t capacity = std::max<uint8_t>(players[x].max_threads, 1);
+        players[x].threads.init(thread_slots + offset, capacity);
+        offset += capacity;
+    }
 }
 
 Game::~Game() {
+    delete loops;
+    delete scheduler;
+    delete speculation;
     delete[] players;
+    delete[] thread_slots;
 }
 
 
-void Game::run(std::ostream& log) {
+void Game::run(std::ostream& out) {
+    switch(log_events) {
+#define X(name, policy, str) case LogEvents::name: run<LogPolicy::policy>(out, nullptr); break;
+#include "log_policies"
+#undef X
+    }
+}
+
+void Game::run(std::ostream& out, std::ostream& snapshot_out) {
+    SnapshotWriter snapshots(snapshot_out, keyframe_cycles);
+    switch(log_events) {
+#define X(name, policy, str) case LogEvents::name: run<LogPolicy::policy>(out, &snapshots); break;
+#include "log_policies"
+#undef X
+    }
+}
+
+template<class Policy>
+void Game::run(std::ostream& out, SnapshotWriter* snapshots) {
+    //nothing is created to write to when nothing would be written
+    EventLog* log;
+    if(!Policy::enabled) log = new NullEventLog;
+    else if(binary_log) log = new BinaryEventLog(out);
+    else log = new JsonEventLog(out);
+    AsyncEventLog* async = nullptr;
+    if(Policy::enabled && async_log) log = async = new AsyncEventLog(log, log_ring_size, log_async_policy);
+
     if(cycle == 0) {
-        sendInit(log);
+        if(Policy::init) sendInit(*log);
         ++cycle;
     }
+    if(snapshots) snapshots->keyframe(cycle, ram);
+    cache.dirtyPages().clear();
+
+    uint8_t alive = 0;
+    for(uint8_t x = 0; x < num_players; ++x) if(!players[x].threads.empty()) ++alive;
+    //a paused game carries on idling from where it was, a game which ended idle gets a fresh start
+    if(end_reason != GameEnd::PAUSED) last_activity = cycle;
+    GameEnd reason = GameEnd::MAX_CYCLES;
+    //a turn which only stalls changes nothing which is reported unless turns or instructions are,
+    //but the threads must be up to date at the end of every round to look for loops
+    if(scheduler) scheduler->start(!Policy::instructions && !Policy::turns && !loops);
+    if(loops) loops->reset(ram, players, num_players, thread_slots, cycle);
+
+    //main loop, runs until every AI has died, max cycles is reached, or one of the chosen terminations
+    for(; alive > 0 && cycle < endCycle(alive) && !endsEarly(alive, reason); ++cycle) {
+        //run through player turns, or all of them at once when they are run speculatively
+        if(speculation) alive -= speculation->round<Policy>(*log);
+        else if(scheduler) alive -= scheduler->round<Policy>(*log);
+        else for(uint8_t process = 1; process <= num_players; ++process) {
+            //a dead player is skipped
+            if(players[process - 1].threads.empty()) continue;
+            if(playTurn<Policy>(process, *log)) --alive;
+        }
+
+        //the pages written this round are only looked at by snapshots and the idle check
+        if(settings.endsOn(GameEnd::IDLE)) {
+            if(cache.dirtyPages().any()) last_activity = cycle;
+            if(!snapshots) cache.dirtyPages().clear();
+        }
 
-    //main loop, runs until only one AI continues running or max cycles is reached
-    for(uint8_t alive = num_players; alive > 0 && cycle < max_cycles - alive * cycles_per_turn; ++cycle) {
-        //run through player turns
-        for(uint8_t process = 1; process <= num_players; ++process) {
-            Player& player = players[process - 1];
-
-            //get next thread to run
-            if(player.threads.empty()) break;
-            Thread* thread = player.threads.front();
-            player.threads.pop();
-
-            uint32_t remaining_cycles = std::max<uint32_t>((uint32_t)((double)cycles_per_turn * player.cycle_modifer), 1);
-
-            while(remaining_cycles > 0 && thread != nullptr) {
-                //process instruction
-                if(execIns(*thread, process, remaining_cycles, log)) { //successfully processed
-                    //add thread back to queue
-                    player.threads.push(thread);
-                }
-                else { //encountered an error, deal with thread and reward killer
-                    const uint8_t cause = pid[thread->ip];
-                    if(cause && cause != process) {
-                        players[cause - 1].killed_threads++;
-                        players[cause - 1].score += score_for_killing_thread;
-                    }
-
-                    if(!player.threads.size()) { //dead
-                        --alive;
-                        if (cause != process) {
-                            players[cause - 1].killed_processes++;
-                            players[cause - 1].score += score_for_killing_process;
-                        }
-                    }
-                    delete thread;
-                    thread = nullptr;
-                }
+        //keyframes are a good time to make sure ownership has not drifted
+        if(snapshots && snapshots->write(cycle, ram, cache.dirtyPages())) ownership.recount();
+
+        //a game back in the state it was in at the end of an earlier round goes round the same loop until it ends
+        if(loops) {
+            const uint64_t loop_rounds = loops->endRound(cycle);
+            if(loop_rounds && settings.repetition == GameSettings::Repetition::DRAW) {
+                reason = GameEnd::REPETITION;
+                break;
             }
+            if(loop_rounds) skipLoops<Policy>(loop_rounds, alive, *log);
         }
     }
+    if(scheduler) scheduler->finish();
+    end_reason = alive ? reason : GameEnd::NO_PLAYERS;
+
+    if(Policy::scores) {
+        for(uint8_t x = 0; x < num_players; ++x) log->score(cycle, (uint8_t)(x + 1), score((uint8_t)(x + 1)));
+        log->end(cycle, end_reason, end_reason == GameEnd::REPETITION ? 0 : winner());
+    }
+
+    if(async) dropped_events += async->dropped();
+    delete log;
 }
 
 
-void Game::sendInit(std::ostream& log) {
+template<class Policy>
+bool Game::playTurn(uint8_t process, EventLog& log) {
+    Player& player = players[process - 1];
+    Thread& thread = player.threads.front();
+
+    uint32_t remaining_cycles = player.turn_cycles;
+    const uint64_t turn_start = cycle;
+    ownership.setWriter(process);
+    turn_instructions = 0;
+
+    //run the thread until its turn is over
+    const bool survived = threaded_dispatch ?
+                          execTurnThreaded<Policy>(thread, process, remaining_cycles, log) :
+                          execTurn<Policy>(thread, process, remaining_cycles, log);
+    if(Policy::turns) log.turn(turn_start, cycle, process, turn_instructions);
+    return endTurn(process, survived);
+}
+
+//the Scheduler is in another file and plays turns for every policy
+#define X(name, policy, str) template bool Game::playTurn<LogPolicy::policy>(uint8_t, EventLog&);
+#include "log_policies"
+#undef X
+
+bool Game::endTurn(uint8_t process, bool survived) {
+    Player& player = players[process - 1];
+    if(loops) {
+        //lazy flags are computed so a state hashes the same however its flags were set
+        player.threads.front().resolveFlags();
+        loops->turn(process, thread_slots, player, survived);
+    }
+    if(survived) { //move on to the player's next thread
+        player.threads.rotate();
+        if(loops) loops->moved(process, thread_slots, player);
+        return false;
+    }
+
+    //encountered an error, deal with thread and reward killer
+    last_activity = cycle;
+    const uint8_t cause = ram.owner(player.threads.front().ip);
+    player.threads.kill();
+    if(loops) loops->moved(process, thread_slots, player);
+    if(cause && cause != process) {
+        players[cause - 1].killed_threads++;
+        players[cause - 1].score += settings.score_for_killing_thread;
+    }
+
+    if(!player.threads.empty()) return false;
+    //dead
+    if (cause && cause != process) {
+        players[cause - 1].killed_processes++;
+        players[cause - 1].score += settings.score_for_killing_process;
+    }
+    return true;
+}
+
+
+template<class Policy>
+void Game::skipLoops(uint64_t loop_rounds, uint8_t alive, EventLog& log) {
+    const uint64_t loop_cycles = loops->loopCycles(cycle);
+    //the game must still be running at the start of the round after the last time round skipped
+    const uint64_t end = endCycle(alive);
+    if(end <= cycle + 1) return;
+    const uint64_t times = (end - 1 - cycle) / loop_cycles;
+    //a loop which writes nothing would end the game idle before then
+    if(settings.endsOn(GameEnd::IDLE) && last_activity + loop_cycles <= cycle) return;
+    if(!times) return;
+
+    const uint64_t from = cycle;
+    cycle += times * loop_cycles;
+    skipped_cycles += times * loop_cycles;
+    if(settings.endsOn(GameEnd::IDLE)) last_activity += times * loop_cycles;
+    if(Policy::instructions || Policy::turns)
+        log.skipped(from + 1, cycle, (uint32_t)std::min<uint64_t>(times * loop_rounds * alive, UINT32_MAX));
+    loops->restart(cycle);
+}
+
+bool Game::endsEarly(uint8_t alive, GameEnd& reason) const {
+    if(cycle >= pause_cycle) {
+        reason = GameEnd::PAUSED;
+        return true;
+    }
+    if(!settings.terminations) return false;
+
+    if(settings.endsOn(GameEnd::LAST_STANDING) && alive == 1 && num_players > 1)
+        reason = GameEnd::LAST_STANDING;
+    else if(settings.endsOn(GameEnd::IDLE) && cycle - last_activity >= settings.idle_cycles)
+        reason = GameEnd::IDLE;
+    else if(settings.endsOn(GameEnd::SCORE_LEAD) && num_players > 1 && leadDecided())
+        reason = GameEnd::SCORE_LEAD;
+    else return false;
+    return true;
+}
+
+uint64_t Game::endCycle(uint8_t alive) const {
+    return (uint64_t)std::max<int64_t>(settings.max_cycles - (int64_t)alive * settings.cycles_per_turn, 0);
+}
+
+bool Game::leadDecided() const {
+    //the two highest of a value over the players, so the highest of any player but the leader is known
+    struct Top2 {
+        int64_t value[2] = {INT64_MIN, INT64_MIN};
+        uint8_t who[2] = {UINT8_MAX, UINT8_MAX};
+
+        void add(int64_t v, uint8_t x) {
+            if(v > value[0]) {
+                value[1] = value[0];
+                who[1] = who[0];
+                value[0] = v;
+                who[0] = x;
+            }
+            else if(v > value[1]) {
+                value[1] = v;
+                who[1] = x;
+            }
+        }
+        int64_t except(uint8_t x) const { return who[0] == x ? value[1] : value[0]; }
+    } alive, dead;
+
+    //what the players alive are still worth to whoever kills them
+    uint64_t total_worth = 0;
+    uint8_t leader = 0;
+    for(uint8_t x = 0; x < num_players; ++x) {
+        const Player& player = players[x];
+        if(player.score > players[leader].score) leader = x;
+        if(player.threads.empty()) {
+            dead.add(score((uint8_t)(x + 1)), x);
+            continue;
+        }
+        const uint64_t worth = (uint64_t)player.threads.size() * settings.score_for_killing_thread +
+                               settings.score_for_killing_process;
+        total_worth += worth;
+        alive.add((int64_t)player.score - (int64_t)worth, x);
+    }
+
+    //the leader keeps its kills but could lose all its RAM, anyone else alive could own all of it
+    //and kill every other thread, and the dead keep what they have
+    const int64_t all_ram = (int64_t)((float)Memory::SIZE * settings.score_for_owning_ram);
+    const int64_t lead = players[leader].score;
+    return lead > dead.except(leader) && lead > alive.except(leader) + all_ram + (int64_t)total_worth;
+}
+
+uint8_t Game::winner() const {
+    uint8_t best = 0;
+    uint32_t best_score = 0;
+    bool tied = false;
+    for(uint8_t pid = 1; pid <= num_players; ++pid) {
+        const uint32_t s = score(pid);
+        if(best && s == best_score) tied = true;
+        else if(!best || s > best_score) {
+            best = pid;
+            best_score = s;
+            tied = false;
+        }
+    }
+    return tied ? 0 : best;
+}
+
+
+void Game::sendInit(EventLog& log) {
     //tell server where the warriors are
-    Json update = { {"type", "init"}, {"cycle", 0} };
+    std::vector<uint16_t> starts;
 
     //player has a region, server already knows what data to fill in if given starting position
     for (uint8_t x = 0; x < num_players; ++x) {
         const Player& player = players[x];
 
-        const uint16_t start = player.threads.front()->ip;
+        const uint16_t start = player.threads.front().ip;
         //const uint16_t end = (uint16_t) //find end of pid and then distance from start to it
         //        (std::find_if_not(pid+start, pid+0x10000, [x](int v){ return v == x + 1;}) - pid);
 
-        //std::string data = base64::encode(std::string((char*)(ram+start), end - start));
-        update["starts"].push_back(start);
+        //std::string data = Codec::base64Encode(ram + start, end - start);
+        starts.push_back(start);
     }
 
-    log << update;
+    log.init(0, starts);
 }
 
-bool Game::execIns(Thread &thread, const uint8_t pid, uint32_t& remaining_cycles, std::ostream &log) {
+template<class Policy>
+bool Game::execIns(Thread &thread, const uint8_t pid, uint32_t& remaining_cycles, EventLog &log) {
     const uint32_t starting_cycles = remaining_cycles;
-    Json json = { {"type", "exec"}, {"cycle", cycle}, {"pid", pid} };
-
-    json["ins"] = thread.ip;
-    const OPCode opcode = Instruction::getOPCode(ram, thread.ip);
+    const uint64_t start = cycle;
+    const uint16_t ip = thread.ip;
+    const DecodedInstruction& ins = cache.fetch(ram, thread.ip);
+    const OPCode opcode = ins.opcode;
+    if(Policy::reads) log.read(ip, ins.size);
 
-    Argument arg1(thread, ram, 1);
-    Argument arg2(thread, ram, 2);
+    Argument arg1(thread, ram, ins, 1, &cache, &ownership);
+    Argument arg2(thread, ram, ins, 2, &cache, &ownership);
+    if(Policy::reads) reportReads(arg1, arg2, log);
 
     //charge cycles, the value becomes 0, we are done, but opcode did not fail so return true
-    bool completable = remainingCycles(thread, remaining_cycles, opcode, arg1.isMem(), arg2.isMem());
+    bool completable = remainingCycles(thread, remaining_cycles, ins.cycles);
     cycle += starting_cycles - remaining_cycles;
     if(!completable) {
-        log << json;
+        if(Policy::instructions) log.stall(start, pid, ip);
         return true;
     }
 
     //inc IP now that we have read the instruction and decided to process it
-    thread.ip += Instruction::getSize(ram, thread.ip);
+    thread.ip += ins.size;
 
-    try { switch (opcode) {
+    //faults found when decoding are raised without running the operator
+    Fault fault = ins.fault;
+    if(fault == Fault::NONE) switch (opcode) {
         case OPCode::NOP:break;
 
         case OPCode::INT:
@@ -248,10 +571,10 @@ bool Game::execIns(Thread &thread, const uint8_t pid, uint32_t& remaining_cycles
             Operator::imul(thread, arg1);
             break;
         case OPCode::DIV:
-            Operator::div(thread, arg1);
+            fault = Operator::div(thread, arg1);
             break;
         case OPCode::IDIV:
-            Operator::idiv(thread, arg1);
+            fault = Operator::idiv(thread, arg1);
             break;
         case OPCode::SHL:
             Operator::shl(thread, arg1, arg2);
@@ -322,27 +645,53 @@ bool Game::execIns(Thread &thread, const uint8_t pid, uint32_t& remaining_cycles
         //These should not happen, ever; a non-valid opcode is currently returned as a NOP
         case OPCode::DAT:
         case OPCode::NONE:
-            throw std::runtime_error("Attempted to execute invalid opcode.");
+            fault = Fault::INVALID_OPCODE;
+            break;
+    }
 
-    } } catch(std::runtime_error& e) {
-        json["error"] = e.what();
+    if(fault != Fault::NONE) {
+        if(Policy::deaths) log.fault(start, pid, ip, fault);
         return false;
     }
 
-    json["end"] = cycle;
-    log << json;
+    if(Policy::instructions) log.exec(start, pid, ip, cycle);
+    if(Policy::turns) ++turn_instructions;
+    return true;
+}
+
+template<class Policy>
+bool Game::execTurn(Thread& thread, const uint8_t pid, uint32_t& remaining_cycles, EventLog& log) {
+    while(remaining_cycles > 0)
+        if(!execIns<Policy>(thread, pid, remaining_cycles, log)) return false;
+    return true;
+}
 
-    //for now say the program died
-    return false;
+//SpeculativeTurns is in another file and needs the reference engine for every policy
+#define X(name, policy, str) \
+    template bool Game::execTurn<LogPolicy::policy>(Thread&, const uint8_t, uint32_t&, EventLog&); \
+    template bool Game::execTurn<LogPolicy::Speculative<LogPolicy::policy>>(Thread&, const uint8_t, uint32_t&, EventLog&);
+#include "log_policies"
+#undef X
+
+void Game::reportReads(const Argument& arg1, const Argument& arg2, EventLog& log) {
+    //a byte written is reported as well since it may be 16 bits, both bytes are reported
+    if(arg1.isMem()) log.read(arg1.address(), 2);
+    if(arg2.isMem()) log.read(arg2.address(), 2);
 }
 
-bool Game::remainingCycles(Thread& thread, uint32_t& remaining_cycles, const OPCode opcode,
-                               const bool arg1m, const bool arg2m) const {
-    uint32_t cycle_cost;
+uint64_t Game::rerunTurns() const {
+    return speculation ? speculation->reruns() : 0;
+}
 
+uint32_t Game::score(uint8_t pid) const {
+    const Player& player = players[pid - 1];
+    return player.score + (uint32_t)((float)player.owned_ram * settings.score_for_owning_ram);
+}
+
+bool Game::remainingCycles(Thread& thread, uint32_t& remaining_cycles, uint32_t cycle_cost) const {
     //set cycle cost, return false if we cannot complete
     if(thread.cycles > 0) { //we have leftovers
-        if(remaining_cycles > thread.cycles) { //we can complete
+        if(remaining_cycles >= thread.cycles) { //we can complete
             //remaining cycles decremented later
             cycle_cost = thread.cycles;
             thread.cycles = 0;
@@ -354,15 +703,10 @@ bool Game::remainingCycles(Thread& thread, uint32_t& remaining_cycles, const OPC
         }
     }
     else { //nothing was left over
-        cycle_cost = getOPCodeCycles(opcode);
-
-        if(arg1m) cycle_cost += ram_access_cycles;
-        if(arg2m) cycle_cost += ram_access_cycles;
-        if(arg1m && arg2m) cycle_cost += ram_double_access_penalty;
-
         if(cycle_cost > remaining_cycles) {
             thread.cycles = cycle_cost - remaining_cycles;
-            return 0;
+            remaining_cycles = 0;
+            return false;
         }
     }
     remaining_cycles -= cycle_cost;
@@ -372,17 +716,11 @@ bool Game::remainingCycles(Thread& thread, uint32_t& remaining_cycles, const OPC
 
 
 std::ostream& operator<<(std::ostream& os, const Game& game) {
-    const size_t BUFFER_SIZE = 3;
-
-    //os << std::hex << std::uppercase;
-
-    char buffer[BUFFER_SIZE];
-
-    for(uint16_t x = 0; ; ++x) {
-        snprintf(buffer, BUFFER_SIZE, "%02X", game.ram[x]);
-        if((x + 1) % 64 == 0) os << buffer << '\n';
-        else os << buffer << ' ';
-        if(x == 0xFFFF) break;
+    //a whole number of rows at a time so the dump is the same as one of all of RAM
+    uint8_t bytes[0x1000];
+    for(uint32_t addr = 0; addr < Memory::SIZE; addr += sizeof(bytes)) {
+        game.ram.copyBytes((uint16_t)addr, sizeof(bytes), bytes);
+        Codec::hexDump(os, bytes, sizeof(bytes), 64);
     }
 
     os.unsetf(std::ios::hex);
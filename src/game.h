@@ -1,71 +1,315 @@
 #pragma once
 #include <cstdint>
+#include <memory>
 
 struct Player;
 struct Thread;
+class Argument;
+class EventLog;
+class LoopDetector;
+class Scheduler;
+class SnapshotWriter;
+class SpeculativeTurns;
 enum class OPCode : uint8_t;
 
 #include <json.hpp>
 using Json = nlohmann::json;
 
+#include "async_log.h"
+#include "game_settings.h"
+#include "instruction_cache.h"
+#include "log_policy.h"
+#include "memory.h"
+#include "ownership.h"
+
 /**
  * Abstract the game such that the server could handle more than one
  */
 class Game {
-    /// The memory warriors will run in
-    uint8_t ram[0x10000];
-    /// The pid of last modification
-    uint8_t pid[0x10000];
+    /// The memory warriors will run in and the pid of the last modification of each byte
+    Memory ram;
     uint64_t cycle;
 
-    //TODO: Create GameSettings Object to handle all of this crap
-    const uint16_t cycles_per_turn;
-    const int64_t max_cycles;
-    const uint16_t ram_access_cycles;
-    const uint16_t ram_double_access_penalty;
-    const uint32_t score_for_killing_thread;
-    const uint32_t score_for_killing_process;
-    const float score_for_owning_ram;
+    /// Costs and scores, read only once the game is constructed
+    const GameSettings settings;
+    /// The config the game was constructed with, checkpoints keep it so their settings are the same.
+    /// It never changes so forks share it.
+    std::shared_ptr<const Json> base_config;
+
+    /// Decoded instructions, invalidated by writes to ram
+    InstructionCache cache;
+
+    /// Keeps the owners in ram and each player's owned_ram up to date as ram is written
+    Ownership ownership;
+
+    /// Use execTurnThreaded rather than the reference execTurn
+    bool threaded_dispatch;
+
+    /// Write the log as binary records (see BinaryLog) rather than JSON
+    bool binary_log;
+
+    /// Write the log from another thread, see AsyncEventLog
+    bool async_log;
+    AsyncEventLog::Policy log_async_policy;
+    uint32_t log_ring_size;
+
+    /// Which events are logged, see LogPolicy
+    LogEvents log_events;
+    /// Instructions completed so far in the current turn, only counted when turns are logged
+    uint32_t turn_instructions;
+
+    /// Events left out of the log because the writer could not keep up
+    uint64_t dropped_events;
+
+    /// Most cycles between keyframes of the snapshot stream, see SnapshotWriter
+    uint64_t keyframe_cycles;
 
     /// The number of players in a given game
     const uint8_t num_players;
     /// Array of players, index i is the player with pid i + 1
     Player* players;
+    /// Every thread slot of every player, each player's RunList uses max_threads of them in turn
+    Thread* thread_slots;
+
+    /// Runs each round's turns in parallel, null if they are run one after another
+    SpeculativeTurns* speculation;
+    /// Skips dead players and turns which only stall, null if every player is walked every round
+    Scheduler* scheduler;
+
+    /// Looks for the game going round in a loop, null unless "repetition" is set in the config
+    LoopDetector* loops;
+    /// Cycles skipped because the game was in a loop
+    uint64_t skipped_cycles;
+
+    /// The last cycle RAM was written or a thread died, only kept when the game can end idle
+    uint64_t last_activity;
+    /// Why the last run ended
+    GameEnd end_reason;
+    /// Runs end paused once the game reaches this cycle, UINT64_MAX if they are not paused
+    uint64_t pause_cycle;
+
+    friend class LockstepGames;
+    friend class Scheduler;
+    friend class SpeculativeTurns;
+
+    /**
+     * Creates one of the lanes of a SpeculativeTurns. It has the game's settings and a copy of its
+     * RAM but no players, turns are run on it with threads belonging to the game.
+     * @param master The game the lane runs turns for.
+     * @param speculation The lanes' owner.
+     */
+    Game(const Game& master, const SpeculativeTurns& speculation);
+
+    /**
+     * Creates a fork of a game, see fork.
+     * @param parent The game to fork.
+     */
+    Game(const Game& parent);
+
+    /// Gives every player the thread slots for its max_threads, any threads they had are forgotten.
+    void allocateThreads();
+
+    /**
+     * Puts the game back in the state of a checkpoint, see Checkpoint.
+     * @param image The checkpoint, its config must be the one the game was constructed with.
+     * @param size Number of bytes in it.
+     * @throws std::runtime_error if the image is not a valid checkpoint.
+     */
+    void restore(const uint8_t* image, size_t size);
 
     /**
      * Send the inital information about game state.
-     * @param log The log stream
+     * @param log Where events are reported
+     */
+    void sendInit(EventLog& log);
+
+    /**
+     * Runs the game until it is over, reporting the events chosen by Policy.
+     * @param out The output stream for updates.
+     * @param snapshots Where snapshots are written after every round, may be null.
      */
-    void sendInit(std::ostream& log);
+    template<class Policy>
+    void run(std::ostream& out, SnapshotWriter* snapshots);
 
     /**
      * Executes the next instruction.
      * @param thread The thread to run.
-     * @param log The output stream for updates.
+     * @param log Where events are reported, only those chosen by Policy.
      * @return True if successful, false if not.
      */
-    bool execIns(Thread& thread, const uint8_t pid, uint32_t& remaining_cycles, std::ostream& log);
+    template<class Policy>
+    bool execIns(Thread& thread, const uint8_t pid, uint32_t& remaining_cycles, EventLog& log);
+
+    /**
+     * Runs a thread until its turn's cycles run out, one instruction at a time through execIns.
+     * This is the reference implementation which execTurnThreaded must match.
+     * @param thread The thread to run.
+     * @param pid The pid of the player the thread belongs to.
+     * @param remaining_cycles Cycles left in the turn, will be 0 if the thread survived.
+     * @param log Where events are reported.
+     * @return True if the thread is still alive, false if it died.
+     */
+    template<class Policy>
+    bool execTurn(Thread& thread, const uint8_t pid, uint32_t& remaining_cycles, EventLog& log);
+
+    /**
+     * Runs a thread until its turn's cycles run out using direct threaded dispatch, each
+     * instruction's handler jumps straight to the next instruction's handler. Uses labels as values
+     * when built with OBLIVIOS_COMPUTED_GOTO and falls back to a switch in a loop otherwise.
+     * Instructions are charged their precomputed cost straight from the turn's budget, only the
+     * instruction the turn ends on has its remaining cost stored in Thread::cycles.
+     * @see execTurn
+     */
+    template<class Policy>
+    bool execTurnThreaded(Thread& thread, const uint8_t pid, uint32_t& remaining_cycles, EventLog& log);
+
+    /**
+     * Runs a turn of the player's next thread.
+     * @param process The pid of the player, who must have threads left.
+     * @param log Where events are reported.
+     * @return True if the player has no threads left.
+     */
+    template<class Policy>
+    bool playTurn(uint8_t process, EventLog& log);
+
+    /**
+     * Moves on to the player's next thread after a turn, or kills the thread and rewards its
+     * killer if it died.
+     * @param process The pid of the player whose turn it was.
+     * @param survived True if the thread survived its turn.
+     * @return True if the player has no threads left.
+     */
+    bool endTurn(uint8_t process, bool survived);
+
+    /**
+     * Checks the ways the game may end early which are listed in its settings, and whether it is
+     * due to be paused.
+     * @param alive Number of players with threads left.
+     * @param reason Set to why the game ends if it does.
+     * @return True if the game should end now.
+     */
+    bool endsEarly(uint8_t alive, GameEnd& reason) const;
+
+    /**
+     * @param alive Number of players with threads left.
+     * @return The cycle a round must start before, so every player alive has time for a turn
+     *  before max_cycles, 0 if there is no time for one.
+     */
+    uint64_t endCycle(uint8_t alive) const;
+
+    /**
+     * Skips as many times round a loop the game is in as it can without passing the end of the
+     * game, the state of the game is the same after each time round.
+     * @param loop_rounds Rounds each time round the loop takes.
+     * @param alive Number of players with threads left.
+     * @param log Where events are reported, the turns skipped are reported as skipped.
+     */
+    template<class Policy>
+    void skipLoops(uint64_t loop_rounds, uint8_t alive, EventLog& log);
+
+    /// @return True if some player's score from kills can no longer be caught by any other player.
+    bool leadDecided() const;
+
+    /// @return The pid of the player with the highest score, 0 if more than one has it.
+    uint8_t winner() const;
+
+    /// Reports the bytes of RAM the arguments refer to as read, see EventLog::read.
+    static void reportReads(const Argument& arg1, const Argument& arg2, EventLog& log);
 
     /**
-     * Charges remaining cycles by proper amount given the thread state and opcode.
-     * @param opcode OPCode of the current instruction.
-     * @param arg1m Is arg1 a memory location?
-     * @param arg2m Is arg2 a memory location?
+     * Charges remaining cycles by proper amount given the thread state and instruction cost.
+     * @param cycle_cost Full cost of the current instruction, see DecodedInstruction::cycles.
      * @return True if the operation can be completed, false otherwise.
      *
      * @note Modifies thread.cycles to be new value if needed
      * @note Modifies remaining_cycles to be new value
      */
-    bool remainingCycles(Thread& thread, uint32_t& remaining_cycles, const OPCode opcode,
-                             const bool arg1m, const bool arg2m) const;
+    bool remainingCycles(Thread& thread, uint32_t& remaining_cycles, const uint32_t cycle_cost) const;
 
 public:
     Game() = delete;
     Game(const Json& config);
+
+    /**
+     * Carries on a game from a checkpoint, with the settings it had. The image is only read while
+     * constructing, so it can be a file mapped into memory.
+     * @param image The checkpoint, see Game::checkpoint.
+     * @param size Number of bytes in it.
+     * @throws std::runtime_error if the image is not a valid checkpoint.
+     * @throws std::invalid_argument if the config in it is not valid.
+     */
+    Game(const uint8_t* image, size_t size);
     ~Game();
 
+    /**
+     * Runs the game until it is over.
+     * @param log The output stream for updates, in the format chosen by "log_format" in the config
+     *            with the events chosen by "log_events".
+     */
     void run(std::ostream& log);
 
+    /**
+     * Runs the game until it is over, also writing snapshots of RAM for spectators.
+     * @param log The output stream for updates, see run(std::ostream&).
+     * @param snapshots The output stream for snapshots, a keyframe every "keyframe_cycles" in the
+     *                  config and the pages which changed after every round in between.
+     */
+    void run(std::ostream& log, std::ostream& snapshots);
+
+    /**
+     * Starts another game in the state this one is in now, which carries on exactly as this one
+     * would but apart from it. Built with OBLIVIOS_PAGED_MEMORY the two share every page of RAM
+     * until one of them writes it and the fork only decodes the instructions it runs, so a game
+     * paused part way can be forked many times over to play out different branches cheaply.
+     * @return The fork, which the caller deletes.
+     */
+    Game* fork() const { return new Game(*this); }
+
+    /**
+     * Makes the runs from now on end with GameEnd::PAUSED at the start of the first round on or
+     * after a cycle. Running the game again carries on from there exactly as if it had not stopped.
+     * @param cycle The cycle to pause on, UINT64_MAX to never pause.
+     */
+    void pauseAt(uint64_t cycle) { pause_cycle = cycle; }
+
+    /**
+     * Writes everything needed to carry on the game somewhere else: RAM and who owns it, the
+     * players and their threads, and the settings. It should be taken between runs, the game
+     * constructed from it carries on exactly as this one would, see Checkpoint.
+     * @param out Stream to write to, should be opened in binary mode.
+     */
+    void checkpoint(std::ostream& out) const;
+
+    /**
+     * Starts a new game in place, reusing the memory of this one.
+     * @param config Config to read the players, warriors, max player size, and seed from, the
+     *               number of players must be the same and all other settings are kept.
+     * @throws std::invalid_argument if the players or warriors are not valid, the game must be
+     *         reset again before it is run.
+     */
+    void reset(const Json& config);
+
+    /**
+     * @param pid The pid of a player.
+     * @return The player's score including the RAM it owns right now.
+     */
+    uint32_t score(uint8_t pid) const;
+
+    /// @return Why the game last run ended, GameEnd::MAX_CYCLES if it has not been run.
+    GameEnd endReason() const { return end_reason; }
+
+    /// @return The number of cycles skipped because the game was in a loop, see LoopDetector.
+    uint64_t skippedCycles() const { return skipped_cycles; }
+
+    /// @return The number of events left out of the log because the log writer could not keep up.
+    uint64_t droppedEvents() const { return dropped_events; }
+
+    /**
+     * @return The number of turns which were run again because they read RAM changed by an earlier
+     *         turn of their round, always 0 unless "parallel_turns" is set in the config.
+     */
+    uint64_t rerunTurns() const;
+
     /// @warning This prints a lot of stuff
     friend std::ostream& operator<<(std::ostream& os, const Game& game);
 };
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include "game_batch.h"
+
+#include "game.h"
+
+#include <ostream>
+#include <stdexcept>
+
+
+GameBatch::GameBatch(const Json& base) : base(base), num_players(base.at("num_players")) {
+    for(Game*& game : games) game = nullptr;
+}
+
+GameBatch::~GameBatch() {
+    for(Game* game : games) delete game;
+}
+
+bool GameBatch::resets(const std::string& key) {
+    return key == "player_settings" || key == "warriors" || key == "max_player_size" || key == "seed";
+}
+
+Json GameBatch::configOf(const Json& changes, bool& reusable) const {
+    Json config = base;
+    reusable = true;
+    for(auto itr = changes.begin(); itr != changes.end(); ++itr) {
+        config[itr.key()] = itr.value();
+        reusable = reusable && resets(itr.key());
+    }
+    config["log_events"] = "none";
+    if(config.at("num_players") != num_players) throw std::invalid_argument("num_players must not change");
+    return config;
+}
+
+Game& GameBatch::load(uint8_t slot, const Json& config) {
+    //a game which failed to reset or run is reset again before it is played
+    if(games[slot]) games[slot]->reset(config);
+    else games[slot] = new Game(config);
+    return *games[slot];
+}
+
+//Adds the scores of a game which has been run to the result
+static void addScores(const Game& game, uint8_t num_players, GameBatch::Result& result) {
+    for(uint8_t pid = 1; pid <= num_players; ++pid) result.scores.push_back(game.score(pid));
+}
+
+//Runs a game to the end and adds its scores to the result
+static void playOut(Game& game, uint8_t num_players, GameBatch::Result& result) {
+    std::ostream log(nullptr);
+    game.run(log);
+    addScores(game, num_players, result);
+}
+
+//Records why a game could not be played
+static void fail(GameBatch::Result& result, const std::exception& e) {
+    result.scores.clear();
+    result.error = e.what();
+}
+
+GameBatch::Result GameBatch::play(const Json& changes) {
+    Result result;
+    try {
+        bool reusable;
+        const Json config = configOf(changes, reusable);
+        if(!reusable) {
+            //a game with settings of its own is constructed for it, the reused games keep the base settings
+            Game alone(config);
+            playOut(alone, num_players, result);
+        }
+        else playOut(load(0, config), num_players, result);
+    }
+    catch(std::exception& e) {
+        fail(result, e);
+    }
+    return result;
+}
+
+std::vector<GameBatch::Result> GameBatch::run(const std::vector<Json>& changes) {
+    std::vector<Result> results(changes.size());
+    //the index of the game each lane was loaded with
+    size_t loaded[LockstepGames::LANES];
+    uint8_t lanes = 0;
+
+    for(size_t x = 0; x <= changes.size(); ++x) {
+        //the lanes are played once they are all loaded or there are no games left to load them with
+        if(lanes == LockstepGames::LANES || (x == changes.size() && lanes)) {
+            try {
+                lockstep.run(games, lanes);
+                for(uint8_t lane = 0; lane < lanes; ++lane) addScores(*games[lane], num_players, results[loaded[lane]]);
+            }
+            catch(std::exception& e) {
+                for(uint8_t lane = 0; lane < lanes; ++lane) fail(results[loaded[lane]], e);
+            }
+            lanes = 0;
+        }
+        if(x == changes.size()) break;
+
+        try {
+            bool reusable;
+            const Json config = configOf(changes[x], reusable);
+            if(reusable) {
+                load(lanes, config);
+                loaded[lanes++] = x;
+            }
+            else {
+                Game alone(config);
+                playOut(alone, num_players, results[x]);
+            }
+        }
+        catch(std::exception& e) {
+            fail(results[x], e);
+        }
+    }
+    return results;
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <json.hpp>
+using Json = nlohmann::json;
+
+#include "lockstep_games.h"
+
+class Game;
+
+
+/**
+ * Plays many games which share every setting but their players, warriors, and seed, such as the
+ * games of a warrior search. One game is reset for each new one rather than constructing a new
+ * one, which saves allocating the instruction cache, RAM, and settings every time. A game which
+ * changes any other setting is constructed on its own. run() keeps a game for each lane of a
+ * LockstepGames and plays them all at once. Results are the same as constructing and running each
+ * game alone with nothing logged.
+ */
+class GameBatch {
+public:
+    /// The outcome of one game
+    struct Result {
+        /// Score of each player, index i is the player with pid i + 1
+        std::vector<uint32_t> scores;
+        /// Why the game could not be played, empty if it was
+        std::string error;
+    };
+
+private:
+    /// Config every game starts from
+    const Json base;
+    const uint8_t num_players;
+    /// Reset for every game, null until the first one is loaded. play() uses the first, run() uses
+    /// one for each lane
+    Game* games[LockstepGames::LANES];
+    LockstepGames lockstep;
+
+    /// @return True if a key of the config is read again by Game::reset.
+    static bool resets(const std::string& key);
+
+    /**
+     * @param changes The keys which differ from the base config.
+     * @param reusable Set to true if the game can be played by resetting a game of the batch.
+     * @return The config of the game, with nothing logged.
+     */
+    Json configOf(const Json& changes, bool& reusable) const;
+
+    /**
+     * Resets one of the batch's games for a game, constructing it if it was not yet.
+     * @param slot Which of the games.
+     * @param config The game's config, which must be reusable.
+     * @throws std::invalid_argument if the config is not valid.
+     */
+    Game& load(uint8_t slot, const Json& config);
+
+public:
+    GameBatch(const GameBatch&) = delete;
+    GameBatch& operator=(const GameBatch&) = delete;
+
+    /// @param base Config every game starts from, see data/default.json.
+    GameBatch(const Json& base);
+    ~GameBatch();
+
+    /**
+     * Plays a game.
+     * @param changes The keys which differ from the base config. Games which only change
+     *                "player_settings", "warriors", "max_player_size", and "seed" reuse one game,
+     *                others are constructed alone. "num_players" must not change.
+     */
+    Result play(const Json& changes);
+
+    /**
+     * Plays every game, those which reuse a game LockstepGames::LANES at a time in lockstep.
+     * @param games The changes for each game, see play().
+     * @return The result of each game in the same order.
+     */
+    std::vector<Result> run(const std::vector<Json>& games);
+};
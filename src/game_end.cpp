@@ -0,0 +1,15 @@
+#include "game_end.h"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+
+GameEnd GameEndFromString(const std::string& s) {
+    const auto begin = std::begin(GameEnd_Strings);
+    const auto end = std::end(GameEnd_Strings);
+
+    const auto loc = std::find(begin, end, s);
+    if(loc == end) throw std::invalid_argument(s + " is not a valid termination.");
+    return (GameEnd)(loc - begin);
+}
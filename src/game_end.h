@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+
+/**
+ * Why a game ended. A game always ends at max_cycles or once every player has died, the others
+ * end it early and only apply if they are listed in the config's "termination", but for a
+ * repetition which ends it as a draw if the config's "repetition" is "draw", see GameSettings. A
+ * paused game is not over, running it again carries on from where it stopped, see Game::pauseAt.
+ */
+enum class GameEnd : uint8_t {
+#define X(name, str) name,
+#include "game_ends"
+#undef X
+};
+
+constexpr const char* GameEnd_Strings[] {
+#define X(name, str) str,
+#include "game_ends"
+#undef X
+};
+
+/// Number of ways a game can end
+constexpr size_t NUM_GAME_ENDS = sizeof(GameEnd_Strings) / sizeof(GameEnd_Strings[0]);
+
+/**
+ * @param s The name of a way a game can end, e.g. "last_standing".
+ * @return The way it ends.
+ * @throws std::invalid_argument if it is not a way a game can end.
+ */
+GameEnd GameEndFromString(const std::string& s);
@@ -0,0 +1,50 @@
+#include "game_settings.h"
+
+#include <algorithm>
+
+
+GameSettings::GameSettings() : cycles_per_turn(1), max_cycles(INT64_MAX), ram_access_cycles(0),
+        ram_double_access_penalty(0), score_for_killing_thread(0), score_for_killing_process(0),
+        score_for_owning_ram(0), terminations(0), idle_cycles(0), repetition(Repetition::IGNORE) {
+    std::fill_n(op_cycles, NUM_OPCODES, 1);
+}
+
+GameSettings::GameSettings(const Json& config) :
+        cycles_per_turn(readNum<uint16_t>(config, "cycles_per_turn", 1, UINT16_MAX)),
+        max_cycles(readNum<int64_t>(config, "max_cycles", 1)),
+        ram_access_cycles(readNum<uint16_t>(config, "ram_access_cycles", 0, UINT16_MAX)),
+        ram_double_access_penalty(readNum<uint16_t>(config, "ram_double_access_penalty", 0, UINT16_MAX)),
+        score_for_killing_thread(readNum<uint32_t>(config, "score_for_killing_thread", 0, UINT32_MAX)),
+        score_for_killing_process(readNum<uint32_t>(config, "score_for_killing_process", 0, UINT32_MAX)),
+        score_for_owning_ram(readReal<float>(config, "score_for_owning_ram", 0.0, (double)UINT32_MAX)),
+        terminations(0), idle_cycles(0), repetition(Repetition::IGNORE) {
+    std::fill_n(op_cycles, NUM_OPCODES, 1);
+
+    if(config.count("termination")) {
+        const Json& ends = config.at("termination");
+        if(!ends.is_array()) throw std::invalid_argument("Invalid termination");
+        for(const Json& end : ends) {
+            if(!end.is_string()) throw std::invalid_argument("Invalid termination");
+            //the other ways a game ends are not chosen, they always apply or are set elsewhere
+            const GameEnd reason = GameEndFromString(end);
+            if(reason != GameEnd::LAST_STANDING && reason != GameEnd::SCORE_LEAD && reason != GameEnd::IDLE)
+                throw std::invalid_argument("Invalid termination");
+            terminations |= (uint8_t)(1 << (uint8_t)reason);
+        }
+    }
+    if(endsOn(GameEnd::IDLE)) idle_cycles = readNum<uint64_t>(config, "idle_cycles", 1);
+
+    if(config.count("repetition")) {
+        const Json& loops = config.at("repetition");
+        if(loops == "draw") repetition = Repetition::DRAW;
+        else if(loops == "fast_forward") repetition = Repetition::FAST_FORWARD;
+        else if(loops != "ignore") throw std::invalid_argument("Invalid repetition");
+    }
+
+    const Json& cycles = config.at("op_cycles");
+    if(!cycles.is_object()) return;
+    for(auto&& itr = cycles.begin(); itr != cycles.end(); ++itr) {
+        const OPCode op = OPCodeFromString(itr.key());
+        op_cycles[(uint8_t)op] = *itr;
+    }
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include <json.hpp>
+using Json = nlohmann::json;
+
+#include "game_end.h"
+#include "opcode.h"
+
+
+/**
+ * Reads an integer from a config.
+ * @throws std::invalid_argument if it is not set, not a number, or out of bounds.
+ */
+template<typename T>
+T readNum(const Json& j, std::string field, const int64_t min_value = INT64_MIN,
+          const int64_t max_value = INT64_MAX) {
+    if(!j.count(field)) throw std::invalid_argument(field + " is not set");
+    try {
+        int64_t t = j.at(field);
+        if(t > max_value || t < min_value) throw std::invalid_argument(field + " is out of bounds");
+        return (T)t;
+    } catch(Json::type_error& e) {
+        throw std::invalid_argument(field + " is invalid");
+    }
+}
+
+/// Same as readNum for real numbers.
+template<typename T>
+T readReal(const Json& j, std::string field, const double min_value = -1e99,
+          const double max_value = 1e99 ) {
+    if(!j.count(field)) throw std::invalid_argument(field + " is not set");
+    try {
+        double t = j.at(field);
+        if(t > max_value || t < min_value) throw std::invalid_argument(field + " is out of bounds");
+        return (T)t;
+    } catch(Json::type_error& e) {
+        throw std::invalid_argument(field + " is invalid");
+    }
+}
+
+
+/**
+ * The costs and scores a game is played with. Each game has its own copy which the interpreter
+ * reads from, so games with different settings can run at the same time in one process.
+ */
+struct GameSettings {
+    /// Cycles needed by each opcode, indexed by opcode
+    uint32_t op_cycles[NUM_OPCODES];
+
+    uint16_t cycles_per_turn;
+    int64_t max_cycles;
+    /// Charge for each argument which is in memory
+    uint16_t ram_access_cycles;
+    /// Extra charge if both arguments are in memory
+    uint16_t ram_double_access_penalty;
+    uint32_t score_for_killing_thread;
+    uint32_t score_for_killing_process;
+    float score_for_owning_ram;
+    /// Each GameEnd the game may end early on, one bit per GameEnd
+    uint8_t terminations;
+    /// Cycles without a write to RAM or a thread dying before an idle game ends
+    uint64_t idle_cycles;
+    /// What is done once the game is in the same state at the end of two rounds, see LoopDetector
+    enum class Repetition : uint8_t {
+        /// Nothing, it is not looked for
+        IGNORE,
+        /// The game ends as a draw
+        DRAW,
+        /// The game skips every whole loop before max_cycles, the scores are the same
+        FAST_FORWARD
+    } repetition;
+
+    /// Every opcode takes 1 cycle, memory access is free, nothing scores, turns are 1 cycle, and
+    /// games only end at max_cycles or when every player has died and never look for loops.
+    GameSettings();
+
+    /**
+     * Reads the settings from a game's config, opcodes which are not listed in its "op_cycles"
+     * object take 1 cycle. The optional "termination" array names the ways the game may end early,
+     * any of "last_standing", "score_lead", and "idle", and "idle_cycles" must be set if it has
+     * "idle". The optional "repetition" is "ignore", "draw",
+     * or "fast_forward".
+     * @throws std::invalid_argument if any setting is missing or invalid.
+     */
+    GameSettings(const Json& config);
+
+    /// @return The number of cycles the opcode takes, not counting memory access.
+    uint32_t opCycles(OPCode op) const { return op_cycles[(uint8_t)op]; }
+
+    /// @return True if the game may end this way.
+    bool endsOn(GameEnd end) const { return (terminations >> (uint8_t)end) & 1; }
+};
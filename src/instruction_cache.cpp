@@ -0,0 +1,117 @@
+#include "instruction_cache.h"
+
+#include "argument.h"
+
+#include <algorithm>
+
+
+//Decode an argument in the same way the Argument constructor resolves it
+static DecodedArgument decodeArgument(const Memory& ram, uint16_t addr, uint8_t size, uint8_t argn) {
+    DecodedArgument arg;
+    if(argn == 1) {
+        arg.loc = Instruction::getArg1Loc(ram, addr);
+        arg.mode = Instruction::getArg1Mode(ram, addr);
+    } else {
+        arg.loc = Instruction::getArg2Loc(ram, addr);
+        arg.mode = Instruction::getArg2Mode(ram, addr);
+    }
+
+    arg.addr = 0;
+    if(arg.loc == Location::IMD) {
+        arg.addr = Instruction::getImdAddress(ram, addr, argn);
+    }
+    else if(arg.loc == Location::PIMD) {
+        uint16_t imd = Instruction::getImdAddress(ram, addr, argn); //the address of the imd
+        imd = (ram[imd] << 8) | (ram[(uint16_t)(imd + 1)]); //the value stored at the imd
+
+        //relative addressing is from the end of the instruction
+        arg.addr = arg.mode == AccessMode::RELATIVE ? (uint16_t)(addr + size + imd) : imd;
+    }
+    return arg;
+}
+
+
+DecodedInstruction::DecodedInstruction(const Memory& ram, uint16_t addr) :
+        opcode(Instruction::getOPCode(ram, addr)), size(Instruction::getSize(ram, addr)),
+        cycles(0), handler(nullptr), fault(Fault::NONE), generation(0) {
+    arg1 = decodeArgument(ram, addr, size, 1);
+    arg2 = decodeArgument(ram, addr, size, 2);
+}
+
+
+#ifdef OBLIVIOS_PAGED_MEMORY
+DecodedInstruction InstructionCache::unused[Memory::PAGE_SIZE];
+
+InstructionCache::InstructionCache(const GameSettings& settings) :
+        generation(1), settings(settings), lazy_flags(false) {
+    DecodedInstruction* const none = unused;
+    std::fill_n(pages, Memory::NUM_PAGES, none);
+}
+
+InstructionCache::~InstructionCache() {
+    for(DecodedInstruction* page : pages) if(page != unused) delete[] page;
+}
+
+void InstructionCache::clear() {
+    //entries are only reset once every generation has been used
+    if(++generation == 0) {
+        for(DecodedInstruction* page : pages) {
+            if(page == unused) continue;
+            std::for_each(page, page + Memory::PAGE_SIZE, [](DecodedInstruction& ins){ ins.generation = 0; });
+        }
+        generation = 1;
+    }
+}
+#else
+InstructionCache::InstructionCache(const GameSettings& settings) :
+        entries(new DecodedInstruction[0x10000]), generation(1), settings(settings), lazy_flags(false) {}
+
+InstructionCache::~InstructionCache() {
+    delete[] entries;
+}
+
+void InstructionCache::clear() {
+    //entries are only reset once every generation has been used
+    if(++generation == 0) {
+        std::for_each(entries, entries + 0x10000, [](DecodedInstruction& ins){ ins.generation = 0; });
+        generation = 1;
+    }
+}
+#endif
+
+void InstructionCache::setLazyFlags(bool lazy) {
+    lazy_flags = lazy;
+    clear();
+}
+
+const DecodedInstruction& InstructionCache::decode(const Memory& ram, uint16_t addr) {
+#ifdef OBLIVIOS_PAGED_MEMORY
+    DecodedInstruction*& page = pages[addr / Memory::PAGE_SIZE];
+    if(page == unused) page = new DecodedInstruction[Memory::PAGE_SIZE];
+#endif
+    DecodedInstruction& ins = entry(addr);
+    ins = DecodedInstruction(ram, addr);
+    ins.generation = generation;
+
+    const bool arg1m = ins.arg1.isMem();
+    const bool arg2m = ins.arg2.isMem();
+    ins.cycles = settings.opCycles(ins.opcode);
+    if(arg1m) ins.cycles += settings.ram_access_cycles;
+    if(arg2m) ins.cycles += settings.ram_access_cycles;
+    if(arg1m && arg2m) ins.cycles += settings.ram_double_access_penalty;
+
+    ins.handler = Operator::getHandler(ins.opcode, Argument::typeOf(ins.arg1.loc),
+                                       Argument::typeOf(ins.arg2.loc), lazy_flags);
+
+    if(ins.arg1.loc == Location::NONE || ins.arg2.loc == Location::NONE)
+        ins.fault = Fault::INVALID_LOCATION;
+    else if(ins.opcode == OPCode::DAT || ins.opcode == OPCode::NONE)
+        ins.fault = Fault::INVALID_OPCODE;
+    //the IP can only be encoded as the source, and SWP writes its source before its destination, so
+    //faulting before the operator runs leaves RAM just as it was when the write to the IP threw
+    else if((ins.arg1.loc == Location::IP && Operator::writesArg(ins.opcode, 1)) ||
+            (ins.arg2.loc == Location::IP && Operator::writesArg(ins.opcode, 2)))
+        ins.fault = Fault::READ_ONLY;
+
+    return ins;
+}
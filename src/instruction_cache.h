@@ -0,0 +1,193 @@
+#pragma once
+#include <cstdint>
+#include "dirty_pages.h"
+#include "game_settings.h"
+#include "instruction.h"
+#include "operator.h"
+
+
+/**
+ * The decoded form of a single argument. Everything here depends only on the bytes of the
+ * instruction, so it stays valid until one of those bytes is written.
+ */
+struct DecodedArgument {
+    Location loc;
+    AccessMode mode;
+
+    /**
+     * For IMD this is the address of the immediate, for PIMD this is the resolved address the
+     * immediate points to (relative addressing already applied), otherwise unused.
+     */
+    uint16_t addr;
+
+    /**
+     * @return True if the argument lives in memory (RAM) rather than a register.
+     */
+    bool isMem() const;
+};
+
+
+/**
+ * An instruction decoded from RAM once so it does not need to be decoded every time it runs.
+ */
+struct DecodedInstruction {
+    OPCode opcode;
+    /// Size of the instruction in bytes, see Instruction::getSize
+    uint8_t size;
+    DecodedArgument arg1, arg2;
+
+    /// Cost of running the instruction including the RAM access charges
+    uint32_t cycles;
+
+    /**
+     * The operator specialized for the types of the arguments, null if a location is invalid. If
+     * the cache uses lazy flags, Thread::resolveFlags must be called before the flags are read.
+     */
+    Operator::Handler handler;
+
+    /// Fault running this instruction will cause regardless of the thread state, otherwise NONE
+    Fault fault;
+
+    /// The InstructionCache::generation this was decoded in, 0 if it was invalidated by a write
+    uint32_t generation;
+
+    DecodedInstruction() : generation(0) {}
+
+    /**
+     * Decodes the instruction at addr. The cycle cost, handler and fault are not set.
+     * @param ram The game's RAM
+     * @param addr Address of the start of the instruction in RAM
+     */
+    DecodedInstruction(const Memory& ram, uint16_t addr);
+
+    /**
+     * @param argn The number of the argument, starting at 1 (currently only 1 and 2 are valid)
+     * @return The decoded argument.
+     */
+    const DecodedArgument& arg(uint8_t argn) const;
+};
+
+
+/**
+ * Caches decoded instructions for every address in RAM. Entries are decoded lazily the first time
+ * they are fetched and invalidated whenever a byte belonging to them is written, so
+ * self-modifying programs behave exactly as if every instruction were decoded from scratch. Since
+ * it is told about every write it also keeps track of which pages of RAM were written.
+ */
+class InstructionCache {
+    /// The largest an instruction can be, 2 bytes plus two immediates
+    static const uint8_t MAX_INS_SIZE = 6;
+
+#ifdef OBLIVIOS_PAGED_MEMORY
+    /// One block of entries per page of RAM, allocated the first time an instruction starting in
+    /// the page is decoded so a fork of a game only pays for the code it runs
+    DecodedInstruction* pages[Memory::NUM_PAGES];
+    /// Where every page which has not been decoded in points, its entries are never written
+    static DecodedInstruction unused[Memory::PAGE_SIZE];
+
+    DecodedInstruction& entry(uint16_t addr) { return pages[addr / Memory::PAGE_SIZE][addr % Memory::PAGE_SIZE]; }
+    const DecodedInstruction& entry(uint16_t addr) const { return pages[addr / Memory::PAGE_SIZE][addr % Memory::PAGE_SIZE]; }
+#else
+    /// one entry per address in RAM
+    DecodedInstruction* entries;
+
+    DecodedInstruction& entry(uint16_t addr) { return entries[addr]; }
+    const DecodedInstruction& entry(uint16_t addr) const { return entries[addr]; }
+#endif
+    /// Entries decoded in any other generation are stale, so clearing is just starting a new one
+    uint32_t generation;
+
+    /// Where the cycles each instruction takes come from
+    const GameSettings& settings;
+
+    /// Decode to handlers which leave the flags to be computed when they are needed
+    bool lazy_flags;
+
+    /// Pages written since they were last cleared
+    DirtyPages dirty;
+
+public:
+    InstructionCache() = delete;
+    InstructionCache(const InstructionCache&) = delete;
+    InstructionCache& operator=(const InstructionCache&) = delete;
+
+    /// @param settings The game's settings, which must outlive the cache.
+    InstructionCache(const GameSettings& settings);
+    ~InstructionCache();
+
+    /**
+     * Gets the decoded instruction at addr, decoding it if it is not already cached.
+     * @param ram The game's RAM
+     * @param addr Address of the start of the instruction in RAM
+     * @return The decoded instruction, valid until the next write to RAM.
+     */
+    inline const DecodedInstruction& fetch(const Memory& ram, uint16_t addr);
+
+    /**
+     * Invalidates every cached instruction which contains any of the bytes written and marks the
+     * pages they are in as dirty.
+     * @param addr Address of the first byte which was written.
+     * @param len Number of bytes written.
+     */
+    inline void invalidate(uint16_t addr, uint8_t len = 1);
+
+    /// Invalidates every cached instruction.
+    void clear();
+
+    /// @return True if the instruction at addr is decoded and has not been invalidated since.
+    bool isCached(uint16_t addr) const { return entry(addr).generation == generation; }
+
+    /**
+     * Chooses whether instructions are decoded to handlers which compute flags lazily, see
+     * Operator::getHandler. This invalidates every cached instruction.
+     * @param lazy True to compute flags lazily.
+     */
+    void setLazyFlags(bool lazy);
+
+    /// @return True if instructions are decoded to handlers which compute flags lazily.
+    bool lazyFlags() const { return lazy_flags; }
+
+    /// @return The pages of RAM written since they were last cleared.
+    DirtyPages& dirtyPages() { return dirty; }
+
+private:
+    /**
+     * Decodes the instruction at addr into the cache.
+     * @return The newly decoded instruction.
+     */
+    const DecodedInstruction& decode(const Memory& ram, uint16_t addr);
+};
+
+
+
+inline bool DecodedArgument::isMem() const {
+    switch(loc) {
+        case Location::PAX: case Location::PBX: case Location::PCX:
+        case Location::IMD: case Location::PIMD:
+            return true;
+        default:
+            return false;
+    }
+}
+
+inline const DecodedArgument& DecodedInstruction::arg(uint8_t argn) const {
+    return argn == 2 ? arg2 : arg1;
+}
+
+inline const DecodedInstruction& InstructionCache::fetch(const Memory& ram, uint16_t addr) {
+    const DecodedInstruction& ins = entry(addr);
+    if(ins.generation == generation) return ins;
+    return decode(ram, addr);
+}
+
+inline void InstructionCache::invalidate(uint16_t addr, uint8_t len) {
+    //any instruction starting up to MAX_INS_SIZE - 1 bytes before addr may contain it
+    dirty.mark(addr, len);
+    const uint16_t last = (uint16_t)(addr + len - 1);
+    for(uint8_t x = 0; x < MAX_INS_SIZE + len - 1; ++x) {
+#ifdef OBLIVIOS_PAGED_MEMORY
+        if(pages[(uint16_t)(last - x) / Memory::PAGE_SIZE] == unused) continue;
+#endif
+        entry((uint16_t)(last - x)).generation = 0;
+    }
+}
@@ -1,8 +1,8 @@
 #pragma once
 #include <cstdint>
+#include <cstddef>
+#include <ostream>
 #include <string>
-#include <vector>
-#include <map>
 
 
 enum class Location : uint8_t {
@@ -11,24 +11,98 @@ enum class Location : uint8_t {
 #undef X
 };
 
-const std::vector<std::string> Location_Strings {
+constexpr const char* Location_Strings[] {
 #define X(name, str, dstval, srcval) str
 #include "locations"
 #undef X
 };
 
-const std::map<int8_t, Location> Location_By_Arg1 {
-#define X(name, str, dstval, srcval) {dstval, Location::name}
-#include "locations"
-#undef X
-};
+/// Number of locations including NONE
+constexpr size_t NUM_LOCATIONS = sizeof(Location_Strings) / sizeof(Location_Strings[0]);
+
+/// Number of values a location can be encoded as, they are stored in 4 bits
+constexpr size_t NUM_LOCATION_VALUES = 16;
 
-const std::map<int8_t, Location> Location_By_Arg2 {
-#define X(name, str, dstval, srcval) {srcval, Location::name}
+/// The values each location is encoded as for each argument, negative if it cannot be encoded
+struct LocationEncoding { Location loc; int8_t dstval, srcval; };
+
+constexpr LocationEncoding Location_Encodings[] {
+#define X(name, str, dstval, srcval) {Location::name, dstval, srcval}
 #include "locations"
 #undef X
 };
 
+/// Flat lookup from an encoded value to the location it represents
+struct LocationTable { Location loc[NUM_LOCATION_VALUES]; };
+
+/// Flat lookup from a location to the value it is encoded as
+struct LocationValueTable { int8_t val[NUM_LOCATIONS]; };
+
+/**
+ * Gets the value a location is encoded as.
+ * @param enc The encoding of the location.
+ * @param argn The number of the argument, 1 is the destination, 2 the source.
+ */
+constexpr int8_t LocationEncodingValue(const LocationEncoding& enc, uint8_t argn) {
+    return argn == 1 ? enc.dstval : enc.srcval;
+}
+
+/**
+ * Builds the table of what location each value represents, values which are not used are NONE.
+ * If two locations share a value the first one listed is used.
+ * @param argn The number of the argument, 1 is the destination, 2 the source.
+ */
+constexpr LocationTable makeLocationTable(uint8_t argn) {
+    LocationTable table{};
+    for(size_t x = 0; x < NUM_LOCATION_VALUES; ++x) table.loc[x] = Location::NONE;
+
+    //go backwards so the first listed wins
+    for(size_t x = NUM_LOCATIONS; x-- > 0;) {
+        const int8_t v = LocationEncodingValue(Location_Encodings[x], argn);
+        if(v >= 0 && (size_t)v < NUM_LOCATION_VALUES) table.loc[v] = Location_Encodings[x].loc;
+    }
+    return table;
+}
+
+/**
+ * Builds the table of what value each location is encoded as.
+ * @param argn The number of the argument, 1 is the destination, 2 the source.
+ */
+constexpr LocationValueTable makeLocationValueTable(uint8_t argn) {
+    LocationValueTable table{};
+    for(size_t x = 0; x < NUM_LOCATIONS; ++x)
+        table.val[(uint8_t)Location_Encodings[x].loc] = LocationEncodingValue(Location_Encodings[x], argn);
+    return table;
+}
+
+constexpr LocationTable Location_By_Arg1 = makeLocationTable(1);
+constexpr LocationTable Location_By_Arg2 = makeLocationTable(2);
+constexpr LocationValueTable Location_Values_Arg1 = makeLocationValueTable(1);
+constexpr LocationValueTable Location_Values_Arg2 = makeLocationValueTable(2);
+
+/**
+ * Checks that every location which can be encoded decodes back to itself and is in range.
+ * @param argn The number of the argument, 1 is the destination, 2 the source.
+ */
+constexpr bool checkLocationTables(uint8_t argn) {
+    const LocationTable& by_value = argn == 1 ? Location_By_Arg1 : Location_By_Arg2;
+    const LocationValueTable& values = argn == 1 ? Location_Values_Arg1 : Location_Values_Arg2;
+    for(size_t x = 0; x < NUM_LOCATIONS; ++x) {
+        const LocationEncoding& enc = Location_Encodings[x];
+        const int8_t v = LocationEncodingValue(enc, argn);
+        if((size_t)enc.loc != x) return false; //must be listed in enum order
+        if(values.val[x] != v) return false;
+        if(v < 0) continue;
+        if((size_t)v >= NUM_LOCATION_VALUES) return false;
+        if(by_value.loc[v] != enc.loc) return false;
+    }
+    return true;
+}
+
+static_assert(NUM_LOCATIONS <= UINT8_MAX, "Location must fit in a uint8_t");
+static_assert(checkLocationTables(1), "Destination location values in data/locations are inconsistent");
+static_assert(checkLocationTables(2), "Source location values in data/locations are inconsistent");
+
 
 /**
  * Converts a location enum value to a string representation.
@@ -46,36 +120,24 @@ inline std::ostream& operator<<(std::ostream& out, Location l) {
 /**
  * Gets a location enum value from an integer value.
  * @param loc The integer to be converted
- * @param argn The number of the argument, starting at 1 (currently only 1 and 2 are valid)
- * @return The Location enum value
+ * @param argn The number of the argument, 1 is the destination and 2 the source
+ * @return The Location enum value, NONE if it is not valid
  */
 inline Location LocationFromInt(uint8_t loc, const uint8_t argn = 1) {
-    try {
-        if(argn == 1) return Location_By_Arg1.at(loc);
-        else if(argn == 2) return Location_By_Arg2.at(loc);
-        else throw std::out_of_range("Invalid argument number " + argn);
-    } catch(std::invalid_argument& e) {
-        return Location::NONE;
-    }
+    if(loc >= NUM_LOCATION_VALUES) return Location::NONE;
+    return argn == 1 ? Location_By_Arg1.loc[loc] : Location_By_Arg2.loc[loc];
 }
 
 /**
- * Finds the location in the map and then returns the value that represents it.
+ * Gets the value that represents a location.
  * @param loc Location to find the key for.
  * @param argn Which argument are we searching for, e.g. 1, or 2.
  * @return Value representing that location.
  */
 inline uint8_t LocationToInt(Location loc, uint8_t argn = 1) {
-    auto foundloc = [&loc](std::pair<uint8_t, Location> pair) -> bool {
-        return pair.second == loc;
-    };
-
-    if(argn == 1)
-        return std::find_if(Location_By_Arg1.begin(), Location_By_Arg1.end(), foundloc)->first;
-    else
-        return std::find_if(Location_By_Arg2.begin(), Location_By_Arg2.end(), foundloc)->first;
+    return (uint8_t)(argn == 1 ? Location_Values_Arg1.val[(uint8_t)loc] : Location_Values_Arg2.val[(uint8_t)loc]);
 }
 
 inline uint8_t RouteToInt(Location arg1, Location arg2) {
     return LocationToInt(arg1, 1) | (LocationToInt(arg2, 2) << 4);
-}
\ No newline at end of file
+}
@@ -0,0 +1,376 @@
+#include "lockstep_games.h"
+
+#include "argument.h"
+#include "game.h"
+#include "instruction_cache.h"
+#include "player.h"
+#include "thread.h"
+
+#include <ostream>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+LockstepGames::LockstepGames() {
+    for(uint8_t x = 0; x < LANES; ++x) {
+        lanes[x].game = nullptr;
+        ops[x] = IDLE;
+        dsts[x] = srcs[x] = 0;
+    }
+}
+
+void LockstepGames::run(Game* const* games, size_t count) {
+    size_t next = 0;
+    for(;;) {
+        bool any = false;
+        for(uint8_t x = 0; x < LANES; ++x) {
+            Lane& lane = lanes[x];
+            ops[x] = IDLE;
+            //a lane whose game is over takes the next one
+            while(lane.game || next < count) {
+                if(!lane.game && !begin(lane, games[next++])) continue;
+                if(issue(lane, x)) {
+                    any = true;
+                    break;
+                }
+                lane.game = nullptr;
+            }
+        }
+        if(!any) return;
+        execute();
+    }
+}
+
+bool LockstepGames::begin(Lane& lane, Game* game) {
+    //skipping loops needs every round to end where Game::run can see it
+    if(game->loops) {
+        std::ostream log(nullptr);
+        game->run(log);
+        return false;
+    }
+
+    lane.game = game;
+    if(game->cycle == 0) ++game->cycle;
+    game->cache.dirtyPages().clear();
+
+    lane.alive = 0;
+    for(uint8_t x = 0; x < game->num_players; ++x) if(!game->players[x].threads.empty()) ++lane.alive;
+    if(game->end_reason != GameEnd::PAUSED) game->last_activity = game->cycle;
+    lane.reason = GameEnd::MAX_CYCLES;
+    lane.thread = nullptr;
+    if(carriesOn(lane)) return true;
+    lane.game = nullptr;
+    return false;
+}
+
+bool LockstepGames::carriesOn(Lane& lane) {
+    Game& game = *lane.game;
+    lane.process = 0;
+    if(lane.alive > 0 && game.cycle < game.endCycle(lane.alive) && !game.endsEarly(lane.alive, lane.reason))
+        return true;
+    game.end_reason = lane.alive ? lane.reason : GameEnd::NO_PLAYERS;
+    return false;
+}
+
+bool LockstepGames::startTurn(Lane& lane, uint8_t x) {
+    Game& game = *lane.game;
+    for(;;) {
+        //a dead player is skipped
+        do ++lane.process;
+        while(lane.process <= game.num_players && game.players[lane.process - 1].threads.empty());
+
+        if(lane.process > game.num_players) {
+            if(game.settings.endsOn(GameEnd::IDLE)) {
+                if(game.cache.dirtyPages().any()) game.last_activity = game.cycle;
+                game.cache.dirtyPages().clear();
+            }
+            ++game.cycle;
+            if(!carriesOn(lane)) return false;
+            continue;
+        }
+
+        Player& player = game.players[lane.process - 1];
+        Thread& thread = player.threads.front();
+        game.ownership.setWriter(lane.process);
+        lane.turn_end = game.cycle + player.turn_cycles;
+
+        //an instruction started in an earlier turn only has the rest of its cost left to pay
+        if(thread.cycles > player.turn_cycles) {
+            thread.cycles -= player.turn_cycles;
+            game.cycle = lane.turn_end;
+            game.endTurn(lane.process, true);
+            continue;
+        }
+        lane.remaining = player.turn_cycles - thread.cycles;
+        lane.prepaid = thread.cycles != 0;
+        thread.cycles = 0;
+
+        lane.thread = &thread;
+        load(lane, x);
+        return true;
+    }
+}
+
+void LockstepGames::endTurn(Lane& lane, uint8_t x, bool survived) {
+    Game& game = *lane.game;
+    store(lane, x);
+    lane.thread = nullptr;
+    game.cycle = lane.turn_end - lane.remaining;
+    if(game.endTurn(lane.process, survived)) --lane.alive;
+}
+
+bool LockstepGames::issue(Lane& lane, uint8_t x) {
+    for(;;) {
+        if(!lane.thread && !startTurn(lane, x)) return false;
+        Game& game = *lane.game;
+
+        //charged the same way as Game::execTurnThreaded
+        if(!lane.prepaid && !lane.remaining) {
+            endTurn(lane, x, true);
+            continue;
+        }
+        const DecodedInstruction& ins = game.cache.fetch(game.ram, lane.ip);
+        if(lane.prepaid) lane.prepaid = false;
+        else if(ins.cycles > lane.remaining) {
+            lane.thread->cycles = ins.cycles - lane.remaining;
+            lane.remaining = 0;
+            endTurn(lane, x, true);
+            continue;
+        }
+        else lane.remaining -= ins.cycles;
+
+        const uint16_t ip = lane.ip;
+        lane.ip += ins.size;
+        if(ins.fault != Fault::NONE) {
+            endTurn(lane, x, false);
+            continue;
+        }
+
+        const Kind kind = kindOf(ins);
+        if(kind != IDLE) {
+            ops[x] = kind;
+            dsts[x] = (uint16_t)((uint8_t)ins.arg1.loc - (uint8_t)Location::AX);
+            srcs[x] = source(lane, x, ins);
+            return true;
+        }
+
+        switch(ins.opcode) {
+            //these only move the IP on, see Game::execTurnThreaded
+            case OPCode::NOP: case OPCode::INT:
+            case OPCode::JMP: case OPCode::JMPA:
+            case OPCode::JA: case OPCode::JAE: case OPCode::JB: case OPCode::JBE:
+            case OPCode::JG: case OPCode::JGE: case OPCode::JL: case OPCode::JLE:
+            case OPCode::JE: case OPCode::JNE: case OPCode::JC: case OPCode::JNC:
+            case OPCode::JO: case OPCode::JNO:
+                break;
+            default:
+                if(!scalar(lane, x, ins, ip)) endTurn(lane, x, false);
+                break;
+        }
+    }
+}
+
+LockstepGames::Kind LockstepGames::kindOf(const DecodedInstruction& ins) {
+    switch(ins.arg1.loc) {
+        case Location::AX: case Location::BX: case Location::CX: break;
+        default: return IDLE;
+    }
+    switch(ins.opcode) {
+        case OPCode::MOV:  return MOV;
+        case OPCode::ADD:  return ADD;
+        case OPCode::SUB:  return SUB;
+        case OPCode::AND:  return AND;
+        case OPCode::OR:   return OR;
+        case OPCode::XOR:  return XOR;
+        case OPCode::CMP:  return CMP;
+        case OPCode::TEST: return TEST;
+        default:           return IDLE;
+    }
+}
+
+uint16_t LockstepGames::source(const Lane& lane, uint8_t x, const DecodedInstruction& ins) const {
+    //read through a const Memory so a page of RAM shared with a fork is not copied to be read
+    const Memory& ram = lane.game->ram;
+    const DecodedArgument& arg = ins.arg2;
+    uint16_t addr = arg.addr;
+
+    //the destination is 16 bits so the operation is too, see Argument::is8BitOp
+    switch(arg.loc) {
+        case Location::AL: return (uint8_t)regs[0][x];
+        case Location::AH: return regs[0][x] >> 8;
+        case Location::BL: return (uint8_t)regs[1][x];
+        case Location::BH: return regs[1][x] >> 8;
+        case Location::CL: return (uint8_t)regs[2][x];
+        case Location::CH: return regs[2][x] >> 8;
+        case Location::AX: return regs[0][x];
+        case Location::BX: return regs[1][x];
+        case Location::CX: return regs[2][x];
+        case Location::IP: return lane.ip;
+
+        //relative addressing is from the end of the instruction, which the IP has moved on to
+        case Location::PAX: case Location::PBX: case Location::PCX: {
+            const uint16_t reg = regs[(uint8_t)arg.loc - (uint8_t)Location::PAX][x];
+            addr = arg.mode == AccessMode::RELATIVE ? (uint16_t)(lane.ip + (int16_t)reg) : reg;
+            break;
+        }
+        case Location::IMD: case Location::PIMD: break;
+        case Location::NONE: return 0; //reported by the decoder as Fault::INVALID_LOCATION
+    }
+    return (uint16_t)(ram[addr] << 8 | ram[(uint16_t)(addr + 1)]);
+}
+
+bool LockstepGames::scalar(Lane& lane, uint8_t x, const DecodedInstruction& ins, uint16_t ip) {
+    Game& game = *lane.game;
+    Thread& thread = *lane.thread;
+    store(lane, x);
+
+    //the arguments are found from where the instruction starts, see Game::execTurnThreaded
+    thread.ip = ip;
+    Argument arg1(thread, game.ram, ins, 1, &game.cache, &game.ownership);
+    Argument arg2(thread, game.ram, ins, 2, &game.cache, &game.ownership);
+    thread.ip = lane.ip;
+    const Fault fault = ins.handler(thread, arg1, arg2);
+
+    load(lane, x);
+    return fault == Fault::NONE;
+}
+
+void LockstepGames::load(Lane& lane, uint8_t x) {
+    Thread& thread = *lane.thread;
+    thread.resolveFlags();
+    regs[0][x] = thread.ax;
+    regs[1][x] = thread.bx;
+    regs[2][x] = thread.cx;
+    lane.ip = thread.ip;
+    flags[0][x] = thread.o ? 0xFFFF : 0;
+    flags[1][x] = thread.s ? 0xFFFF : 0;
+    flags[2][x] = thread.z ? 0xFFFF : 0;
+    flags[3][x] = thread.c ? 0xFFFF : 0;
+    operands[0][x] = thread.pending.arg1;
+    operands[1][x] = thread.pending.arg2;
+    operands[2][x] = thread.pending.result;
+    ebits[x] = thread.pending.ebit ? 0xFFFF : 0;
+}
+
+void LockstepGames::store(Lane& lane, uint8_t x) {
+    Thread& thread = *lane.thread;
+    thread.ax = regs[0][x];
+    thread.bx = regs[1][x];
+    thread.cx = regs[2][x];
+    thread.ip = lane.ip;
+    thread.o = flags[0][x] != 0;
+    thread.s = flags[1][x] != 0;
+    thread.z = flags[2][x] != 0;
+    thread.c = flags[3][x] != 0;
+    thread.pending = {FlagOp::NONE, ebits[x] != 0, operands[0][x], operands[1][x], operands[2][x]};
+}
+
+
+#if defined(__SSE2__)
+//Lanes of mask are taken from b, the rest from a
+static inline __m128i blend(__m128i a, __m128i b, __m128i mask) {
+    return _mm_or_si128(_mm_andnot_si128(mask, a), _mm_and_si128(mask, b));
+}
+
+static inline __m128i load128(const uint16_t* src) {
+    return _mm_load_si128((const __m128i*)src);
+}
+
+static inline void store128(uint16_t* dst, __m128i v) {
+    _mm_store_si128((__m128i*)dst, v);
+}
+#endif
+
+void LockstepGames::execute() {
+#if defined(__SSE2__)
+    const __m128i op = load128(ops);
+    const __m128i dst = load128(dsts);
+    const __m128i b = load128(srcs);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_cmpeq_epi16(zero, zero);
+
+    //the destination of each lane
+    __m128i reg[3], to[3];
+    __m128i a = zero;
+    for(uint8_t r = 0; r < 3; ++r) {
+        reg[r] = load128(regs[r]);
+        to[r] = _mm_cmpeq_epi16(dst, _mm_set1_epi16(r));
+        a = _mm_or_si128(a, _mm_and_si128(to[r], reg[r]));
+    }
+
+    //CMP sets the flags as SUB does and TEST as AND does, they only leave out the write
+    const __m128i is_mov = _mm_cmpeq_epi16(op, _mm_set1_epi16(MOV));
+    const __m128i is_add = _mm_cmpeq_epi16(op, _mm_set1_epi16(ADD));
+    const __m128i is_cmp = _mm_cmpeq_epi16(op, _mm_set1_epi16(CMP));
+    const __m128i is_test = _mm_cmpeq_epi16(op, _mm_set1_epi16(TEST));
+    const __m128i is_sub = _mm_or_si128(_mm_cmpeq_epi16(op, _mm_set1_epi16(SUB)), is_cmp);
+    const __m128i is_and = _mm_or_si128(_mm_cmpeq_epi16(op, _mm_set1_epi16(AND)), is_test);
+    const __m128i is_or = _mm_cmpeq_epi16(op, _mm_set1_epi16(OR));
+    const __m128i is_xor = _mm_cmpeq_epi16(op, _mm_set1_epi16(XOR));
+    const __m128i sets = _mm_or_si128(_mm_or_si128(is_add, is_sub), _mm_or_si128(is_and, _mm_or_si128(is_or, is_xor)));
+    const __m128i writes = _mm_andnot_si128(_mm_or_si128(is_cmp, is_test), _mm_or_si128(sets, is_mov));
+
+    const __m128i sum = _mm_add_epi16(a, b);
+    const __m128i diff = _mm_sub_epi16(a, b);
+    __m128i result = _mm_and_si128(is_mov, b);
+    result = _mm_or_si128(result, _mm_and_si128(is_add, sum));
+    result = _mm_or_si128(result, _mm_and_si128(is_sub, diff));
+    result = _mm_or_si128(result, _mm_and_si128(is_and, _mm_and_si128(a, b)));
+    result = _mm_or_si128(result, _mm_and_si128(is_or, _mm_or_si128(a, b)));
+    result = _mm_or_si128(result, _mm_and_si128(is_xor, _mm_xor_si128(a, b)));
+
+    for(uint8_t r = 0; r < 3; ++r) store128(regs[r], blend(reg[r], result, _mm_and_si128(to[r], writes)));
+
+    //the same flags as Thread::resolveFlags, a 16 bit sum carries exactly when it is below either
+    // argument and there is no unsigned compare so a saturated subtraction is used instead
+    const __m128i add_c = _mm_xor_si128(_mm_cmpeq_epi16(_mm_subs_epu16(a, sum), zero), ones);
+    const __m128i sub_c = _mm_xor_si128(_mm_cmpeq_epi16(_mm_subs_epu16(b, a), zero), ones);
+    const __m128i add_o = _mm_srai_epi16(_mm_andnot_si128(_mm_xor_si128(a, b), _mm_xor_si128(a, result)), 15);
+    const __m128i sub_o = _mm_srai_epi16(_mm_and_si128(_mm_xor_si128(a, b), _mm_xor_si128(a, result)), 15);
+    const __m128i o = _mm_or_si128(_mm_and_si128(is_add, add_o), _mm_and_si128(is_sub, sub_o));
+    const __m128i c = _mm_or_si128(_mm_and_si128(is_add, add_c), _mm_and_si128(is_sub, sub_c));
+    const __m128i s = _mm_srai_epi16(result, 15);
+    const __m128i z = _mm_cmpeq_epi16(result, zero);
+
+    store128(flags[0], blend(load128(flags[0]), o, sets));
+    store128(flags[1], blend(load128(flags[1]), s, sets));
+    store128(flags[2], blend(load128(flags[2]), z, sets));
+    store128(flags[3], blend(load128(flags[3]), c, sets));
+    store128(operands[0], blend(load128(operands[0]), a, sets));
+    store128(operands[1], blend(load128(operands[1]), b, sets));
+    store128(operands[2], blend(load128(operands[2]), result, sets));
+    store128(ebits, _mm_andnot_si128(sets, load128(ebits)));
+#else
+    for(uint8_t x = 0; x < LANES; ++x) {
+        if(ops[x] == IDLE) continue;
+        uint16_t& reg = regs[dsts[x]][x];
+        const uint16_t a = reg, b = srcs[x];
+        uint16_t result;
+        FlagOp flag_op;
+        switch(ops[x]) {
+            case MOV:   reg = b; continue;
+            case ADD:   result = reg = (uint16_t)(a + b); flag_op = FlagOp::ADD; break;
+            case SUB:   result = reg = (uint16_t)(a - b); flag_op = FlagOp::SUB; break;
+            case CMP:   result = (uint16_t)(a - b); flag_op = FlagOp::SUB; break;
+            case AND:   result = reg = a & b; flag_op = FlagOp::LOGIC; break;
+            case TEST:  result = a & b; flag_op = FlagOp::LOGIC; break;
+            case OR:    result = reg = a | b; flag_op = FlagOp::LOGIC; break;
+            case XOR:   result = reg = a ^ b; flag_op = FlagOp::LOGIC; break;
+            default:    continue;
+        }
+
+        Thread flagged;
+        flagged.setFlags<false>(flag_op, a, b, result, false);
+        flags[0][x] = flagged.o ? 0xFFFF : 0;
+        flags[1][x] = flagged.s ? 0xFFFF : 0;
+        flags[2][x] = flagged.z ? 0xFFFF : 0;
+        flags[3][x] = flagged.c ? 0xFFFF : 0;
+        operands[0][x] = a;
+        operands[1][x] = b;
+        operands[2][x] = result;
+        ebits[x] = 0;
+    }
+#endif
+}
@@ -0,0 +1,134 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "game_end.h"
+
+class Game;
+struct DecodedInstruction;
+struct Thread;
+
+
+/**
+ * Plays many games at once on one core, LANES of them in lockstep. The registers and flags of the
+ * thread each game is running are stored struct-of-arrays, one lane per game, and every step runs
+ * one instruction of each game. MOV, ADD, SUB, AND, OR, XOR, CMP, and TEST into AX, BX, or CX are
+ * run for every lane in a single pass with SIMD (SSE2 where the target has it, a loop over the
+ * lanes otherwise). Each game fetches and pays for its own instructions and reads their sources
+ * itself, and a game which diverges from the common opcodes runs the instruction on its own
+ * through the handler it was decoded to, so every game goes its own way. NOP, INT, and the jumps
+ * only move the IP on.
+ *
+ * Games end up exactly as if each were run alone with nothing logged. A game which looks for loops
+ * ("repetition" in its config) is run alone, since skipping a loop is decided at the end of every
+ * round. Speculative turns and the scheduler are not used, every turn is played as it is with
+ * "scheduler": "rounds".
+ */
+class LockstepGames {
+public:
+    /// Games run in lockstep, one per 16 bit lane of an SSE2 register
+    static const uint8_t LANES = 8;
+
+private:
+    /// What a lane runs in the vector pass of a step, IDLE if it has nothing to run
+    enum Kind : uint16_t { IDLE, MOV, ADD, SUB, AND, OR, XOR, CMP, TEST };
+
+    /// Where a lane is in its game, everything but the registers and flags of the running thread
+    struct Lane {
+        /// The game being played, null once it is over
+        Game* game;
+        /// The pid whose turn it is, 0 at the start of a round
+        uint8_t process;
+        /// Players with threads left
+        uint8_t alive;
+        /// Why the game will end if it ends before max cycles or with players left
+        GameEnd reason;
+
+        /// The thread whose turn it is, null between turns
+        Thread* thread;
+        uint16_t ip;
+        /// Cycles left in the turn
+        uint32_t remaining;
+        /// The cycle the turn ends on if it runs out of cycles, see Game::execTurnThreaded
+        uint64_t turn_end;
+        /// The instruction at ip was paid for in an earlier turn and is run without being charged
+        bool prepaid;
+    };
+    Lane lanes[LANES];
+
+    /// AX, BX, and CX of each lane's thread
+    alignas(16) uint16_t regs[3][LANES];
+    /// Overflow, sign, zero, and carry of each lane's thread, 0xFFFF if set and 0 if not
+    alignas(16) uint16_t flags[4][LANES];
+    /// The operands and result of the last operation which set every flag, kept in Thread::pending
+    /// even once the flags are computed so a checkpoint is the same as the game run alone
+    alignas(16) uint16_t operands[3][LANES];
+    /// Whether that operation was 8 bit, 0xFFFF if it was and 0 if not
+    alignas(16) uint16_t ebits[LANES];
+
+    /// The Kind each lane runs in the vector pass
+    alignas(16) uint16_t ops[LANES];
+    /// The register each lane writes to, an index into regs
+    alignas(16) uint16_t dsts[LANES];
+    /// The value of each lane's source
+    alignas(16) uint16_t srcs[LANES];
+
+    /**
+     * Starts a lane on a game, carrying on from wherever the game is as Game::run does.
+     * @return False if the game is already over.
+     */
+    bool begin(Lane& lane, Game* game);
+
+    /**
+     * Ends a round of the lane's game and checks whether it carries on, see Game::run.
+     * @return False if the game is over.
+     */
+    bool carriesOn(Lane& lane);
+
+    /**
+     * Moves on to the next turn of the lane's game and loads its thread into the lane.
+     * @return False if the game is over.
+     */
+    bool startTurn(Lane& lane, uint8_t x);
+
+    /// Stores the lane's thread back and lets the game deal with the end of its turn.
+    void endTurn(Lane& lane, uint8_t x, bool survived);
+
+    /**
+     * Runs the lane's game until it reaches an instruction for the vector pass and sets up the lane
+     * to run it.
+     * @return False if the game ended first.
+     */
+    bool issue(Lane& lane, uint8_t x);
+
+    /// @return The Kind ins is run as in the vector pass, IDLE if it is run alone.
+    static Kind kindOf(const DecodedInstruction& ins);
+
+    /// @return The value of the source of ins for lane x, whose IP has moved past it.
+    uint16_t source(const Lane& lane, uint8_t x, const DecodedInstruction& ins) const;
+
+    /**
+     * Runs an instruction on the lane's thread through its handler.
+     * @param ip Where the instruction starts, lane.ip is already past it.
+     * @return True if the thread survived.
+     */
+    bool scalar(Lane& lane, uint8_t x, const DecodedInstruction& ins, uint16_t ip);
+
+    /// Copies the thread into lane x, computing any flags which were left pending.
+    void load(Lane& lane, uint8_t x);
+    /// Copies lane x back into its thread.
+    void store(Lane& lane, uint8_t x);
+
+    /// Runs the instruction set up for every lane, the vector pass of a step.
+    void execute();
+
+public:
+    LockstepGames();
+
+    /**
+     * Plays every game to the end, as Game::run would with nothing logged.
+     * @param games The games, each carries on from wherever it is.
+     * @param count Number of games, any number of them; a lane whose game ends takes the next one.
+     */
+    void run(Game* const* games, size_t count);
+};
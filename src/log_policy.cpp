@@ -0,0 +1,15 @@
+#include "log_policy.h"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+
+LogEvents LogEventsFromString(const std::string& s) {
+    const auto begin = std::begin(LogEvents_Strings);
+    const auto end = std::end(LogEvents_Strings);
+
+    const auto loc = std::find(begin, end, s);
+    if(loc == end) throw std::invalid_argument(s + " is not a valid log policy.");
+    return (LogEvents)(loc - begin);
+}
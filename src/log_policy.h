@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+
+/**
+ * Which events a game reports. These are template parameters of Game::run so each one compiles
+ * down to only the work needed for the events it reports; a game with LogPolicy::None creates no
+ * events at all.
+ */
+namespace LogPolicy {
+    /// Every instruction run, what the viewers need
+    struct Full {
+        static constexpr bool enabled = true, init = true, instructions = true, turns = false,
+                              deaths = true, scores = true, reads = false;
+    };
+
+    /// One event per thread turn rather than per instruction
+    struct Turns {
+        static constexpr bool enabled = true, init = true, instructions = false, turns = true,
+                              deaths = true, scores = true, reads = false;
+    };
+
+    /// Only threads dying and the final scores
+    struct Deaths {
+        static constexpr bool enabled = true, init = false, instructions = false, turns = false,
+                              deaths = true, scores = true, reads = false;
+    };
+
+    /// Nothing at all
+    struct None {
+        static constexpr bool enabled = false, init = false, instructions = false, turns = false,
+                              deaths = false, scores = false, reads = false;
+    };
+
+    /// The same events as P and also every byte of RAM read, see EventLog::read
+    template<class P>
+    struct Speculative : P {
+        static constexpr bool reads = true;
+    };
+}
+
+/// The policies which can be chosen at runtime, see LogPolicy
+enum class LogEvents : uint8_t {
+#define X(name, policy, str) name,
+#include "log_policies"
+#undef X
+};
+
+constexpr const char* LogEvents_Strings[] {
+#define X(name, policy, str) str,
+#include "log_policies"
+#undef X
+};
+
+/**
+ * @param s The name of a policy, e.g. "full".
+ * @return The policy.
+ * @throws std::invalid_argument if it is not a policy.
+ */
+LogEvents LogEventsFromString(const std::string& s);
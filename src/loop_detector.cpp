@@ -0,0 +1,65 @@
+#include "loop_detector.h"
+
+#include <algorithm>
+
+
+uint64_t LoopDetector::threadHash(size_t slot, const Thread& thread) {
+    const uint64_t registers = (uint64_t)thread.ax | (uint64_t)thread.bx << 16 | (uint64_t)thread.cx << 32 |
+                               (uint64_t)thread.ip << 48;
+    const uint64_t flags = (uint64_t)thread.o | (uint64_t)thread.s << 1 | (uint64_t)thread.z << 2 |
+                           (uint64_t)thread.c << 3 | (uint64_t)thread.cycles << 8;
+    return mix(mix(registers) ^ flags ^ (uint64_t)slot << 40);
+}
+
+void LoopDetector::reset(const Memory& ram, const Player* players, uint8_t num_players,
+                         const Thread* slots, uint64_t cycle) {
+    state = 0;
+    for(uint32_t addr = 0; addr < Memory::SIZE; ++addr)
+        state ^= byteHash((uint16_t)addr, ram[(uint16_t)addr]) ^ ownerHash((uint16_t)addr, ram.owner((uint16_t)addr));
+
+    size_t total_threads = 0;
+    for(uint8_t x = 0; x < num_players; ++x) total_threads += std::max<uint8_t>(players[x].max_threads, 1);
+    threads.assign(total_threads, 0);
+
+    for(uint8_t x = 0; x < num_players; ++x) {
+        const Player& player = players[x];
+        if(player.threads.empty()) continue;
+        const Thread* thread = &player.threads.front();
+        for(size_t t = 0; t < player.threads.size(); ++t, thread = thread->next) {
+            const size_t slot = thread - slots;
+            threads[slot] = threadHash(slot, *thread);
+            state ^= threads[slot];
+        }
+        moved((uint8_t)(x + 1), slots, player);
+    }
+
+    restart(cycle);
+}
+
+void LoopDetector::turn(uint8_t pid, const Thread* slots, const Player& player, bool survived) {
+    const Thread& thread = player.threads.front();
+    const size_t slot = &thread - slots;
+    state ^= threads[slot] ^ frontHash(pid, slot);
+    threads[slot] = survived ? threadHash(slot, thread) : 0;
+    state ^= threads[slot];
+}
+
+uint64_t LoopDetector::endRound(uint64_t cycle) {
+    ++rounds;
+    if(state == saved) return rounds;
+
+    if(rounds == power) {
+        saved = state;
+        saved_cycle = cycle;
+        power *= 2;
+        rounds = 0;
+    }
+    return 0;
+}
+
+void LoopDetector::restart(uint64_t cycle) {
+    saved = state;
+    saved_cycle = cycle;
+    rounds = 0;
+    power = 1;
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "memory.h"
+#include "player.h"
+#include "thread.h"
+
+
+/**
+ * Finds games which have fallen into a loop, so that they can be ended or skipped to max_cycles
+ * rather than played out. A game which is in the same state at the end of two rounds plays the
+ * same rounds in between forever, nobody can die in them since threads are never created.
+ *
+ * The state is every byte of RAM and its owner, every thread's registers, flags, leftover cycles,
+ * and slot, and which thread takes each player's next turn. It is kept as a 64 bit hash which is
+ * the xor of a hash of each of those, so a write or a turn only takes out the old one and puts the
+ * new one in rather than hashing the whole game again. The hashes at the end of rounds are
+ * compared with Brent's algorithm, which finds a loop within twice the rounds it took to get into
+ * it using no memory.
+ */
+class LoopDetector {
+    uint64_t state;
+    /// What each thread slot adds to the state, 0 if it is not in use
+    std::vector<uint64_t> threads;
+
+    /// The state looked for in later rounds, and the cycle it was seen on
+    uint64_t saved;
+    uint64_t saved_cycle;
+    /// Rounds since it was saved, it is saved again once this reaches power which doubles each time
+    uint64_t rounds, power;
+
+    /// @return A well mixed hash of x, the finalizer of splitmix64.
+    static inline uint64_t mix(uint64_t x) {
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    static uint64_t byteHash(uint16_t addr, uint8_t byte) { return mix((1ull << 32) | (uint32_t)addr << 8 | byte); }
+    static uint64_t ownerHash(uint16_t addr, uint8_t pid) { return mix((2ull << 32) | (uint32_t)addr << 8 | pid); }
+    static uint64_t frontHash(uint8_t pid, size_t slot) { return mix((3ull << 56) | (uint64_t)slot << 8 | pid); }
+    static uint64_t threadHash(size_t slot, const Thread& thread);
+
+public:
+    LoopDetector() : state(0), saved(0), saved_cycle(0), rounds(0), power(1) {}
+
+    /**
+     * Hashes the whole game from scratch and forgets every round before now.
+     * @param ram The game's RAM.
+     * @param players Array of players, index i is the player with pid i + 1.
+     * @param num_players Size of the array.
+     * @param slots Every thread slot of every player.
+     * @param cycle The cycle the game is on.
+     */
+    void reset(const Memory& ram, const Player* players, uint8_t num_players, const Thread* slots,
+               uint64_t cycle);
+
+    /**
+     * A byte of RAM is about to be written.
+     * @param addr Its address.
+     * @param old What it holds now.
+     * @param byte What it will hold.
+     */
+    inline void byte(uint16_t addr, uint8_t old, uint8_t byte) { state ^= byteHash(addr, old) ^ byteHash(addr, byte); }
+
+    /**
+     * A byte of RAM changed owner.
+     * @param addr Its address.
+     * @param old The pid of its old owner.
+     * @param pid The pid of its new owner.
+     */
+    inline void owner(uint16_t addr, uint8_t old, uint8_t pid) { state ^= ownerHash(addr, old) ^ ownerHash(addr, pid); }
+
+    /**
+     * A thread's turn is over, it must be called before the player moves on to its next thread.
+     * @param pid The pid of the thread's player.
+     * @param slots Every thread slot of every player.
+     * @param player The thread's player, the thread is its front thread and its flags must have
+     *               been resolved.
+     * @param survived False if the thread is about to be killed.
+     */
+    void turn(uint8_t pid, const Thread* slots, const Player& player, bool survived);
+
+    /**
+     * The player has moved on to its next thread, or has none left.
+     * @param pid The pid of the player.
+     * @param slots Every thread slot of every player.
+     * @param player The player.
+     */
+    void moved(uint8_t pid, const Thread* slots, const Player& player) {
+        if(!player.threads.empty()) state ^= frontHash(pid, &player.threads.front() - slots);
+    }
+
+    /**
+     * Notes the state at the end of a round.
+     * @param cycle The cycle the game is on.
+     * @return Number of rounds the game has gone round in a loop since the state was last the
+     *         same as now, 0 if no loop has been found.
+     */
+    uint64_t endRound(uint64_t cycle);
+
+    /// @return The cycles the last loop found took, see endRound.
+    uint64_t loopCycles(uint64_t cycle) const { return cycle - saved_cycle; }
+
+    /// @return The hash of the state as it is now.
+    uint64_t hash() const { return state; }
+
+    /// Forgets every round before now, as after the game skips ahead.
+    void restart(uint64_t cycle);
+};
@@ -0,0 +1,201 @@
+#include "memory.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+#ifdef OBLIVIOS_PAGED_MEMORY
+Memory::Page Memory::zero(1);
+
+Memory::Memory() {
+    std::fill_n(pages, NUM_PAGES, &zero);
+    zero.refs.fetch_add(NUM_PAGES, std::memory_order_relaxed);
+}
+
+Memory::Memory(const Memory& other) {
+    for(uint32_t x = 0; x < NUM_PAGES; ++x) {
+        pages[x] = other.pages[x];
+        pages[x]->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+Memory& Memory::operator=(const Memory& other) {
+    //the new pages are taken before the old ones are let go in case they are the same
+    for(uint32_t x = 0; x < NUM_PAGES; ++x) {
+        Page* old = pages[x];
+        pages[x] = other.pages[x];
+        pages[x]->refs.fetch_add(1, std::memory_order_relaxed);
+        release(old);
+    }
+    return *this;
+}
+
+Memory::~Memory() {
+    for(Page* page : pages) release(page);
+}
+
+Memory::Page* Memory::unshare(uint32_t page) {
+    Page* copy = new Page(1);
+    std::memcpy(copy->bytes, pages[page]->bytes, PAGE_SIZE);
+    std::memcpy(copy->owners, pages[page]->owners, PAGE_SIZE);
+    release(pages[page]);
+    return pages[page] = copy;
+}
+
+void Memory::release(Page* page) {
+    //the last to let go of a page frees it, the zero page is never let go of by its own reference
+    if(page->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) delete page;
+}
+#else
+Memory::Memory() {
+    clear();
+}
+#endif
+
+Memory::Memory(std::initializer_list<uint8_t> init) : Memory() {
+    uint16_t addr = 0;
+    for(uint8_t byte : init) (*this)[addr++] = byte;
+}
+
+void Memory::clear() {
+#if defined(OBLIVIOS_PAGED_MEMORY)
+    for(Page*& page : pages) {
+        if(page == &zero) continue;
+        release(page);
+        page = &zero;
+        zero.refs.fetch_add(1, std::memory_order_relaxed);
+    }
+#elif defined(OBLIVIOS_INTERLEAVED_MEMORY)
+    std::fill_n(cells, SIZE, Cell{0, 0});
+#else
+    std::fill_n(bytes, SIZE, 0);
+    std::fill_n(owners, SIZE, 0);
+#endif
+}
+
+void Memory::load(uint16_t addr, const uint8_t* src, size_t size, uint8_t owner) {
+    for(size_t x = 0; x < size; ++x) {
+        (*this)[(uint16_t)(addr + x)] = src[x];
+        this->owner((uint16_t)(addr + x)) = owner;
+    }
+}
+
+#ifdef OBLIVIOS_PAGED_MEMORY
+//copies bytes a page at a time, page gets the array of a page they come from
+template<class PageArray>
+static inline void copyPaged(uint16_t addr, size_t size, uint8_t* dst, PageArray page) {
+    for(size_t x = 0; x < size;) {
+        const uint16_t at = (uint16_t)(addr + x);
+        const size_t run = std::min<size_t>(size - x, Memory::PAGE_SIZE - at % Memory::PAGE_SIZE);
+        std::memcpy(dst + x, page(at / Memory::PAGE_SIZE) + at % Memory::PAGE_SIZE, run);
+        x += run;
+    }
+}
+#endif
+
+void Memory::copyBytes(uint16_t addr, size_t size, uint8_t* dst) const {
+#if defined(OBLIVIOS_PAGED_MEMORY)
+    copyPaged(addr, size, dst, [this](uint32_t page){ return (const uint8_t*)pages[page]->bytes; });
+#elif defined(OBLIVIOS_INTERLEAVED_MEMORY)
+    for(size_t x = 0; x < size; ++x) dst[x] = cells[(uint16_t)(addr + x)].byte;
+#else
+    const size_t first = std::min<size_t>(size, SIZE - addr);
+    std::memcpy(dst, bytes + addr, first);
+    std::memcpy(dst + first, bytes, size - first);
+#endif
+}
+
+void Memory::copyOwners(uint16_t addr, size_t size, uint8_t* dst) const {
+#if defined(OBLIVIOS_PAGED_MEMORY)
+    copyPaged(addr, size, dst, [this](uint32_t page){ return (const uint8_t*)pages[page]->owners; });
+#elif defined(OBLIVIOS_INTERLEAVED_MEMORY)
+    for(size_t x = 0; x < size; ++x) dst[x] = cells[(uint16_t)(addr + x)].owner;
+#else
+    const size_t first = std::min<size_t>(size, SIZE - addr);
+    std::memcpy(dst, owners + addr, first);
+    std::memcpy(dst + first, owners, size - first);
+#endif
+}
+
+uint32_t Memory::countOwned(uint8_t owner) const {
+#if defined(OBLIVIOS_PAGED_MEMORY)
+    uint32_t total = 0;
+    for(const Page* page : pages) total += count(page->owners, PAGE_SIZE, owner);
+    return total;
+#elif defined(OBLIVIOS_INTERLEAVED_MEMORY)
+    uint32_t total = 0;
+    uint32_t x = 0;
+
+#if defined(__SSE2__)
+    //shifting each cell right by 8 leaves its owner, matches are -1 so subtracting them counts up
+    // each of the 8 lanes which cannot overflow as each sees at most SIZE / 8 cells
+    const __m128i target = _mm_set1_epi16(owner);
+    __m128i counts = _mm_setzero_si128();
+    for(; x + 8 <= SIZE; x += 8) {
+        const __m128i block = _mm_loadu_si128((const __m128i*)(cells + x));
+        counts = _mm_sub_epi16(counts, _mm_cmpeq_epi16(_mm_srli_epi16(block, 8), target));
+    }
+    uint16_t lanes[8];
+    _mm_storeu_si128((__m128i*)lanes, counts);
+    for(uint16_t lane : lanes) total += lane;
+#endif
+
+    for(; x < SIZE; ++x) total += cells[x].owner == owner;
+    return total;
+#else
+    return count(owners, SIZE, owner);
+#endif
+}
+
+uint32_t Memory::count(const uint8_t* pid, size_t size, uint8_t owner) {
+    uint32_t total = 0;
+    size_t x = 0;
+
+#if defined(__SSE2__)
+    //matches are -1 so subtracting them counts up each byte, the bytes are added into the total
+    // before any of them can overflow
+    const __m128i target = _mm_set1_epi8((char)owner);
+    while(x + 16 <= size) {
+        __m128i counts = _mm_setzero_si128();
+        for(uint32_t block = 0; block < 255 && x + 16 <= size; ++block, x += 16) {
+            const __m128i bytes = _mm_loadu_si128((const __m128i*)(pid + x));
+            counts = _mm_sub_epi8(counts, _mm_cmpeq_epi8(bytes, target));
+        }
+        const __m128i sums = _mm_sad_epu8(counts, _mm_setzero_si128());
+        total += (uint32_t)_mm_cvtsi128_si32(sums) + (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(sums, 8));
+    }
+#endif
+
+    for(; x < size; ++x) total += pid[x] == owner;
+    return total;
+}
+
+uint32_t Memory::sharedPages() const {
+#ifdef OBLIVIOS_PAGED_MEMORY
+    return (uint32_t)std::count_if(pages, pages + NUM_PAGES, [](const Page* page) {
+        return page->refs.load(std::memory_order_relaxed) != 1;
+    });
+#else
+    return 0;
+#endif
+}
+
+bool Memory::operator==(const Memory& other) const {
+#if defined(OBLIVIOS_PAGED_MEMORY)
+    for(uint32_t x = 0; x < NUM_PAGES; ++x) {
+        const Page* a = pages[x];
+        const Page* b = other.pages[x];
+        if(a != b && (std::memcmp(a->bytes, b->bytes, PAGE_SIZE) || std::memcmp(a->owners, b->owners, PAGE_SIZE)))
+            return false;
+    }
+    return true;
+#elif defined(OBLIVIOS_INTERLEAVED_MEMORY)
+    return std::memcmp(cells, other.cells, sizeof(cells)) == 0;
+#else
+    return std::memcmp(bytes, other.bytes, SIZE) == 0 && std::memcmp(owners, other.owners, SIZE) == 0;
+#endif
+}
@@ -0,0 +1,148 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+#if defined(OBLIVIOS_PAGED_MEMORY) && defined(OBLIVIOS_INTERLEAVED_MEMORY)
+#error "OBLIVIOS_PAGED_MEMORY and OBLIVIOS_INTERLEAVED_MEMORY are different layouts of RAM, choose one"
+#endif
+
+
+/**
+ * The game's RAM along with the pid of the player who last wrote each byte, 0 if nobody has.
+ *
+ * By default the bytes and their owners are two separate arrays, which keeps RAM contiguous for
+ * instruction fetch and dumps. Building with OBLIVIOS_INTERLEAVED_MEMORY stores each byte next to
+ * its owner in a 16-bit cell instead, so a write which changes both only touches one cache line.
+ * Building with OBLIVIOS_PAGED_MEMORY splits RAM into pages which copies of it share, a page is
+ * only copied once one of them writes it, so many forks of a game cost little more than the pages
+ * they change. Everything reads and writes RAM through this class so any layout can be used, but
+ * RAM should be read through a const Memory where it is not written so no page is copied for it.
+ */
+class Memory {
+public:
+    /// Number of bytes of RAM
+    static const uint32_t SIZE = 0x10000;
+    /// Bytes in a page of the paged layout, and pages in RAM
+    static const uint32_t PAGE_SIZE = 0x100;
+    static const uint32_t NUM_PAGES = SIZE / PAGE_SIZE;
+
+private:
+#if defined(OBLIVIOS_PAGED_MEMORY)
+    struct Page {
+        /// Number of Memorys sharing the page, it can only be written by a Memory which does not share it
+        std::atomic<uint32_t> refs;
+        uint8_t bytes[PAGE_SIZE];
+        uint8_t owners[PAGE_SIZE];
+
+        constexpr Page(uint32_t refs) : refs(refs), bytes{}, owners{} {}
+    };
+    Page* pages[NUM_PAGES];
+
+    /// A page of zeros owned by nobody which RAM starts out sharing, it is never freed
+    static Page zero;
+
+    /// @return The page holding addr, copied first if it is shared.
+    inline Page& writable(uint16_t addr) {
+        Page* page = pages[addr / PAGE_SIZE];
+        if(page->refs.load(std::memory_order_acquire) != 1) page = unshare(addr / PAGE_SIZE);
+        return *page;
+    }
+
+    /// Replaces a shared page with a copy of it which is not shared.
+    Page* unshare(uint32_t page);
+
+    /// Stops sharing a page, freeing it if nothing else does.
+    static void release(Page* page);
+#elif defined(OBLIVIOS_INTERLEAVED_MEMORY)
+    struct Cell {
+        uint8_t byte;
+        uint8_t owner;
+    };
+    Cell cells[SIZE];
+#else
+    uint8_t bytes[SIZE];
+    uint8_t owners[SIZE];
+#endif
+
+public:
+    /// All of RAM is 0 and owned by nobody.
+    Memory();
+
+    /// @param init Bytes at the start of RAM, everything after them is 0. Nothing is owned.
+    Memory(std::initializer_list<uint8_t> init);
+
+#ifdef OBLIVIOS_PAGED_MEMORY
+    /// Shares every page of other until either writes it.
+    Memory(const Memory& other);
+    Memory& operator=(const Memory& other);
+    ~Memory();
+#endif
+
+    /// Sets every byte and owner to 0.
+    void clear();
+
+#if defined(OBLIVIOS_PAGED_MEMORY)
+    uint8_t operator[](uint16_t addr) const { return pages[addr / PAGE_SIZE]->bytes[addr % PAGE_SIZE]; }
+    uint8_t& operator[](uint16_t addr) { return writable(addr).bytes[addr % PAGE_SIZE]; }
+
+    /// @return The pid of the player who last wrote the byte at addr.
+    uint8_t owner(uint16_t addr) const { return pages[addr / PAGE_SIZE]->owners[addr % PAGE_SIZE]; }
+    uint8_t& owner(uint16_t addr) { return writable(addr).owners[addr % PAGE_SIZE]; }
+#elif defined(OBLIVIOS_INTERLEAVED_MEMORY)
+    uint8_t operator[](uint16_t addr) const { return cells[addr].byte; }
+    uint8_t& operator[](uint16_t addr) { return cells[addr].byte; }
+
+    /// @return The pid of the player who last wrote the byte at addr.
+    uint8_t owner(uint16_t addr) const { return cells[addr].owner; }
+    uint8_t& owner(uint16_t addr) { return cells[addr].owner; }
+#else
+    uint8_t operator[](uint16_t addr) const { return bytes[addr]; }
+    uint8_t& operator[](uint16_t addr) { return bytes[addr]; }
+
+    /// @return The pid of the player who last wrote the byte at addr.
+    uint8_t owner(uint16_t addr) const { return owners[addr]; }
+    uint8_t& owner(uint16_t addr) { return owners[addr]; }
+#endif
+
+    /**
+     * Copies a program into RAM, wrapping around the end.
+     * @param addr Where the program starts.
+     * @param src The program.
+     * @param size Number of bytes in the program.
+     * @param owner The pid which owns the program's bytes.
+     */
+    void load(uint16_t addr, const uint8_t* src, size_t size, uint8_t owner);
+
+    /**
+     * Copies bytes of RAM out in order, wrapping around the end.
+     * @param addr Address of the first byte.
+     * @param size Number of bytes to copy, no more than SIZE.
+     * @param dst Where to copy them to.
+     */
+    void copyBytes(uint16_t addr, size_t size, uint8_t* dst) const;
+
+    /// Same as copyBytes for the owners of the bytes.
+    void copyOwners(uint16_t addr, size_t size, uint8_t* dst) const;
+
+    /**
+     * Counts the bytes of RAM a player owns with SIMD where available.
+     * @param owner The pid to count.
+     */
+    uint32_t countOwned(uint8_t owner) const;
+
+    /**
+     * Counts how many bytes of an array have a value.
+     * @param pid The array, usually of owners.
+     * @param size Number of bytes in it.
+     * @param owner The value to count.
+     */
+    static uint32_t count(const uint8_t* pid, size_t size, uint8_t owner);
+
+    /// @return Number of pages this copy of RAM does not have to itself, 0 unless built with OBLIVIOS_PAGED_MEMORY.
+    uint32_t sharedPages() const;
+
+    bool operator==(const Memory& other) const;
+    bool operator!=(const Memory& other) const { return !(*this == other); }
+};
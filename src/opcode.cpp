@@ -1,32 +1,14 @@
 #include "opcode.h"
 
-#include <fstream>
+#include <algorithm>
+#include <iterator>
 
 
-std::map<OPCode, uint32_t> OPCode_NumCycles;
-
 OPCode OPCodeFromString(const std::string& s) {
-    const auto begin = OPCode_Strings.begin();
-    const auto end = OPCode_Strings.end();
+    const auto begin = std::begin(OPCode_Strings);
+    const auto end = std::end(OPCode_Strings);
 
-    const auto loc = find(begin, end, s);
+    const auto loc = std::find(begin, end, s);
     if(loc == end) throw std::invalid_argument(s + " is not a valid opcode.");
-    return OPCodeFromInt((uint8_t)(loc - begin));
-}
-
-void loadOPCodeCycles(const Json& config) {
-    const Json& cycles = config.at("op_cycles");
-    if(!cycles.is_object()) return;
-    for(auto&& itr = cycles.begin(); itr != cycles.end(); ++itr) {
-        const OPCode op = OPCodeFromString(itr.key());
-        OPCode_NumCycles[op] = *itr;
-    }
+    return (OPCode)(loc - begin);
 }
-
-uint32_t getOPCodeCycles(OPCode op) {
-    try {
-        return OPCode_NumCycles.at(op);
-    } catch(std::out_of_range& e) {
-        return 1;
-    }
-}
\ No newline at end of file
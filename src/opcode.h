@@ -1,6 +1,7 @@
 #pragma once
-#include <json.hpp>
-using Json = nlohmann::json;
+#include <cstddef>
+#include <cstdint>
+#include <string>
 
 
 enum class OPCode : uint8_t {
@@ -9,18 +10,45 @@ enum class OPCode : uint8_t {
 #undef X
 };
 
-const std::vector<std::string> OPCode_Strings {
+constexpr const char* OPCode_Strings[] {
 #define X(val, b) #val
 #include "opcodes"
 #undef X
 };
 
-const std::vector<uint8_t> OPCode_NumParams {
+constexpr uint8_t OPCode_NumParams[] {
 #define X(b, val) val
 #include "opcodes"
 #undef X
 };
 
+/// Number of opcodes including NONE and DAT
+constexpr size_t NUM_OPCODES = sizeof(OPCode_NumParams) / sizeof(OPCode_NumParams[0]);
+
+/// Number of values an opcode can be encoded as, they are stored in 6 bits
+constexpr size_t NUM_OPCODE_VALUES = 64;
+
+/// Flat lookup from an encoded value to the opcode it represents
+struct OPCodeTable { OPCode op[NUM_OPCODE_VALUES]; };
+
+/**
+ * Builds the table of what opcode each value represents, values which are not valid are NOP.
+ */
+constexpr OPCodeTable makeOPCodeTable() {
+    OPCodeTable table{};
+    for(size_t x = 0; x < NUM_OPCODE_VALUES; ++x)
+        table.op[x] = x < (size_t)OPCode::NONE ? (OPCode)x : OPCode::NOP;
+    return table;
+}
+
+constexpr OPCodeTable OPCode_By_Int = makeOPCodeTable();
+
+static_assert(NUM_OPCODES == sizeof(OPCode_Strings) / sizeof(OPCode_Strings[0]),
+              "Every opcode needs a string");
+static_assert((size_t)OPCode::NONE <= NUM_OPCODE_VALUES, "Valid opcodes must fit in 6 bits");
+static_assert(OPCode_By_Int.op[0] == OPCode::NOP && OPCode_By_Int.op[NUM_OPCODE_VALUES - 1] == OPCode::NOP,
+              "Invalid opcodes must decode to NOP");
+
 inline std::string OPCodeToString(OPCode op) {
     return OPCode_Strings[(uint8_t)op];
 }
@@ -38,7 +66,7 @@ inline std::ostream& operator<<(std::ostream& out, OPCode op) {
  * @return The opcode, or NOP if not valid
  */
 inline OPCode OPCodeFromInt(uint8_t op) {
-    if(op < (uint8_t)OPCode::NONE) return (OPCode)op;
+    if(op < NUM_OPCODE_VALUES) return OPCode_By_Int.op[op];
     else return OPCode::NOP;
 }
 
@@ -59,18 +87,3 @@ inline uint8_t OPCodeToInt(OPCode op) {
  */
 inline uint8_t getOPCodeParams(OPCode op) { return OPCode_NumParams[(uint8_t)op]; }
 
-
-/**
- * Load
- * @param config
- */
-void loadOPCodeCycles(const Json& config);
-
-/**
- * Gets the number of cycles required by an opcode to execute.
- * @param op The opcode in question
- * @return The number of cycles needed
- *
- * @warning This requires a previous call to have been made to loadOPCodeCycles
- */
-uint32_t getOPCodeCycles(OPCode op);
\ No newline at end of file
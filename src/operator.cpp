@@ -1,16 +1,17 @@
 #include "operator.h"
 
 #include "argument.h"
+#include "opcode.h"
 #include "thread.h"
 
 
 //Used for AND, OR, and XOR because they are all the same save for a single operator
 #define DUAL_LOGIC_OPERATION(op)                                        \
-    const bool ebit = Argument::is8BitOp(arg1, arg2);                   \
-    const uint16_t v = arg1.read(ebit) op arg2.read(ebit);              \
-    thread.o = thread.c = 0;                                            \
-    thread.z = v == 0;                                                  \
-    thread.s = ((ebit ? 0x80 : 0x8000) & v) != 0;                       \
+    const bool ebit = is8BitOp(arg1, arg2);                             \
+    const uint16_t arg1v = arg1.read(ebit);                             \
+    const uint16_t arg2v = arg2.read(ebit);                             \
+    const uint16_t v = arg1v op arg2v;                                  \
+    thread.setFlags<Lazy>(FlagOp::LOGIC, arg1v, arg2v, v, ebit);        \
     arg1.write(v, ebit);
 
 
@@ -27,326 +28,545 @@
 #define NEGATE(var) ((uint16_t)((~var + 1) & BMASK))
 
 
-void Operator::add(Thread& thread, Argument& arg1, const Argument& arg2) {
-    const bool ebit = Argument::is8BitOp(arg1, arg2);
+//Operators written once for both Argument, which checks its type at runtime, and TypedArgument,
+// whose type is fixed at compile time. Operators which set every flag can leave them to be computed
+// later if Lazy, the rest resolve any flags left pending first since they only set some of them.
+namespace Generic {
+    /// @see Argument::is8BitOp
+    template<class A1, class A2>
+    inline bool is8BitOp(const A1& arg1, const A2& arg2) {
+        //Will be 16 bit if either
+        // 1. Arg1 is 16bit
+        // 2. Arg1 is RAM and Arg2 is 16bit
+        const bool _16b = (!arg1.is8Bit()) || (arg1.isMem() && !arg2.is8Bit());
 
-    const uint16_t arg1v = arg1.read(ebit);
-    const uint16_t arg2v = arg2.read(ebit);
+        return !_16b;
+    }
 
-    const bool arg1s = IS_SIGNED(arg1v);
-    const bool arg2s = IS_SIGNED(arg2v);
 
-    const uint16_t sum = arg1.write(arg1v + arg2v, ebit);
-    const bool sum_sign = IS_SIGNED(sum);
+    template<bool Lazy, class A1, class A2>
+    void add(Thread& thread, A1& arg1, const A2& arg2) {
+        const bool ebit = is8BitOp(arg1, arg2);
 
-    thread.c = (sum < arg1v || sum < arg2v);
-    thread.s = sum_sign;
-    thread.z = !sum;
+        const uint16_t arg1v = arg1.read(ebit);
+        const uint16_t arg2v = arg2.read(ebit);
 
-    //overflow if both args have same sign and the result has a sign which is the opposite
-    thread.o = (arg1s == arg2s && sum_sign != arg1s);
-}
+        const uint16_t sum = arg1.write(arg1v + arg2v, ebit);
+        thread.setFlags<Lazy>(FlagOp::ADD, arg1v, arg2v, sum, ebit);
+    }
 
 
-void Operator::_and(Thread& thread, Argument& arg1, const Argument& arg2) {
-    DUAL_LOGIC_OPERATION(&)
-}
+    template<bool Lazy, class A1, class A2>
+    void _and(Thread& thread, A1& arg1, const A2& arg2) {
+        DUAL_LOGIC_OPERATION(&)
+    }
 
 
-void Operator::cmp(Thread& thread, const Argument& arg1, const Argument& arg2) {
-    const bool ebit = Argument::is8BitOp(arg1, arg2);
+    template<bool Lazy, class A1, class A2>
+    void cmp(Thread& thread, const A1& arg1, const A2& arg2) {
+        const bool ebit = is8BitOp(arg1, arg2);
 
-    const uint16_t arg1v = arg1.read(ebit);
-    const uint16_t arg2v = arg2.read(ebit);
+        const uint16_t arg1v = arg1.read(ebit);
+        const uint16_t arg2v = arg2.read(ebit);
 
-    const bool arg1s = IS_SIGNED(arg1v);
-    const bool arg2s = !IS_SIGNED(arg2v); //because of the implicit subtraction
+        const uint16_t sum = (arg1v + NEGATE(arg2v)) & BMASK;
+        thread.setFlags<Lazy>(FlagOp::SUB, arg1v, arg2v, sum, ebit);
+    }
 
-    const uint16_t sum = (arg1v + NEGATE(arg2v)) & BMASK;
-    const bool sum_sign = IS_SIGNED(sum);
 
-    thread.c = arg1v < arg2v;
-    thread.s = sum_sign;
-    thread.z = !sum;
+    template<class A>
+    void dec(Thread& thread, A& arg) {
+        thread.resolveFlags();
+        if(arg.is8Bit()) {
+            uint8_t v = (uint8_t)(arg.read(true));
+            thread.o = v == 0 || v == 0x80;
+            v--;
+            thread.s = (v & 0x80) != 0;
+            thread.z = v == 0;
+            arg.write(v, true);
+        } else {
+            uint16_t v = arg.read();
+            thread.o = v == 0 || v == 0x8000;
+            v--;
+            thread.s = (v & 0x8000) != 0;
+            thread.z = v == 0;
+            arg.write(v);
+        }
+    }
 
-    //overflow if both args have same sign and the result has a sign which is the opposite
-    thread.o = (arg1s == arg2s && sum_sign != arg1s);
-}
 
+    template<class A>
+    Fault div(Thread& thread, const A& arg) {
+        thread.resolveFlags();
+        if(arg.is8Bit()) {
+            const uint16_t n = thread.ax;
+            const uint16_t d = arg.read(true);
+            if(d == 0) return Fault::DIVIDE_BY_ZERO;
 
-void Operator::dec(Thread& thread, Argument& arg) {
-    const bool ebit = arg.is8Bit();
-    if(arg.is8Bit()) {
-        uint8_t v = (uint8_t)(arg.read(true));
-        thread.o = v == 0 || v == 0x80;
-        v--;
-        thread.s = (v & 0x80) != 0;
-        thread.z = v == 0;
-        arg.write(v, true);
-    } else {
-        uint16_t v = arg.read();
-        thread.o = v == 0 || v == 0x8000;
-        v--;
-        thread.s = (v & 0x8000) != 0;
-        thread.z = v == 0;
-        arg.write(v);
+            thread.ax = 0x0000;
+            const uint16_t q = n / d;
+            const uint16_t r = n % d;
+            thread.o = q > 0xFF;
+            thread.ax = (r << 8) | (uint8_t)q;
+        }
+        else { //16bit
+            const uint32_t n = (thread.bx << 16) | thread.ax;
+            const uint32_t d = arg.read();
+            if(d == 0) return Fault::DIVIDE_BY_ZERO;
+
+            const uint32_t q = n / d;
+            const uint32_t r = n % d;
+            thread.o = q > 0xFFFF;
+            thread.ax = (uint16_t)q;
+            thread.bx = (uint16_t)r;
+        }
+        return Fault::NONE;
     }
-}
 
 
-void Operator::div(Thread& thread, const Argument& arg) {
-    if(arg.is8Bit()) {
-        const uint16_t n = thread.ax;
-        const uint16_t d = arg.read(true);
-        if(d == 0) throw std::runtime_error("Divide by zero error.");
+    template<class A>
+    Fault idiv(Thread& thread, const A& arg) {
+        thread.resolveFlags();
+        if(arg.is8Bit()) {
+            const int16_t n = thread.ax;
+            const int16_t d = (int8_t)arg.read(true);
+            if(d == 0) return Fault::DIVIDE_BY_ZERO;
 
-        thread.ax = 0x0000;
-        const uint16_t q = n / d;
-        const uint16_t r = n % d;
-        thread.o = q > 0xFF;
-        thread.ax = (r << 8) | (uint8_t)q;
+            thread.ax = 0x0000;
+            const int16_t q = n / d;
+            const int16_t r = n % d;
+            thread.o = (q > 0x7F || q < -0x80);
+            thread.ax = (uint16_t)(r << 8) | (uint8_t)q;
+        }
+        else { //16bit
+            const int32_t n = (thread.bx << 16) | thread.ax;
+            const int32_t d = (int16_t)arg.read();
+            if(d == 0) return Fault::DIVIDE_BY_ZERO;
+
+            const int32_t q = n / d;
+            const int32_t r = n % d;
+            thread.o = (q > 0x7FFF || q < -0x8000);
+            thread.ax = (uint16_t)q;
+            thread.bx = (uint16_t)r;
+        }
+        return Fault::NONE;
     }
-    else { //16bit
-        const uint32_t n = (thread.bx << 16) | thread.ax;
-        const uint32_t d = arg.read();
-        if(d == 0) throw std::runtime_error("Divide by zero error.");
-
-        const uint32_t q = n / d;
-        const uint32_t r = n % d;
-        thread.o = q > 0xFFFF;
-        thread.ax = (uint16_t)q;
-        thread.bx = (uint16_t)r;
+
+
+    template<class A>
+    void imul(Thread& thread, const A& arg) {
+        thread.resolveFlags();
+        if(arg.is8Bit()) {
+            int16_t v = (int8_t)arg.read(true);
+            v *= (int8_t)Thread::readLow(thread.ax);
+            if(v < 0x7F && v > -0x80 ) { //Fits
+                thread.o = false;
+                thread.c = false;
+                thread.ax &= 0xFF00;
+                thread.ax |= (uint8_t)v;
+            }
+            else { //Overflow
+                thread.o = true;
+                thread.c = true;
+                thread.ax = (uint16_t)v;
+            }
+        }
+        else { //16bit
+            int32_t v = (int16_t)arg.read();
+            v *= (int16_t)thread.ax;
+            if(v < 0x7FFF && v > -0x8000 ) { //Fits
+                thread.o = false;
+                thread.c = false;
+                thread.ax = (uint16_t)v;
+            }
+            else { //Overflow
+                thread.o = true;
+                thread.c = true;
+                thread.ax = (uint16_t)v;
+                thread.bx = (uint16_t)(v >> 16);
+            }
+        }
     }
-}
 
 
-void Operator::idiv(Thread& thread, const Argument& arg) {
-    if(arg.is8Bit()) {
-        const int16_t n = thread.ax;
-        const int16_t d = (int8_t)arg.read(true);
-        if(d == 0) throw std::runtime_error("Divide by zero error.");
+    template<class A>
+    void inc(Thread& thread, A& arg) {
+        thread.resolveFlags();
+        if(arg.is8Bit()) {
+            uint8_t v = (uint8_t)(arg.read(true));
+            v++;
+            thread.s = (v & 0x80) != 0;
+            thread.o = v == 0 || v == 0x80;
+            thread.z = v == 0;
+            arg.write(v, true);
+        } else {
+            uint16_t v = arg.read();
+            v++;
+            thread.s = (v & 0x8000) != 0;
+            thread.o = v == 0 || v == 0x8000;
+            thread.z = v == 0;
+            arg.write(v);
+        }
+    }
+
 
-        thread.ax = 0x0000;
-        const int16_t q = n / d;
-        const int16_t r = n % d;
-        thread.o = (q > 0x7F || q < -0x80);
-        thread.ax = (uint16_t)(r << 8) | (uint8_t)q;
+    template<class A1, class A2>
+    void int_(Thread& thread, A1& arg1, A2& arg2) {
+        thread.resolveFlags();
+        //TODO: handle interrupts
     }
-    else { //16bit
-        const int32_t n = (thread.bx << 16) | thread.ax;
-        const int32_t d = (int16_t)arg.read();
-        if(d == 0) throw std::runtime_error("Divide by zero error.");
-
-        const int32_t q = n / d;
-        const int32_t r = n % d;
-        thread.o = (q > 0x7FFF || q < -0x8000);
-        thread.ax = (uint16_t)q;
-        thread.bx = (uint16_t)r;
+
+
+    template<class A1, class A2>
+    void mov(A1& arg1, const A2& arg2) {
+        arg1.write(arg2);
     }
-}
 
 
-void Operator::imul(Thread& thread, const Argument& arg) {
-    if(arg.is8Bit()) {
-        int16_t v = (int8_t)arg.read(true);
-        v *= (int8_t)Thread::readLow(thread.ax);
-        if(v < 0x7F && v > -0x80 ) { //Fits
-            thread.o = false;
-            thread.c = false;
-            thread.ax &= 0xFF00;
-            thread.ax |= (uint8_t)v;
+    template<class A>
+    void mul(Thread& thread, const A& arg) {
+        thread.resolveFlags();
+        if(arg.is8Bit()) {
+            uint16_t v = arg.read(true);
+            v *= Thread::readLow(thread.ax);
+            if(v & 0xFF00) { //Overflow
+                thread.o = true;
+                thread.c = true;
+                thread.ax = v;
+            }
+            else { //Fits
+                thread.o = false;
+                thread.c = false;
+                thread.ax &= 0xFF00;
+                thread.ax |= v;
+            }
         }
-        else { //Overflow
-            thread.o = true;
-            thread.c = true;
-            thread.ax = (uint16_t)v;
+        else { //16bit
+            uint32_t v = arg.read();
+            v *= thread.ax;
+            if(v & 0xFFFF0000) { //Overflow
+                thread.o = true;
+                thread.c = true;
+                thread.ax = (uint16_t)v;
+                thread.bx = (uint16_t)(v >> 16);
+            }
+            else { //Fits
+                thread.o = false;
+                thread.c = false;
+                thread.ax = (uint16_t)v;
+            }
         }
     }
-    else { //16bit
-        int32_t v = (int16_t)arg.read();
-        v *= (int16_t)thread.ax;
-        if(v < 0x7FFF && v > -0x8000 ) { //Fits
-            thread.o = false;
-            thread.c = false;
-            thread.ax = (uint16_t)v;
-        }
-        else { //Overflow
-            thread.o = true;
-            thread.c = true;
-            thread.ax = (uint16_t)v;
-            thread.bx = (uint16_t)(v >> 16);
-        }
+
+
+    template<class A>
+    void neg(Thread& thread, A& arg) {
+        thread.resolveFlags();
+        const bool ebit = arg.is8Bit();
+        const uint16_t v = arg.read(ebit); //8bit if in ram
+        const uint16_t n = NEGATE(v);
+        thread.z = !v;
+        thread.c = v != 0;
+        thread.o = v == SMASK;
+
+        arg.write(n, ebit);
+
+        thread.s = IS_SIGNED(n);
     }
-}
 
 
-void Operator::inc(Thread& thread, Argument& arg) {
-    const bool ebit = arg.is8Bit();
-    if(arg.is8Bit()) {
-        uint8_t v = (uint8_t)(arg.read(true));
-        v++;
-        thread.s = (v & 0x80) != 0;
-        thread.o = v == 0 || v == 0x80;
-        thread.z = v == 0;
-        arg.write(v, true);
-    } else {
-        uint16_t v = arg.read();
-        v++;
-        thread.s = (v & 0x8000) != 0;
-        thread.o = v == 0 || v == 0x8000;
-        thread.z = v == 0;
-        arg.write(v);
+    template<class A>
+    void _not(A& arg) {
+        const uint16_t v = arg.read(arg.is8Bit());
+        arg.write(~v, true); //always force ram to be 8bit
+    }
+
+
+    template<bool Lazy, class A1, class A2>
+    void _or(Thread& thread, A1& arg1, const A2& arg2) {
+        DUAL_LOGIC_OPERATION(|)
+    }
+
+
+    template<class A1, class A2>
+    void shl(Thread& thread, A1& arg1, const A2& arg2) {
+        thread.resolveFlags();
+        const bool ebit = is8BitOp(arg1, arg2);
+        uint16_t v = arg1.read(ebit);
+        const uint16_t n = arg2.read();
+
+        //set carry to last bit which is cut off
+        thread.c = ((v << std::max((int)n - 1, 0)) & SMASK) != 0;
+
+        v <<= n;
+        arg1.write(v, ebit);
+
+        thread.s = (v & (ebit ? 0x80: 0x8000)) != 0;
+        if(n == 1)
+            //set overflow to true if the sign changed because of the shift
+            thread.o =  thread.s != thread.c;
+
+        thread.z = !v;
+    }
+
+
+    template<class A1, class A2>
+    void shr(Thread& thread, A1& arg1, const A2& arg2) {
+        thread.resolveFlags();
+        const bool ebit = is8BitOp(arg1, arg2);
+        uint16_t v = arg1.read(ebit);
+        const uint16_t n = arg2.read();
+
+        //set overflow flag to most significant bit of original
+        thread.o = (v & SMASK) != 0;
+        //set carry to last bit which is cut off
+        thread.c = ((v >> std::max((int)n - 1, 0)) & (0x0001)) != 0;
+
+        v >>= n;
+        arg1.write(v, ebit);
+
+        thread.z = !v;
+        thread.s = (v & SMASK) != 0;
+    }
+
+
+    template<bool Lazy, class A1, class A2>
+    void sub(Thread& thread, A1& arg1, const A2& arg2) {
+        const bool ebit = is8BitOp(arg1, arg2);
+
+        const uint16_t arg1v = arg1.read(ebit);
+        const uint16_t arg2v = arg2.read(ebit);
+
+        const uint16_t sum = arg1.write(arg1v + NEGATE(arg2v), ebit);
+        thread.setFlags<Lazy>(FlagOp::SUB, arg1v, arg2v, sum, ebit);
+    }
+
+
+    template<class A1, class A2>
+    void swp(A1& arg1, A2& arg2) {
+        arg1.swp(arg2);
+    }
+
+
+    template<bool Lazy, class A1, class A2>
+    void test(Thread& thread, const A1& arg1, const A2& arg2) {
+        const bool ebit = is8BitOp(arg1, arg2);
+
+        const uint16_t arg1v = arg1.read(ebit);
+        const uint16_t arg2v = arg2.read(ebit);
+
+        const uint16_t result = arg1v & arg2v & BMASK;
+        thread.setFlags<Lazy>(FlagOp::LOGIC, arg1v, arg2v, result, ebit);
+    }
+
+
+    template<bool Lazy, class A1, class A2>
+    void _xor(Thread& thread, A1& arg1, const A2& arg2) {
+        DUAL_LOGIC_OPERATION(^)
     }
 }
 
 
-void Operator::int_(Thread& thread, Argument& arg1, Argument& arg2) {
-    //TODO: handle interrupts
+void Operator::add(Thread& thread, Argument& arg1, const Argument& arg2) {
+    Generic::add<false>(thread, arg1, arg2);
 }
 
 
-void Operator::mov(Argument& arg1, const Argument& arg2) {
-    arg1.write(arg2);
+void Operator::_and(Thread& thread, Argument& arg1, const Argument& arg2) {
+    Generic::_and<false>(thread, arg1, arg2);
 }
 
 
-void Operator::mul(Thread& thread, const Argument& arg) {
-    if(arg.is8Bit()) {
-        uint16_t v = arg.read(true);
-        v *= Thread::readLow(thread.ax);
-        if(v & 0xFF00) { //Overflow
-            thread.o = true;
-            thread.c = true;
-            thread.ax = v;
-        }
-        else { //Fits
-            thread.o = false;
-            thread.c = false;
-            thread.ax &= 0xFF00;
-            thread.ax |= v;
-        }
-    }
-    else { //16bit
-        uint32_t v = arg.read();
-        v *= thread.ax;
-        if(v & 0xFFFF0000) { //Overflow
-            thread.o = true;
-            thread.c = true;
-            thread.ax = (uint16_t)v;
-            thread.bx = (uint16_t)(v >> 16);
-        }
-        else { //Fits
-            thread.o = false;
-            thread.c = false;
-            thread.ax = (uint16_t)v;
-        }
-    }
+void Operator::cmp(Thread& thread, const Argument& arg1, const Argument& arg2) {
+    Generic::cmp<false>(thread, arg1, arg2);
 }
 
 
-void Operator::neg(Thread& thread, Argument& arg) {
-    const bool ebit = arg.is8Bit();
-    const uint16_t v = arg.read(ebit); //8bit if in ram
-    const uint16_t n = NEGATE(v);
-    thread.z = !v;
-    thread.c = v != 0;
-    thread.o = v == SMASK;
+void Operator::dec(Thread& thread, Argument& arg) {
+    Generic::dec(thread, arg);
+}
 
-    arg.write(n, ebit);
 
-    thread.s = IS_SIGNED(n);
+Fault Operator::div(Thread& thread, const Argument& arg) {
+    return Generic::div(thread, arg);
 }
 
 
-void Operator::_not(Argument& arg) {
-    const uint16_t v = arg.read(arg.is8Bit());
-    arg.write(~v, true); //always force ram to be 8bit
+Fault Operator::idiv(Thread& thread, const Argument& arg) {
+    return Generic::idiv(thread, arg);
 }
 
 
-void Operator::_or(Thread& thread, Argument& arg1, const Argument& arg2) {
-    DUAL_LOGIC_OPERATION(|)
+void Operator::imul(Thread& thread, const Argument& arg) {
+    Generic::imul(thread, arg);
 }
 
 
-void Operator::shl(Thread& thread, Argument& arg1, const Argument& arg2) {
-    const bool ebit = Argument::is8BitOp(arg1, arg2);
-    uint16_t v = arg1.read(ebit);
-    const uint16_t n = arg2.read();
+void Operator::inc(Thread& thread, Argument& arg) {
+    Generic::inc(thread, arg);
+}
 
-    //set carry to last bit which is cut off
-    thread.c = ((v << std::max((int)n - 1, 0)) & SMASK) != 0;
 
-    v <<= n;
-    arg1.write(v, ebit);
+void Operator::int_(Thread& thread, Argument& arg1, Argument& arg2) {
+    Generic::int_(thread, arg1, arg2);
+}
 
-    thread.s = (v & (ebit ? 0x80: 0x8000)) != 0;
-    if(n == 1)
-        //set overflow to true if the sign changed because of the shift
-        thread.o =  thread.s != thread.c;
 
-    thread.z = !v;
+void Operator::mov(Argument& arg1, const Argument& arg2) {
+    Generic::mov(arg1, arg2);
 }
 
 
-void Operator::shr(Thread& thread, Argument& arg1, const Argument& arg2) {
-    const bool ebit = Argument::is8BitOp(arg1, arg2);
-    uint16_t v = arg1.read(ebit);
-    const uint16_t n = arg2.read();
+void Operator::mul(Thread& thread, const Argument& arg) {
+    Generic::mul(thread, arg);
+}
 
-    //set overflow flag to most significant bit of original
-    thread.o = (v & SMASK) != 0;
-    //set carry to last bit which is cut off
-    thread.c = ((v >> std::max((int)n - 1, 0)) & (0x0001)) != 0;
 
-    v >>= n;
-    arg1.write(v, ebit);
+void Operator::neg(Thread& thread, Argument& arg) {
+    Generic::neg(thread, arg);
+}
+
 
-    thread.z = !v;
-    thread.s = (v & SMASK) != 0;
+void Operator::_not(Argument& arg) {
+    Generic::_not(arg);
 }
 
 
-void Operator::sub(Thread& thread, Argument& arg1, const Argument& arg2) {
-    const bool ebit = Argument::is8BitOp(arg1, arg2);
+void Operator::_or(Thread& thread, Argument& arg1, const Argument& arg2) {
+    Generic::_or<false>(thread, arg1, arg2);
+}
+
 
-    const uint16_t arg1v = arg1.read(ebit);
-    const uint16_t arg2v = arg2.read(ebit);
+void Operator::shl(Thread& thread, Argument& arg1, const Argument& arg2) {
+    Generic::shl(thread, arg1, arg2);
+}
 
-    const bool arg1s = IS_SIGNED(arg1v);
-    const bool arg2s = !IS_SIGNED(arg2v); //because of the implicit subtraction
 
-    const uint16_t sum = arg1.write(arg1v + NEGATE(arg2v), ebit);
-    const bool sum_sign = IS_SIGNED(sum);
+void Operator::shr(Thread& thread, Argument& arg1, const Argument& arg2) {
+    Generic::shr(thread, arg1, arg2);
+}
 
-    thread.c = arg1v < arg2v;
-    thread.s = sum_sign;
-    thread.z = !sum;
 
-    //overflow if both args have same sign and the result has a sign which is the opposite
-    thread.o = (arg1s == arg2s && sum_sign != arg1s);
+void Operator::sub(Thread& thread, Argument& arg1, const Argument& arg2) {
+    Generic::sub<false>(thread, arg1, arg2);
 }
 
 
 void Operator::swp(Argument& arg1, Argument& arg2) {
-    arg1.swp(arg2);
+    Generic::swp(arg1, arg2);
 }
 
 
 void Operator::test(Thread& thread, const Argument& arg1, const Argument& arg2) {
-    const bool ebit = Argument::is8BitOp(arg1, arg2);
+    Generic::test<false>(thread, arg1, arg2);
+}
 
-    const uint16_t arg1v = arg1.read(ebit);
-    const uint16_t arg2v = arg2.read(ebit);
 
-    const uint16_t result = arg1v & arg2v & BMASK;
+void Operator::_xor(Thread& thread, Argument& arg1, const Argument& arg2) {
+    Generic::_xor<false>(thread, arg1, arg2);
+}
 
-    thread.o = thread.c = 0;
-    thread.s = IS_SIGNED(result);
-    thread.z = !result;
+
+
+//Maps each opcode to its operator, NOP and the jumps do nothing. Lazy is passed on to the operators
+// which can leave their flags to be computed later.
+template<OPCode OP>
+struct OperatorFor {
+    template<bool Lazy, class A1, class A2> static Fault run(Thread& thread, A1& arg1, A2& arg2) {
+        return Fault::NONE;
+    }
+};
+
+#define OPERATOR_FOR(op, call)                                                  \
+    template<> struct OperatorFor<OPCode::op> {                                 \
+        template<bool Lazy, class A1, class A2>                                 \
+        static Fault run(Thread& thread, A1& arg1, A2& arg2) {                  \
+            call;                                                               \
+            return Fault::NONE;                                                 \
+        }                                                                       \
+    };
+
+//For operators which can fault, call is what is returned
+#define FAULTING_OPERATOR_FOR(op, call)                                         \
+    template<> struct OperatorFor<OPCode::op> {                                 \
+        template<bool Lazy, class A1, class A2>                                 \
+        static Fault run(Thread& thread, A1& arg1, A2& arg2) { return call; }   \
+    };
+
+OPERATOR_FOR(INT,  Generic::int_(thread, arg1, arg2))
+OPERATOR_FOR(MOV,  Generic::mov(arg1, arg2))
+OPERATOR_FOR(SWP,  Generic::swp(arg1, arg2))
+OPERATOR_FOR(ADD,  Generic::add<Lazy>(thread, arg1, arg2))
+OPERATOR_FOR(SUB,  Generic::sub<Lazy>(thread, arg1, arg2))
+OPERATOR_FOR(MUL,  Generic::mul(thread, arg1))
+OPERATOR_FOR(IMUL, Generic::imul(thread, arg1))
+FAULTING_OPERATOR_FOR(DIV,  Generic::div(thread, arg1))
+FAULTING_OPERATOR_FOR(IDIV, Generic::idiv(thread, arg1))
+OPERATOR_FOR(SHL,  Generic::shl(thread, arg1, arg2))
+OPERATOR_FOR(SHR,  Generic::shr(thread, arg1, arg2))
+OPERATOR_FOR(NEG,  Generic::neg(thread, arg1))
+OPERATOR_FOR(NOT,  Generic::_not(arg1))
+OPERATOR_FOR(AND,  Generic::_and<Lazy>(thread, arg1, arg2))
+OPERATOR_FOR(OR,   Generic::_or<Lazy>(thread, arg1, arg2))
+OPERATOR_FOR(XOR,  Generic::_xor<Lazy>(thread, arg1, arg2))
+OPERATOR_FOR(INC,  Generic::inc(thread, arg1))
+OPERATOR_FOR(DEC,  Generic::dec(thread, arg1))
+OPERATOR_FOR(CMP,  Generic::cmp<Lazy>(thread, arg1, arg2))
+OPERATOR_FOR(TEST, Generic::test<Lazy>(thread, arg1, arg2))
+//These should not happen, ever; a non-valid opcode is currently returned as a NOP
+FAULTING_OPERATOR_FOR(DAT,  Fault::INVALID_OPCODE)
+FAULTING_OPERATOR_FOR(NONE, Fault::INVALID_OPCODE)
+
+
+template<OPCode OP, ArgType T1, ArgType T2, bool Lazy>
+Fault handler(Thread& thread, Argument& arg1, Argument& arg2) {
+    TypedArgument<T1> typed1(arg1);
+    TypedArgument<T2> typed2(arg2);
+    return OperatorFor<OP>::template run<Lazy>(thread, typed1, typed2);
 }
 
+static_assert((uint8_t)ArgType::M == 0 && (uint8_t)ArgType::M16 == 1 && (uint8_t)ArgType::R8L == 2 &&
+              (uint8_t)ArgType::R8H == 3 && (uint8_t)ArgType::R16 == 4,
+              "Handler table is indexed by ArgType");
+
+#define HANDLERS_BY_ARG2(op, t1, lazy)                                          \
+    { &handler<op, t1, ArgType::M, lazy>, &handler<op, t1, ArgType::M16, lazy>, \
+      &handler<op, t1, ArgType::R8L, lazy>, &handler<op, t1, ArgType::R8H, lazy>, \
+      &handler<op, t1, ArgType::R16, lazy> }
+
+#define HANDLERS(op, lazy)                                                      \
+    { HANDLERS_BY_ARG2(op, ArgType::M, lazy), HANDLERS_BY_ARG2(op, ArgType::M16, lazy), \
+      HANDLERS_BY_ARG2(op, ArgType::R8L, lazy), HANDLERS_BY_ARG2(op, ArgType::R8H, lazy), \
+      HANDLERS_BY_ARG2(op, ArgType::R16, lazy) }
+
+/// Every operator for every combination of argument types, indexed by opcode, arg1, and then arg2
+static const Operator::Handler Handlers[][5][5] = {
+#define X(name, params) HANDLERS(OPCode::name, false)
+#include "opcodes"
+#undef X
+};
+
+/// Same as Handlers but leaving flags to be computed when they are needed
+static const Operator::Handler LazyHandlers[][5][5] = {
+#define X(name, params) HANDLERS(OPCode::name, true)
+#include "opcodes"
+#undef X
+};
+
+Operator::Handler Operator::getHandler(OPCode op, ArgType arg1, ArgType arg2, bool lazy_flags) {
+    if(arg1 == ArgType::NONE || arg2 == ArgType::NONE) return nullptr;
+    return (lazy_flags ? LazyHandlers : Handlers)[(uint8_t)op][(uint8_t)arg1][(uint8_t)arg2];
+}
 
-void Operator::_xor(Thread& thread, Argument& arg1, const Argument& arg2) {
-    DUAL_LOGIC_OPERATION(^)
-}
\ No newline at end of file
+bool Operator::writesArg(OPCode op, uint8_t argn) {
+    switch(op) {
+        case OPCode::SWP:
+            return true;
+        case OPCode::MOV: case OPCode::ADD: case OPCode::SUB: case OPCode::SHL: case OPCode::SHR:
+        case OPCode::NEG: case OPCode::NOT: case OPCode::AND: case OPCode::OR: case OPCode::XOR:
+        case OPCode::INC: case OPCode::DEC:
+            return argn == 1;
+        default:
+            return false;
+    }
+}
@@ -3,9 +3,14 @@
 class Thread;
 class Argument;
 
+#include "fault.h"
+
 #include <json.hpp>
 using Json = nlohmann::json;
 
+enum class ArgType : uint8_t;
+enum class OPCode : uint8_t;
+
 
 /**
  * Set of functions useful for working with arguments to apply operations.
@@ -13,6 +18,35 @@ using Json = nlohmann::json;
  * @see Argument for more information.
  */
 namespace Operator {
+    /**
+     * An operator specialized for the types of its arguments, so it does not need to check what kind
+     * of storage they are while running.
+     * @param thread Current thread with registers and flag values.
+     * @param arg1 First argument, must be of the type the handler was made for.
+     * @param arg2 Second argument, must be of the type the handler was made for.
+     * @return The fault the thread died of, Fault::NONE if it succeeded.
+     */
+    typedef Fault (*Handler)(Thread& thread, Argument& arg1, Argument& arg2);
+
+    /**
+     * Gets the handler which performs an opcode on arguments of the given types.
+     * @param op The opcode to perform.
+     * @param arg1 Type of the first argument.
+     * @param arg2 Type of the second argument.
+     * @param lazy_flags If true the handler only records what is needed to compute the flags, they
+     *  are computed by Thread::resolveFlags once something reads them.
+     * @return The handler, or nullptr if either type is NONE.
+     */
+    Handler getHandler(OPCode op, ArgType arg1, ArgType arg2, bool lazy_flags = false);
+
+    /**
+     * Checks whether an opcode writes to one of its arguments.
+     * @param op The opcode.
+     * @param argn The number of the argument, 1 is the destination and 2 the source.
+     * @return True if the argument is written to.
+     */
+    bool writesArg(OPCode op, uint8_t argn);
+
     /**
      * Perform an ADD operation.
      * @param thread Current thread with registers and flag values.
@@ -51,9 +85,9 @@ namespace Operator {
      * @note Bitage of arg determines if it is 8bit or 16bit.
      * @param thread Current thread with registers and flag values.
      * @param arg Argument used to divide by.
-     * @throw std::runtime_error If invalid, such as DIV 0
+     * @return Fault::DIVIDE_BY_ZERO if arg is 0, otherwise Fault::NONE.
      */
-    void div(Thread& thread, const Argument& arg);
+    Fault div(Thread& thread, const Argument& arg);
 
     /**
      * Signed division of AX or AL by the argument. If 8bit, it will divide
@@ -62,9 +96,9 @@ namespace Operator {
      * @note Bitage of arg determines if it is 8bit or 16bit.
      * @param thread Current thread with registers and flag values.
      * @param arg Argument used to divide by.
-     * @throw std::runtime_error If invalid, such as DIV 0
+     * @return Fault::DIVIDE_BY_ZERO if arg is 0, otherwise Fault::NONE.
      */
-    void idiv(Thread& thread, const Argument& arg);
+    Fault idiv(Thread& thread, const Argument& arg);
 
     /**
      * Signed multiplication of AX or AL by the argument. If 8bit, it will multiply
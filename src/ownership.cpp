@@ -0,0 +1,18 @@
+#include "ownership.h"
+
+
+void Ownership::setPlayers(Player* players, uint8_t num_players, bool count) {
+    this->players = players;
+    this->num_players = num_players;
+    if(count) recount();
+}
+
+bool Ownership::recount() {
+    bool correct = true;
+    for(uint8_t x = 0; x < num_players; ++x) {
+        const uint32_t owned = memory.countOwned((uint8_t)(x + 1));
+        correct &= players[x].owned_ram == owned;
+        players[x].owned_ram = owned;
+    }
+    return correct;
+}
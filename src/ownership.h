@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+
+#include "loop_detector.h"
+#include "memory.h"
+#include "player.h"
+
+
+/**
+ * Keeps track of which player last wrote each byte of RAM and how many bytes each player owns.
+ * Every write moves the bytes from their old owner to the writer, so Player::owned_ram is always up
+ * to date and territory can be scored at any cycle without looking at all of RAM.
+ */
+class Ownership {
+    /// The game's RAM, whose owners are kept here
+    Memory& memory;
+    Player* players;
+    uint8_t num_players;
+    /// The player whose thread is running
+    uint8_t writer;
+    /// Told about every write, null if loops are not looked for
+    LoopDetector* loops;
+
+public:
+    Ownership() = delete;
+    Ownership(const Ownership&) = delete;
+    Ownership& operator=(const Ownership&) = delete;
+
+    /// @param memory The game's RAM.
+    Ownership(Memory& memory) : memory(memory), players(nullptr), num_players(0), writer(0), loops(nullptr) {}
+
+    /**
+     * Sets the players whose owned_ram is kept up to date and recounts it.
+     * @param players Array of players, index i is the player with pid i + 1
+     * @param num_players Size of the array.
+     * @param count False if owned_ram is already right, as for copies of players who owned the same RAM.
+     */
+    void setPlayers(Player* players, uint8_t num_players, bool count = true);
+
+    /// @param pid The player whose thread is about to run and to whom bytes it writes will belong.
+    void setWriter(uint8_t pid) { writer = pid; }
+
+    /// @param detector Where every write is reported from now on, null for nowhere.
+    void setDetector(LoopDetector* detector) { loops = detector; }
+
+    /**
+     * Reports a byte which is about to be written, see LoopDetector. It must be called before RAM
+     * is written.
+     * @param addr Address of the byte.
+     * @param byte What will be written.
+     */
+    inline void overwrite(uint16_t addr, uint8_t byte) {
+        if(loops) loops->byte(addr, memory[addr], byte);
+    }
+
+    /**
+     * Gives bytes which were written to the writer.
+     * @param addr Address of the first byte which was written.
+     * @param len Number of bytes written.
+     */
+    inline void write(uint16_t addr, uint8_t len = 1);
+
+    /**
+     * Counts every player's bytes from scratch and corrects owned_ram.
+     * @return True if owned_ram was already correct for every player.
+     */
+    bool recount();
+};
+
+
+inline void Ownership::write(uint16_t addr, uint8_t len) {
+    for(uint8_t x = 0; x < len; ++x) {
+        uint8_t& owner = memory.owner((uint16_t)(addr + x));
+        if(owner == writer) continue;
+        if(loops) loops->owner((uint16_t)(addr + x), owner, writer);
+        if(owner) --players[owner - 1].owned_ram;
+        ++players[writer - 1].owned_ram;
+        owner = writer;
+    }
+}
@@ -1,23 +1,13 @@
 #include "player.h"
 
-#include "thread.h"
 
-
-Player::Player() : cycle_modifer(1), max_threads(32), owned_ram(0), killed_threads(0),
+Player::Player() : cycle_modifer(1), turn_cycles(0), max_threads(32), owned_ram(0), killed_threads(0),
                    killed_processes(0), score(0) {}
 
 Player::Player(const Json& j, uint8_t pid) : Player() {
     if(!j.is_object()) return;
-    try { cycle_modifer = j.at("cycle_modifer"); } catch(std::out_of_range& e) {}
-    try { max_threads   = j.at("max_threads");   } catch(std::out_of_range& e) {}
+    if(j.count("cycle_modifer")) cycle_modifer = j.at("cycle_modifer");
+    if(j.count("max_threads"))   max_threads   = j.at("max_threads");
 
-    try { name = j.at("name");}
-    catch(std::out_of_range& e) { name = "Process_" + std::to_string(pid); }
+    name = j.count("name") ? j.at("name").get<std::string>() : "Process_" + std::to_string(pid);
 }
-
-Player::~Player() {
-    while(!threads.empty()) {
-        delete threads.front();
-        threads.pop();
-    }
-}
\ No newline at end of file
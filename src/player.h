@@ -1,17 +1,18 @@
 #pragma once
-struct Thread;
-
 #include <json.hpp>
 using Json = nlohmann::json;
 
 #include <cstdint>
 #include <string>
-#include <queue>
+
+#include "run_list.h"
 
 
 struct Player {
     // pid is defined by its index in the game array + 1
     float cycle_modifer;
+    /// Cycles each of the player's threads gets per turn, set by the game from cycle_modifer
+    uint32_t turn_cycles;
     uint8_t max_threads;
     std::string name;
 
@@ -20,7 +21,8 @@ struct Player {
     uint32_t killed_processes;
     uint32_t score;
 
-    std::queue<Thread*> threads;
+    /// Threads in the order they take turns, their slots are owned by the game
+    RunList threads;
 
     Player();
 
@@ -29,5 +31,4 @@ struct Player {
      * configuration only.
      */
     Player(const Json& j, uint8_t pid);
-    ~Player();
 };
\ No newline at end of file
@@ -0,0 +1,92 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "thread.h"
+
+
+/**
+ * A player's threads in the order they take turns. The threads live in a fixed block owned by the
+ * game and are linked into a circle through Thread::next and Thread::prev, so moving on to the
+ * next thread, creating one, and killing one are all O(1) and never allocate. Slots which are not
+ * in use are kept in a free list through Thread::next.
+ */
+class RunList {
+    /// The thread whose turn is next, null if there are none
+    Thread* current;
+    /// Slots which are not in use
+    Thread* free;
+    size_t count;
+
+public:
+    RunList() : current(nullptr), free(nullptr), count(0) {}
+
+    /**
+     * Gives the list its slots, any threads it had are forgotten.
+     * @param slots Block of threads owned by the caller, which must outlive the list.
+     * @param capacity Number of threads in the block, the most which can be alive at once.
+     */
+    void init(Thread* slots, size_t capacity);
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+
+    /// @return The thread whose turn is next, the list must not be empty.
+    Thread& front() { return *current; }
+    const Thread& front() const { return *current; }
+
+    /// The front thread has had its turn, the next one is moved to the front.
+    void rotate() { current = current->next; }
+
+    /**
+     * Starts a new thread which takes its first turn after every thread already alive.
+     * @param ip Where the thread starts.
+     * @return The new thread, null if there is no room for it.
+     */
+    Thread* spawn(uint16_t ip);
+
+    /// Kills the front thread, the next one is moved to the front. The list must not be empty.
+    void kill();
+};
+
+
+inline void RunList::init(Thread* slots, size_t capacity) {
+    current = nullptr;
+    count = 0;
+    free = nullptr;
+    for(size_t x = capacity; x > 0; --x) {
+        slots[x - 1].next = free;
+        free = &slots[x - 1];
+    }
+}
+
+inline Thread* RunList::spawn(uint16_t ip) {
+    if(!free) return nullptr;
+    Thread* thread = free;
+    free = free->next;
+    *thread = Thread(ip);
+
+    //the back of the rotation is just before the front
+    if(current) {
+        thread->next = current;
+        thread->prev = current->prev;
+        current->prev->next = thread;
+        current->prev = thread;
+    }
+    else current = thread->next = thread->prev = thread;
+    ++count;
+    return thread;
+}
+
+inline void RunList::kill() {
+    Thread* thread = current;
+    if(--count) {
+        thread->prev->next = thread->next;
+        thread->next->prev = thread->prev;
+        current = thread->next;
+    }
+    else current = nullptr;
+
+    thread->next = free;
+    free = thread;
+}
@@ -0,0 +1,144 @@
+#include "scheduler.h"
+
+#include "game.h"
+#include "player.h"
+
+#include <algorithm>
+
+
+Scheduler::Scheduler(Game& game) : game(game), num_players(game.num_players),
+        next(num_players + 1), prev(num_players + 1), offsets(num_players + 2), stale(num_players + 1u),
+        synced(num_players + 1), current_round(0), skip_stalls(false) {}
+
+void Scheduler::start(bool skip) {
+    skip_stalls = skip;
+    current_round = 0;
+    for(std::vector<uint8_t>& slot : wheel) slot.clear();
+    later = decltype(later)();
+
+    uint8_t last = 0;
+    offsets[1] = 0;
+    stale = num_players + 1u;
+    for(uint32_t pid = 1; pid <= num_players; ++pid) {
+        const Player& player = game.players[pid - 1];
+        synced[pid] = 0;
+        offsets[pid + 1] = offsets[pid];
+        if(player.threads.empty()) continue;
+
+        next[last] = (uint8_t)pid;
+        prev[pid] = last;
+        last = (uint8_t)pid;
+        offsets[pid + 1] += player.turn_cycles;
+        if(skip_stalls) schedule((uint8_t)pid);
+    }
+    next[last] = 0;
+    prev[0] = last;
+}
+
+void Scheduler::finish() {
+    for(uint8_t pid = next[0]; pid; pid = next[pid]) catchUp(pid);
+}
+
+template<class Policy>
+uint8_t Scheduler::round(EventLog& log) {
+    uint8_t died = 0;
+
+    //every turn is reported, so every player still alive takes one
+    if(!skip_stalls) {
+        for(uint8_t pid = next[0]; pid;) {
+            const uint8_t following = next[pid];
+            if(game.playTurn<Policy>(pid, log)) {
+                remove(pid);
+                ++died;
+            }
+            pid = following;
+        }
+        ++current_round;
+        return died;
+    }
+
+    updateOffsets();
+
+    //players far enough off come onto the wheel once it reaches them
+    while(!later.empty() && later.top().first < current_round + WHEEL_SIZE) {
+        wheel[later.top().first % WHEEL_SIZE].push_back(later.top().second);
+        later.pop();
+    }
+
+    //the turns of the players in between only stall, they are charged cycles as if they were taken
+    std::vector<uint8_t>& slot = wheel[current_round % WHEEL_SIZE];
+    std::sort(slot.begin(), slot.end());
+    uint32_t last = 0;
+    for(uint8_t pid : slot) {
+        game.cycle += budget(last + 1, pid - 1u);
+        catchUp(pid);
+        if(game.playTurn<Policy>(pid, log)) {
+            remove(pid);
+            ++died;
+        }
+        else {
+            synced[pid] = current_round + 1;
+            schedule(pid);
+        }
+        last = pid;
+    }
+    slot.clear();
+    game.cycle += budget(last + 1, num_players);
+
+    ++current_round;
+    return died;
+}
+
+void Scheduler::remove(uint8_t pid) {
+    next[prev[pid]] = next[pid];
+    prev[next[pid]] = prev[pid];
+    //the rest of this round only adds up the turns of players after this one, whose offsets would all
+    //move back the same, so they are put right once before the next round however many die
+    stale = std::min<uint32_t>(stale, pid);
+}
+
+void Scheduler::updateOffsets() {
+    for(uint32_t pid = stale; pid <= num_players; ++pid) {
+        const Player& player = game.players[pid - 1];
+        offsets[pid + 1] = offsets[pid] + (player.threads.empty() ? 0 : player.turn_cycles);
+    }
+    stale = num_players + 1u;
+}
+
+void Scheduler::catchUp(uint8_t pid) {
+    const uint64_t skipped = current_round - synced[pid];
+    if(!skipped) return;
+    synced[pid] = current_round;
+
+    //thread i from the front took turns i, i + size, i + 2 * size, ... of the ones skipped
+    Player& player = game.players[pid - 1];
+    const uint64_t size = player.threads.size();
+    Thread* thread = &player.threads.front();
+    for(uint64_t x = 0; x < std::min(skipped, size); ++x, thread = thread->next)
+        thread->cycles -= (uint32_t)((skipped - x + size - 1) / size * player.turn_cycles);
+    for(uint64_t x = 0; x < skipped % size; ++x) player.threads.rotate();
+}
+
+void Scheduler::schedule(uint8_t pid) {
+    //a thread whose leftover cycles are more than a turn only stalls, each of its stalls puts off
+    //its next real turn by a turn of every thread
+    const Player& player = game.players[pid - 1];
+    const uint64_t size = player.threads.size();
+    const Thread* thread = &player.threads.front();
+    uint64_t wait = UINT64_MAX;
+    for(uint64_t x = 0; x < size && x < wait; ++x, thread = thread->next) {
+        const uint64_t stalls = thread->cycles > player.turn_cycles ?
+                                (thread->cycles - 1) / player.turn_cycles : 0;
+        wait = std::min(wait, x + stalls * size);
+    }
+    const uint64_t round = synced[pid] + wait;
+    if(round < current_round + WHEEL_SIZE) wheel[round % WHEEL_SIZE].push_back(pid);
+    else later.emplace(round, pid);
+}
+
+
+//Game::run needs a round for every policy
+#define X(name, policy, str) \
+    template uint8_t Scheduler::round<LogPolicy::policy>(EventLog&);
+#include "log_policies"
+#undef X
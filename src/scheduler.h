@@ -0,0 +1,89 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "event_log.h"
+
+class Game;
+
+
+/**
+ * Decides which players take a turn in each round, so the work of a round grows with the turns
+ * which do something rather than with the number of players. Players with no threads left are
+ * unlinked from the order in O(1).
+ *
+ * When turns are not reported one by one, a player whose next thread is only paying off an
+ * instruction which takes more than a turn is not visited at all. Each player waits on a timing
+ * wheel in the slot of the round its next thread can complete an instruction, and the turns it
+ * skips until then are charged to its threads when its slot comes up. The game's cycle moves on exactly as
+ * if every player had taken its turn in pid order, so the results are the same as Game::run walking
+ * every player every round.
+ */
+class Scheduler {
+    /// Rounds ahead a player can be put in the wheel, later ones wait in a priority queue
+    static const uint32_t WHEEL_SIZE = 256;
+
+    Game& game;
+    const uint8_t num_players;
+
+    /// Players still alive in pid order, linked by pid, 0 is the head and the end of the order
+    std::vector<uint8_t> next, prev;
+    /// The turn cycles of the players still alive with lower pids, indexed by pid, the last is all of them
+    std::vector<uint64_t> offsets;
+    /// The lowest pid whose offset is out of date since a player before it died, above num_players if none
+    uint32_t stale;
+    /// The round each player's threads are up to date at the start of
+    std::vector<uint64_t> synced;
+    /// Players whose next turn which completes an instruction is in round r are in wheel[r % WHEEL_SIZE]
+    std::vector<uint8_t> wheel[WHEEL_SIZE];
+    /// Players whose next such turn is too far off for the wheel, soonest first
+    std::priority_queue<std::pair<uint64_t, uint8_t>, std::vector<std::pair<uint64_t, uint8_t>>,
+                        std::greater<std::pair<uint64_t, uint8_t>>> later;
+    uint64_t current_round;
+    /// Turns which only stall are skipped, set when neither turns nor instructions are reported
+    bool skip_stalls;
+
+    /// @return The turn cycles of the players still alive with pids from first to last.
+    uint64_t budget(uint32_t first, uint32_t last) const { return offsets[last + 1] - offsets[first]; }
+
+    /// Takes a player out of the order once it has no threads left, in O(1).
+    void remove(uint8_t pid);
+
+    /// Brings the offsets of the players after those who died up to date.
+    void updateOffsets();
+
+    /// Charges the turns a player skipped since its threads were last up to date.
+    void catchUp(uint8_t pid);
+
+    /// Queues a player for the first round from now on its next turn completes an instruction.
+    void schedule(uint8_t pid);
+
+public:
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    /// @param game The game whose turns are scheduled, it need not be loaded.
+    Scheduler(Game& game);
+
+    /**
+     * Starts scheduling the players as they are now, it must be called before the first round of
+     * every run.
+     * @param skip_stalls True if turns which only stall need not be taken, they must not be
+     *                    reported.
+     */
+    void start(bool skip_stalls);
+
+    /// Charges every player the turns it skipped, it must be called once a run is over.
+    void finish();
+
+    /**
+     * Runs every turn of a round, exactly as Game::run would one after another.
+     * @param log Where events are reported.
+     * @return The number of players who died.
+     */
+    template<class Policy>
+    uint8_t round(EventLog& log);
+};
@@ -0,0 +1,137 @@
+#include "snapshot.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+using Snapshot::Record;
+
+
+static const char MAGIC[] = {'O', 'B', 'S', 'N'};
+
+static void write64(std::ostream& out, uint64_t v) {
+    char bytes[8];
+    for(int x = 0; x < 8; ++x) bytes[x] = (char)(v >> (8 * x));
+    out.write(bytes, 8);
+}
+
+static void writeHeader(std::ostream& out, Record type, uint64_t cycle) {
+    out.put((char)type);
+    write64(out, cycle);
+}
+
+//writes bytes or owners of RAM through a small buffer since either layout of Memory can be in use
+static void writeMemory(std::ostream& out, const Memory& memory, size_t offset, size_t size, bool owners) {
+    char buffer[0x1000];
+    for(size_t x = 0; x < size; x += sizeof(buffer)) {
+        const size_t chunk = std::min(sizeof(buffer), size - x);
+        if(owners) memory.copyOwners((uint16_t)(offset + x), chunk, (uint8_t*)buffer);
+        else memory.copyBytes((uint16_t)(offset + x), chunk, (uint8_t*)buffer);
+        out.write(buffer, chunk);
+    }
+}
+
+//reads exactly size bytes, an incomplete record is an error
+static void readExactly(std::istream& in, void* dst, size_t size) {
+    if(!in.read((char*)dst, size)) throw std::runtime_error("Incomplete snapshot record");
+}
+
+
+SnapshotWriter::SnapshotWriter(std::ostream& out, uint64_t keyframe_cycles) : out(out),
+        keyframe_cycles(std::max<uint64_t>(keyframe_cycles, 1)), next_keyframe(0) {
+    out.put((char)Record::HEADER);
+    out.write(MAGIC, 4);
+    out.put((char)Snapshot::VERSION);
+}
+
+bool SnapshotWriter::write(uint64_t cycle, const Memory& ram, DirtyPages& dirty) {
+    if(cycle >= next_keyframe) {
+        keyframe(cycle, ram);
+        dirty.clear();
+        return true;
+    }
+    if(!dirty.any()) return false;
+
+    //find the runs of dirty pages
+    uint16_t starts[DirtyPages::NUM_PAGES], lengths[DirtyPages::NUM_PAGES];
+    uint16_t ranges = 0;
+    for(uint32_t page = 0; page < DirtyPages::NUM_PAGES; ++page) {
+        if(!dirty.isDirty(page)) continue;
+        if(ranges && starts[ranges - 1] + lengths[ranges - 1] == page) ++lengths[ranges - 1];
+        else {
+            starts[ranges] = (uint16_t)page;
+            lengths[ranges++] = 1;
+        }
+    }
+
+    writeHeader(out, Record::DELTA, cycle);
+    out.put((char)ranges);
+    out.put((char)(ranges >> 8));
+    for(uint16_t x = 0; x < ranges; ++x) {
+        const size_t offset = starts[x] * DirtyPages::PAGE_SIZE;
+        const size_t size = lengths[x] * DirtyPages::PAGE_SIZE;
+        out.put((char)starts[x]);
+        out.put((char)(lengths[x] - 1));
+        writeMemory(out, ram, offset, size, false);
+        writeMemory(out, ram, offset, size, true);
+    }
+    dirty.clear();
+    return false;
+}
+
+void SnapshotWriter::keyframe(uint64_t cycle, const Memory& ram) {
+    writeHeader(out, Record::KEYFRAME, cycle);
+    writeMemory(out, ram, 0, Memory::SIZE, false);
+    writeMemory(out, ram, 0, Memory::SIZE, true);
+    next_keyframe = cycle + keyframe_cycles;
+}
+
+
+SnapshotReader::SnapshotReader(std::istream& in) : in(in), synced(false), cycle(0) {
+    std::fill_n(ram, 0x10000, 0);
+    std::fill_n(pid, 0x10000, 0);
+}
+
+bool SnapshotReader::next() {
+    const int type = in.get();
+    if(type == std::char_traits<char>::eof()) return false;
+
+    if((Record)type == Record::HEADER) {
+        uint8_t header[5];
+        readExactly(in, header, 5);
+        if(!std::equal(MAGIC, MAGIC + 4, header)) throw std::runtime_error("Not a snapshot stream");
+        if(header[4] != Snapshot::VERSION) throw std::runtime_error("Unsupported snapshot version");
+        return true;
+    }
+
+    uint8_t bytes[8];
+    readExactly(in, bytes, 8);
+    uint64_t record_cycle = 0;
+    for(int x = 0; x < 8; ++x) record_cycle |= (uint64_t)bytes[x] << (8 * x);
+
+    if((Record)type == Record::KEYFRAME) {
+        readExactly(in, ram, 0x10000);
+        readExactly(in, pid, 0x10000);
+        synced = true;
+    }
+    else if((Record)type == Record::DELTA) {
+        readExactly(in, bytes, 2);
+        const uint16_t ranges = (uint16_t)(bytes[0] | (bytes[1] << 8));
+        for(uint16_t x = 0; x < ranges; ++x) {
+            readExactly(in, bytes, 2);
+            const size_t offset = bytes[0] * DirtyPages::PAGE_SIZE;
+            const size_t size = (bytes[1] + 1) * DirtyPages::PAGE_SIZE;
+            if(offset + size > 0x10000) throw std::runtime_error("Invalid snapshot range");
+            //a delta only makes sense on top of a keyframe, before one it is read and dropped
+            if(synced) {
+                readExactly(in, ram + offset, size);
+                readExactly(in, pid + offset, size);
+            }
+            else if(in.ignore(2 * size).gcount() != (std::streamsize)(2 * size))
+                throw std::runtime_error("Incomplete snapshot record");
+        }
+    }
+    else throw std::runtime_error("Invalid snapshot record");
+
+    cycle = record_cycle;
+    return true;
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <cstdint>
+#include <istream>
+#include <ostream>
+
+#include "dirty_pages.h"
+#include "memory.h"
+
+
+/**
+ * A snapshot stream lets a spectator see the state of RAM and who owns it without replaying every
+ * instruction. It starts with a HEADER and then every little-endian record is
+ *
+ *      byte 0      type
+ *      bytes 1-8   cycle
+ *
+ * followed by, for a KEYFRAME, all of RAM and then all of the pids, and for a DELTA the number of
+ * ranges of dirty pages in 2 bytes, then for each range its first page and its number of pages - 1
+ * in 1 byte each followed by the RAM and then the pids of those pages. A viewer joining late starts
+ * from the latest keyframe.
+ */
+namespace Snapshot {
+    /// Version written in the header, increment if the format changes
+    constexpr uint8_t VERSION = 1;
+
+    enum class Record : uint8_t {
+        /// Start of a stream: "OBSN" and the version, the cycle is not written
+        HEADER,
+        /// All of RAM and pid
+        KEYFRAME,
+        /// The pages changed since the previous record
+        DELTA
+    };
+}
+
+
+/**
+ * Writes a snapshot stream, see Snapshot. Keyframes are written every so many cycles and deltas
+ * holding the pages written since the previous record in between.
+ */
+class SnapshotWriter {
+    std::ostream& out;
+    const uint64_t keyframe_cycles;
+    uint64_t next_keyframe;
+
+public:
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    /**
+     * Starts a new stream with a header.
+     * @param out Stream to write to, should be opened in binary mode.
+     * @param keyframe_cycles Most cycles between keyframes.
+     */
+    SnapshotWriter(std::ostream& out, uint64_t keyframe_cycles);
+
+    /**
+     * Writes a keyframe if one is due, otherwise a delta if any page is dirty, and then clears the
+     * dirty pages.
+     * @param cycle The cycle the game is on.
+     * @param ram The game's RAM and who owns it.
+     * @param dirty Pages written since the previous snapshot.
+     * @return True if a keyframe was written.
+     */
+    bool write(uint64_t cycle, const Memory& ram, DirtyPages& dirty);
+
+    /// Writes a keyframe now.
+    void keyframe(uint64_t cycle, const Memory& ram);
+};
+
+
+/**
+ * Reads a snapshot stream and keeps the state it describes.
+ */
+class SnapshotReader {
+    std::istream& in;
+    bool synced;
+
+public:
+    uint8_t ram[0x10000];
+    uint8_t pid[0x10000];
+    /// The cycle of the last record applied
+    uint64_t cycle;
+
+    /// @param in Stream to read from, can start at any keyframe rather than the header.
+    SnapshotReader(std::istream& in);
+
+    /**
+     * Applies the next record. Deltas before the first keyframe are skipped.
+     * @return False if there are no more records.
+     * @throws std::runtime_error if the stream is not valid.
+     */
+    bool next();
+
+    /// @return True once a keyframe has been read, before then ram and pid are not known.
+    bool isSynced() const { return synced; }
+};
@@ -0,0 +1,211 @@
+#include "speculative_turns.h"
+
+#include "game.h"
+#include "player.h"
+#include "work_stealing_pool.h"
+
+#include <algorithm>
+
+
+void SpeculativeTurns::TurnRecord::exec(uint64_t cycle, uint8_t pid, uint16_t ip, uint64_t end) {
+    events.push_back({Event::EXEC, ip, Fault::NONE, cycle, end});
+}
+
+void SpeculativeTurns::TurnRecord::stall(uint64_t cycle, uint8_t pid, uint16_t ip) {
+    events.push_back({Event::STALL, ip, Fault::NONE, cycle, cycle});
+}
+
+void SpeculativeTurns::TurnRecord::fault(uint64_t cycle, uint8_t pid, uint16_t ip, Fault fault) {
+    events.push_back({Event::FAULT, ip, fault, cycle, cycle});
+}
+
+void SpeculativeTurns::TurnRecord::clear() {
+    events.clear();
+    reads.clear();
+}
+
+void SpeculativeTurns::TurnRecord::replay(EventLog& log, uint8_t pid, uint64_t start) const {
+    for(const Event& event : events) {
+        switch(event.kind) {
+            case Event::EXEC:
+                log.exec(start + event.cycle, pid, event.ip, start + event.end);
+                break;
+            case Event::STALL:
+                log.stall(start + event.cycle, pid, event.ip);
+                break;
+            case Event::FAULT:
+                log.fault(start + event.cycle, pid, event.ip, event.fault);
+                break;
+        }
+    }
+}
+
+
+SpeculativeTurns::SpeculativeTurns(Game& game, size_t num_lanes) : game(game), turns(game.num_players),
+        changed_in(new uint32_t[Memory::SIZE]), current_round(0), rerun(0) {
+    //a lane with no players would never run a turn
+    num_lanes = std::max<size_t>(std::min<size_t>(num_lanes, game.num_players), 1);
+    for(size_t x = 0; x < num_lanes; ++x) lanes.push_back(new Game(game, *this));
+    pool = num_lanes > 1 ? new WorkStealingPool(num_lanes - 1) : nullptr;
+    std::fill_n(changed_in, Memory::SIZE, 0);
+}
+
+SpeculativeTurns::~SpeculativeTurns() {
+    delete pool;
+    for(Game* lane : lanes) delete lane;
+    delete[] changed_in;
+}
+
+void SpeculativeTurns::sync() {
+    for(Game* lane : lanes) {
+        lane->ram = game.ram;
+        lane->cache.clear();
+    }
+    changed.clear();
+}
+
+template<class Policy>
+uint8_t SpeculativeTurns::round(EventLog& log) {
+    for(size_t x = 1; x < lanes.size(); ++x)
+        pool->submit([this, x]{ speculate<Policy>(x); });
+    speculate<Policy>(0);
+    if(pool) pool->wait();
+
+    //bytes changed in earlier rounds are in every lane now
+    if(++current_round == 0) {
+        std::fill_n(changed_in, Memory::SIZE, 0);
+        current_round = 1;
+    }
+    changed.clear();
+
+    //commit the turns in order, running any which read stale memory again
+    uint8_t died = 0;
+    for(uint8_t pid = 1; pid <= game.num_players; ++pid) {
+        //as in Game::run, a player with no threads left is skipped
+        if(game.players[pid - 1].threads.empty()) continue;
+        Turn& turn = turns[pid - 1];
+        const uint64_t turn_start = game.cycle;
+        game.ownership.setWriter(pid);
+
+        bool survived;
+        if(conflicts(turn)) {
+            game.turn_instructions = 0;
+            survived = rerunTurn<Policy>(pid, log);
+        }
+        else {
+            for(const Change& change : turn.changes) {
+                game.ownership.overwrite(change.addr, change.byte);
+                game.ram[change.addr] = change.byte;
+                game.cache.invalidate(change.addr);
+                game.ownership.write(change.addr);
+                markChanged(change.addr);
+            }
+            //writes which left bytes as they were count for the idle check and snapshots
+            game.cache.dirtyPages() |= turn.written;
+            turn.log.replay(log, pid, turn_start);
+            game.players[pid - 1].threads.front() = turn.thread;
+            game.cycle += turn.cycles;
+            game.turn_instructions = turn.instructions;
+            survived = turn.survived;
+        }
+
+        if(Policy::turns) log.turn(turn_start, game.cycle, pid, game.turn_instructions);
+        if(game.endTurn(pid, survived)) ++died;
+    }
+
+    return died;
+}
+
+template<class Policy>
+void SpeculativeTurns::speculate(size_t index) {
+    Game& lane = *lanes[index];
+    const Memory& ram = game.ram;
+
+    for(uint16_t addr : changed) {
+        lane.ram[addr] = ram[addr];
+        lane.ram.owner(addr) = ram.owner(addr);
+        lane.cache.invalidate(addr);
+    }
+
+    for(size_t pid = index + 1; pid <= game.num_players; pid += lanes.size()) {
+        const Player& player = game.players[pid - 1];
+        if(player.threads.empty()) continue;
+        Turn& turn = turns[pid - 1];
+        turn.thread = player.threads.front();
+        turn.log.clear();
+
+        uint32_t remaining_cycles = player.turn_cycles;
+        lane.cycle = 0;
+        lane.turn_instructions = 0;
+        lane.ownership.setWriter((uint8_t)pid);
+        lane.cache.dirtyPages().clear();
+        turn.survived = lane.threaded_dispatch ?
+                lane.execTurnThreaded<LogPolicy::Speculative<Policy>>(turn.thread, (uint8_t)pid, remaining_cycles, turn.log) :
+                lane.execTurn<LogPolicy::Speculative<Policy>>(turn.thread, (uint8_t)pid, remaining_cycles, turn.log);
+        turn.cycles = lane.cycle;
+        turn.instructions = lane.turn_instructions;
+
+        //only pages which were written can differ from the game
+        turn.changes.clear();
+        turn.written = lane.cache.dirtyPages();
+        for(uint32_t page = 0; page < DirtyPages::NUM_PAGES; ++page) {
+            if(!turn.written.isDirty(page)) continue;
+            for(uint32_t x = page * DirtyPages::PAGE_SIZE; x < (page + 1) * DirtyPages::PAGE_SIZE; ++x) {
+                const uint16_t addr = (uint16_t)x;
+                if(lane.ram[addr] == ram[addr] && lane.ram.owner(addr) == ram.owner(addr)) continue;
+                turn.changes.push_back({addr, lane.ram[addr]});
+                lane.ram[addr] = ram[addr];
+                lane.ram.owner(addr) = ram.owner(addr);
+                lane.cache.invalidate(addr);
+            }
+        }
+    }
+}
+
+template<class Policy>
+bool SpeculativeTurns::rerunTurn(uint8_t pid, EventLog& log) {
+    ++rerun;
+    const Player& player = game.players[pid - 1];
+    uint32_t remaining_cycles = player.turn_cycles;
+    Thread& thread = game.players[pid - 1].threads.front();
+
+    //the pages this turn writes are kept apart from the rest so only they are compared
+    DirtyPages& dirty = game.cache.dirtyPages();
+    const DirtyPages before = dirty;
+    dirty.clear();
+    const bool survived = game.threaded_dispatch ?
+                          game.execTurnThreaded<Policy>(thread, pid, remaining_cycles, log) :
+                          game.execTurn<Policy>(thread, pid, remaining_cycles, log);
+
+    //the lanes still hold RAM as it was at the start of the round
+    const Memory& start = lanes[0]->ram;
+    for(uint32_t page = 0; page < DirtyPages::NUM_PAGES; ++page) {
+        if(!dirty.isDirty(page)) continue;
+        for(uint32_t x = page * DirtyPages::PAGE_SIZE; x < (page + 1) * DirtyPages::PAGE_SIZE; ++x) {
+            const uint16_t addr = (uint16_t)x;
+            if(game.ram[addr] != start[addr] || game.ram.owner(addr) != start.owner(addr)) markChanged(addr);
+        }
+    }
+    dirty |= before;
+    return survived;
+}
+
+bool SpeculativeTurns::conflicts(const Turn& turn) const {
+    for(const auto& read : turn.log.reads)
+        for(uint8_t x = 0; x < read.second; ++x)
+            if(changed_in[(uint16_t)(read.first + x)] == current_round) return true;
+    return false;
+}
+
+void SpeculativeTurns::markChanged(uint16_t addr) {
+    if(changed_in[addr] == current_round) return;
+    changed_in[addr] = current_round;
+    changed.push_back(addr);
+}
+
+
+//Game::run needs a round for every policy
+#define X(name, policy, str) \
+    template uint8_t SpeculativeTurns::round<LogPolicy::policy>(EventLog&);
+#include "log_policies"
+#undef X
@@ -0,0 +1,153 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "dirty_pages.h"
+#include "event_log.h"
+#include "thread.h"
+
+class Game;
+class WorkStealingPool;
+
+
+/**
+ * Runs the turns of a round on several threads at once. Every turn is run on a lane, a copy of the
+ * game's RAM as it was when the round started, and records the bytes it read and what it changed.
+ * The turns are then committed to the game in pid order, and a turn which read a byte an earlier
+ * turn of the round changed is thrown away and run again on the game itself. The game ends up
+ * exactly as if the turns had been run one after another, which pays off for games with many
+ * players who rarely touch each other's memory.
+ *
+ * The bytes a turn writes count as read, so two turns writing the same byte in a round always run
+ * the later one again rather than committing it over the earlier one.
+ */
+class SpeculativeTurns {
+    /**
+     * The events of a turn run on a lane, kept to be reported once the turn is committed, with
+     * cycles counted from the start of the turn. Also keeps the bytes the turn read.
+     */
+    class TurnRecord : public EventLog {
+        struct Event {
+            enum Kind : uint8_t { EXEC, STALL, FAULT } kind;
+            uint16_t ip;
+            Fault fault;
+            uint64_t cycle, end;
+        };
+        std::vector<Event> events;
+
+    public:
+        /// Each read, its address and number of bytes
+        std::vector<std::pair<uint16_t, uint8_t>> reads;
+
+        void init(uint64_t cycle, const std::vector<uint16_t>& starts) override {}
+        void exec(uint64_t cycle, uint8_t pid, uint16_t ip, uint64_t end) override;
+        void stall(uint64_t cycle, uint8_t pid, uint16_t ip) override;
+        void fault(uint64_t cycle, uint8_t pid, uint16_t ip, Fault fault) override;
+        void turn(uint64_t cycle, uint64_t end, uint8_t pid, uint32_t count) override {}
+        void score(uint64_t cycle, uint8_t pid, uint32_t score) override {}
+        void end(uint64_t cycle, GameEnd reason, uint8_t winner) override {}
+        void skipped(uint64_t cycle, uint64_t end, uint32_t count) override {}
+        void read(uint16_t addr, uint8_t len) override { reads.emplace_back(addr, len); }
+
+        /// Forgets every event and read.
+        void clear();
+
+        /**
+         * Reports the events in the order they happened.
+         * @param log Where to report them.
+         * @param pid The pid of the player whose turn it was.
+         * @param start The cycle the turn started on.
+         */
+        void replay(EventLog& log, uint8_t pid, uint64_t start) const;
+    };
+
+    /// A byte of RAM a turn changed, the turn's player owns it from then on
+    struct Change {
+        uint16_t addr;
+        uint8_t byte;
+    };
+
+    /// What a turn did on a lane
+    struct Turn {
+        /// The thread as it was when the turn ended
+        Thread thread;
+        bool survived;
+        /// Cycles the turn took and instructions completed, only counted when turns are logged
+        uint64_t cycles;
+        uint32_t instructions;
+        TurnRecord log;
+        std::vector<Change> changes;
+        /// Every page the turn wrote, including writes which left a byte as it was
+        DirtyPages written;
+    };
+
+    Game& game;
+    /// Games holding RAM as it was at the start of the round, lane i runs the turns of pids i + 1,
+    /// i + 1 + the number of lanes, and so on
+    std::vector<Game*> lanes;
+    /// Runs every lane but the first, null if there is only one
+    WorkStealingPool* pool;
+
+    /// The turn of the player with pid i + 1 in this round
+    std::vector<Turn> turns;
+    /// The round each byte of RAM last changed in, a byte read from before then is up to date
+    uint32_t* changed_in;
+    uint32_t current_round;
+    /// Every byte changed in this round, each lane copies them before it runs the next round
+    std::vector<uint16_t> changed;
+
+    uint64_t rerun;
+
+    /**
+     * Brings a lane up to the start of the round and runs its turns, putting its RAM back after
+     * each one.
+     * @param lane Index of the lane.
+     */
+    template<class Policy>
+    void speculate(size_t lane);
+
+    /**
+     * Runs a turn again on the game and notes what it changed.
+     * @param pid The player whose turn it is.
+     * @param log Where events are reported.
+     * @return True if the thread survived its turn.
+     */
+    template<class Policy>
+    bool rerunTurn(uint8_t pid, EventLog& log);
+
+    /// @return True if the turn read a byte which changed earlier in this round.
+    bool conflicts(const Turn& turn) const;
+
+    /// Notes that a byte changed in this round.
+    void markChanged(uint16_t addr);
+
+public:
+    SpeculativeTurns(const SpeculativeTurns&) = delete;
+    SpeculativeTurns& operator=(const SpeculativeTurns&) = delete;
+
+    /**
+     * @param game The game whose turns are run, it must have its settings but need not be loaded.
+     * @param num_lanes Number of turns run at once, each on its own thread.
+     */
+    SpeculativeTurns(Game& game, size_t num_lanes);
+    ~SpeculativeTurns();
+
+    /// @return The number of lanes turns are run on.
+    size_t numLanes() const { return lanes.size(); }
+
+    /// Copies the game's RAM to every lane, it must be called whenever the game is loaded.
+    void sync();
+
+    /**
+     * Runs every turn of a round, exactly as Game::run would one after another.
+     * @param log Where events are reported.
+     * @return The number of players who died.
+     */
+    template<class Policy>
+    uint8_t round(EventLog& log);
+
+    /// @return The number of turns which had to be run again.
+    uint64_t reruns() const { return rerun; }
+};
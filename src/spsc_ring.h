@@ -0,0 +1,92 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+
+/**
+ * A fixed size lock-free queue for exactly one producer thread and one consumer thread. The
+ * producer only ever writes tail and the consumer only ever writes head, so neither needs a lock.
+ * @tparam T Type of the elements, should be cheap to copy.
+ */
+template<class T>
+class SpscRing {
+    /// Keeps the indices on separate cache lines so the two threads do not contend for them
+    static const size_t CACHE_LINE = 64;
+
+    T* const slots;
+    /// capacity - 1, capacity is a power of 2 so this masks an index into slots
+    const size_t mask;
+
+    std::atomic<size_t> head; //next to pop, written by the consumer
+    char padding[CACHE_LINE - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> tail; //next to push, written by the producer
+
+public:
+    SpscRing() = delete;
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /**
+     * @param capacity Number of elements the ring can hold, rounded up to a power of 2.
+     */
+    SpscRing(size_t capacity);
+    ~SpscRing();
+
+    /**
+     * Adds an element if there is room. Only call from the producer.
+     * @return False if the ring is full.
+     */
+    inline bool push(const T& v);
+
+    /**
+     * Removes up to max elements. Only call from the consumer.
+     * @param out Where the elements are copied to.
+     * @param max The most elements to remove.
+     * @return The number of elements removed.
+     */
+    inline size_t pop(T* out, size_t max);
+
+    /// @return True if there is nothing to pop, may be stale by the time it returns.
+    inline bool empty() const;
+};
+
+
+//Round up to a power of 2 so indices can be masked rather than divided
+static inline size_t ringCapacity(size_t capacity) {
+    size_t c = 2;
+    while(c < capacity) c <<= 1;
+    return c;
+}
+
+template<class T>
+SpscRing<T>::SpscRing(size_t capacity) : slots(new T[ringCapacity(capacity)]),
+        mask(ringCapacity(capacity) - 1), head(0), tail(0) {}
+
+template<class T>
+SpscRing<T>::~SpscRing() {
+    delete[] slots;
+}
+
+template<class T>
+inline bool SpscRing<T>::push(const T& v) {
+    const size_t t = tail.load(std::memory_order_relaxed);
+    if(t - head.load(std::memory_order_acquire) > mask) return false;
+    slots[t & mask] = v;
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+}
+
+template<class T>
+inline size_t SpscRing<T>::pop(T* out, size_t max) {
+    const size_t h = head.load(std::memory_order_relaxed);
+    size_t n = tail.load(std::memory_order_acquire) - h;
+    if(n > max) n = max;
+    for(size_t x = 0; x < n; ++x) out[x] = slots[(h + x) & mask];
+    head.store(h + n, std::memory_order_release);
+    return n;
+}
+
+template<class T>
+inline bool SpscRing<T>::empty() const {
+    return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+}
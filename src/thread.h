@@ -2,15 +2,58 @@
 #include <cstdint>
 
 
+/**
+ * Operations which set every flag and whose flags can be computed later from just their operands
+ * and result. CMP uses SUB and TEST uses LOGIC since they set the flags the same way.
+ */
+enum class FlagOp : uint8_t { NONE, ADD, SUB, LOGIC };
+
+/**
+ * The last flag setting operation of a thread whose flags have not been computed yet.
+ */
+struct PendingFlags {
+    FlagOp op;
+    /// True if the operation was 8 bit
+    bool ebit;
+    uint16_t arg1, arg2, result;
+};
+
+
 struct Thread {
     uint16_t ax, bx, cx, ip;
     // overflow, sign, zero, carry
     bool o, s, z, c;
 
+    /// Flags which still need to be computed; o, s, z and c are stale until resolveFlags is called
+    PendingFlags pending;
+
     /// in case it gets stopped mid-instruction, this is how many more cycles it needs
     uint32_t cycles;
 
-    Thread(uint16_t ip = 0) : ax(0), bx(0), cx(0), ip(ip), o(false), s(false), z(false), c(false), cycles(0) {}
+    /// Neighbours in the player's RunList
+    Thread* next;
+    Thread* prev;
+
+    Thread(uint16_t ip = 0) : ax(0), bx(0), cx(0), ip(ip), o(false), s(false), z(false), c(false),
+            pending{FlagOp::NONE, false, 0, 0, 0}, cycles(0), next(nullptr), prev(nullptr) {}
+
+    /**
+     * Sets every flag from the result of an operation. If Lazy they are only recorded and will be
+     * computed by resolveFlags, otherwise they are computed immediately.
+     * @param op The kind of operation which was performed.
+     * @param arg1 Value of the first operand.
+     * @param arg2 Value of the second operand.
+     * @param result The result of the operation.
+     * @param ebit True if the operation was 8 bit.
+     */
+    template<bool Lazy>
+    inline void setFlags(FlagOp op, uint16_t arg1, uint16_t arg2, uint16_t result, bool ebit);
+
+    /**
+     * Computes any flags which were set lazily. This must be called before the flags are read and
+     * before an operation which only sets some of them.
+     */
+    inline void resolveFlags();
 
     /**
      * Read lower 8 bits of a register. E.g. AL = readLow(AX);
@@ -34,4 +77,39 @@ inline uint8_t Thread::readLow(uint16_t reg) {
 
 inline uint8_t Thread::readHigh(uint16_t reg) {
     return reg >> 8;
-}
\ No newline at end of file
+}
+
+template<bool Lazy>
+inline void Thread::setFlags(FlagOp op, uint16_t arg1, uint16_t arg2, uint16_t result, bool ebit) {
+    pending = {op, ebit, arg1, arg2, result};
+    if(!Lazy) resolveFlags();
+}
+
+inline void Thread::resolveFlags() {
+    const PendingFlags& p = pending;
+    const uint16_t smask = p.ebit ? 0x0080 : 0x8000;
+    const bool arg1s = (p.arg1 & smask) != 0;
+    const bool arg2s = (p.arg2 & smask) != 0;
+    const bool results = (p.result & smask) != 0;
+
+    switch(p.op) {
+        case FlagOp::NONE:
+            return;
+        case FlagOp::ADD:
+            c = p.result < p.arg1 || p.result < p.arg2;
+            //overflow if both args have same sign and the result has a sign which is the opposite
+            o = arg1s == arg2s && results != arg1s;
+            break;
+        case FlagOp::SUB:
+            c = p.arg1 < p.arg2;
+            //the sign of arg2 is flipped because of the implicit subtraction
+            o = arg1s != arg2s && results != arg1s;
+            break;
+        case FlagOp::LOGIC:
+            o = c = false;
+            break;
+    }
+    s = results;
+    z = !p.result;
+    pending.op = FlagOp::NONE;
+}
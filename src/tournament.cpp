@@ -0,0 +1,127 @@
+#include "tournament.h"
+
+#include "game.h"
+#include "work_stealing_pool.h"
+
+#include <algorithm>
+#include <ostream>
+#include <stdexcept>
+
+
+Tournament::Tournament(const Json& base, const Json& pool) : base(base) {
+    if(!pool.is_object() || !pool.count("warriors") || !pool["warriors"].is_array())
+        throw std::invalid_argument("Tournament pool has no warriors");
+    const Json& warriors = pool["warriors"];
+    if(warriors.size() < 2) throw std::invalid_argument("A tournament needs at least 2 warriors");
+    for(const Json& entry : warriors) {
+        if(!entry.is_object() || !entry.count("warrior") || !entry["warrior"].is_string())
+            throw std::invalid_argument("Invalid warrior in tournament pool");
+        entries.push_back(entry);
+        if(!entry.count("name")) entries.back()["name"] = "Warrior_" + std::to_string(entries.size());
+    }
+
+    uint32_t seeds = 1;
+    if(pool.count("seeds")) {
+        if(!pool["seeds"].is_number_integer() || pool["seeds"] < 0)
+            throw std::invalid_argument("Invalid number of seeds");
+        seeds = pool["seeds"];
+    }
+    uint64_t first_seed = 0;
+    if(base.count("seed")) {
+        if(!base["seed"].is_number_integer() || base["seed"] < 0)
+            throw std::invalid_argument("Invalid seed");
+        first_seed = base["seed"];
+    }
+
+    //pid 1 moves first, so each pairing is played from both seats with the same seed
+    for(uint32_t a = 0; a < entries.size(); ++a)
+    for(uint32_t b = a + 1; b < entries.size(); ++b)
+    for(uint32_t s = 0; s < seeds; ++s)
+    for(uint32_t seat = 0; seat < 2; ++seat) {
+        MatchResult match;
+        match.players[0] = seat ? b : a;
+        match.players[1] = seat ? a : b;
+        match.seed = first_seed + s;
+        match.scores[0] = match.scores[1] = 0;
+        matches.push_back(match);
+    }
+}
+
+void Tournament::run(size_t threads) {
+    WorkStealingPool pool(threads);
+    for(MatchResult& match : matches)
+        pool.submit([this, &match]{ play(match); });
+    pool.wait();
+}
+
+void Tournament::play(MatchResult& match) {
+    Json config = base;
+    config["num_players"] = 2;
+    config["seed"] = match.seed;
+    config["player_settings"] = Json::array({entries[match.players[0]], entries[match.players[1]]});
+    config["warriors"] = Json::array({entries[match.players[0]].at("warrior"), entries[match.players[1]].at("warrior")});
+    //only the scores are wanted
+    config["log_events"] = "none";
+
+    try {
+        Game game(config);
+        std::ostream log(nullptr);
+        game.run(log);
+        match.scores[0] = game.score(1);
+        match.scores[1] = game.score(2);
+    }
+    catch(std::exception& e) { match.error = e.what(); }
+}
+
+Json Tournament::results() const {
+    struct Standing {
+        uint32_t wins, draws, losses;
+        uint64_t score;
+    };
+    std::vector<Standing> standings(entries.size(), Standing{0, 0, 0, 0});
+
+    Json out_matches = Json::array();
+    for(const MatchResult& match : matches) {
+        Json m = {
+            {"players", Json::array({entries[match.players[0]]["name"], entries[match.players[1]]["name"]})},
+            {"seed", match.seed}
+        };
+        if(!match.error.empty()) {
+            m["error"] = match.error;
+            out_matches.push_back(m);
+            continue;
+        }
+        m["scores"] = Json::array({match.scores[0], match.scores[1]});
+        out_matches.push_back(m);
+
+        Standing& a = standings[match.players[0]];
+        Standing& b = standings[match.players[1]];
+        a.score += match.scores[0];
+        b.score += match.scores[1];
+        if(match.scores[0] > match.scores[1]) { ++a.wins; ++b.losses; }
+        else if(match.scores[0] < match.scores[1]) { ++b.wins; ++a.losses; }
+        else { ++a.draws; ++b.draws; }
+    }
+
+    //a win is worth 3 draws, ties are broken by total score
+    std::vector<uint32_t> order(entries.size());
+    for(uint32_t x = 0; x < order.size(); ++x) order[x] = x;
+    std::stable_sort(order.begin(), order.end(), [&standings](uint32_t a, uint32_t b) {
+        const uint64_t pa = 3 * standings[a].wins + standings[a].draws;
+        const uint64_t pb = 3 * standings[b].wins + standings[b].draws;
+        return pa != pb ? pa > pb : standings[a].score > standings[b].score;
+    });
+
+    Json out_standings = Json::array();
+    for(uint32_t x : order) {
+        out_standings.push_back({
+            {"name", entries[x]["name"]},
+            {"wins", standings[x].wins},
+            {"draws", standings[x].draws},
+            {"losses", standings[x].losses},
+            {"score", standings[x].score}
+        });
+    }
+
+    return {{"matches", out_matches}, {"standings", out_standings}};
+}
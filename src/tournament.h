@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <json.hpp>
+using Json = nlohmann::json;
+
+
+/**
+ * The outcome of one game of a tournament.
+ */
+struct MatchResult {
+    /// Indices of the two warriors in the pool, the first is pid 1
+    uint32_t players[2];
+    uint64_t seed;
+    /// Each player's score at the end of the game
+    uint32_t scores[2];
+    /// Why the game could not be played, empty if it was
+    std::string error;
+};
+
+
+/**
+ * A round robin between every pair of warriors in a pool, with each pairing played once per seed
+ * from each seat so neither warrior always moves first. Games are spread over every core by a
+ * WorkStealingPool.
+ */
+class Tournament {
+    /// Config every game starts from, see data/default.json
+    const Json base;
+    /// The player settings of each warrior, with its program under "warrior"
+    std::vector<Json> entries;
+    std::vector<MatchResult> matches;
+
+    /// Plays a game and records the scores or the error in the match.
+    void play(MatchResult& match);
+
+public:
+    Tournament(const Tournament&) = delete;
+    Tournament& operator=(const Tournament&) = delete;
+
+    /**
+     * Generates the matches.
+     * @param base Config every game starts from, the players, warriors, and seed are replaced.
+     * @param pool An object with "warriors", an array of player settings which also hold the
+     *  warrior's base64 program under "warrior", and optionally "seeds", the number of games each
+     *  pairing plays from each seat (1 by default). Game n of a pairing uses the base config's
+     *  seed + n.
+     * @throws std::invalid_argument if the pool is not valid.
+     */
+    Tournament(const Json& base, const Json& pool);
+
+    /**
+     * Plays every match.
+     * @param threads Number of games played at once, 0 for one per core.
+     */
+    void run(size_t threads = 0);
+
+    const std::vector<MatchResult>& getMatches() const { return matches; }
+
+    /**
+     * @return An object with "matches", the players, seed, and scores or error of every match, and
+     *  "standings", every warrior's wins, draws, losses, and total score, best first.
+     */
+    Json results() const;
+};
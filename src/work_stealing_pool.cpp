@@ -0,0 +1,90 @@
+#include "work_stealing_pool.h"
+
+#include <algorithm>
+
+
+WorkStealingPool::WorkStealingPool(size_t threads) :
+        num_workers(threads ? threads : std::max(std::thread::hardware_concurrency(), 1u)),
+        queues(new Queue[num_workers]), next_queue(0), queued(0), pending(0), done(false) {
+    workers.reserve(num_workers);
+    for(size_t x = 0; x < num_workers; ++x)
+        workers.emplace_back(&WorkStealingPool::work, this, x);
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(idle_mutex);
+        done = true;
+    }
+    available.notify_all();
+    for(std::thread& worker : workers) worker.join();
+    delete[] queues;
+}
+
+void WorkStealingPool::submit(Task task) {
+    Queue& queue = queues[next_queue];
+    next_queue = (next_queue + 1) % num_workers;
+
+    ++pending;
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    {
+        //taken so a worker cannot miss the task between checking queued and going to sleep
+        std::lock_guard<std::mutex> lock(idle_mutex);
+        ++queued;
+    }
+    available.notify_one();
+}
+
+void WorkStealingPool::wait() {
+    std::unique_lock<std::mutex> lock(idle_mutex);
+    finished.wait(lock, [this]{ return pending == 0; });
+}
+
+bool WorkStealingPool::take(size_t self, Task& task) {
+    //newest first from our own queue, as it was submitted last it is the least likely to be stolen
+    {
+        Queue& queue = queues[self];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if(!queue.tasks.empty()) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            return true;
+        }
+    }
+
+    //oldest first from everyone else, starting with the next worker so thieves spread out
+    for(size_t x = 1; x < num_workers; ++x) {
+        Queue& queue = queues[(self + x) % num_workers];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if(!queue.tasks.empty()) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::work(size_t self) {
+    Task task;
+    while(true) {
+        if(take(self, task)) {
+            --queued;
+            task();
+            task = nullptr;
+            if(--pending == 0) {
+                std::lock_guard<std::mutex> lock(idle_mutex);
+                finished.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(idle_mutex);
+        available.wait(lock, [this]{ return done || queued > 0; });
+        if(done && queued == 0) return;
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/**
+ * A fixed set of worker threads which run tasks. Every worker has its own queue and takes tasks
+ * from the back of it, and a worker whose queue is empty steals from the front of another's, so
+ * tasks which take very different amounts of time still keep every worker busy.
+ */
+class WorkStealingPool {
+public:
+    typedef std::function<void()> Task;
+
+private:
+    /// A worker's tasks, the owner takes from the back and thieves take from the front
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    /// Number of workers and of queues
+    const size_t num_workers;
+    Queue* const queues;
+    std::vector<std::thread> workers;
+
+    /// Queue the next submitted task goes to
+    size_t next_queue;
+    /// Tasks in the queues, and tasks either queued or running
+    std::atomic<size_t> queued, pending;
+    std::atomic<bool> done;
+
+    /// Wakes idle workers when tasks are submitted and waiters when pending reaches 0
+    std::mutex idle_mutex;
+    std::condition_variable available, finished;
+
+    /// Loop run by each worker.
+    void work(size_t self);
+
+    /**
+     * Takes a task, from the worker's own queue if it has any, otherwise stolen from another's.
+     * @return False if every queue was empty.
+     */
+    bool take(size_t self, Task& task);
+
+public:
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /**
+     * Starts the workers.
+     * @param threads Number of workers, 0 for one per core.
+     */
+    WorkStealingPool(size_t threads = 0);
+
+    /// Runs every task which has been submitted, then stops the workers.
+    ~WorkStealingPool();
+
+    /// @param task Queued to be run by a worker, it must not throw.
+    void submit(Task task);
+
+    /// Waits until every task submitted so far has finished.
+    void wait();
+
+    /// @return The number of workers.
+    size_t size() const { return num_workers; }
+};
@@ -9,7 +9,7 @@
 
 class ArgumentTest : public ::testing::Test {
 protected:
-    uint8_t ram[0x10] = {
+    Memory ram = {
             0x00, 0x00, 0x00, 0x04,
             0x03, 0x11, 0x22, 0x07,
             0x12, 0x53, 0xC3, 0x32,
@@ -0,0 +1,94 @@
+#include <async_log.h>
+#include <event_log.h>
+
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <thread>
+
+//Holds up the writer thread until released so the ring fills up
+class SlowEventLog : public EventLog {
+public:
+    std::atomic<bool> released;
+    std::vector<std::string> events;
+
+    SlowEventLog() : released(false) {}
+
+    void wait() { while(!released.load()) std::this_thread::yield(); }
+
+    void init(uint64_t cycle, const std::vector<uint16_t>& starts) override {
+        events.push_back("init " + std::to_string(starts.size()));
+    }
+    void exec(uint64_t cycle, uint8_t pid, uint16_t ip, uint64_t end) override {
+        wait();
+        events.push_back("exec " + std::to_string(ip));
+    }
+    void stall(uint64_t cycle, uint8_t pid, uint16_t ip) override {
+        events.push_back("stall " + std::to_string(ip));
+    }
+    void fault(uint64_t cycle, uint8_t pid, uint16_t ip, Fault f) override {
+        events.push_back("fault " + std::to_string(ip));
+    }
+    void turn(uint64_t cycle, uint64_t end, uint8_t pid, uint32_t count) override {
+        events.push_back("turn " + std::to_string(count));
+    }
+    void score(uint64_t cycle, uint8_t pid, uint32_t score) override {
+        events.push_back("score " + std::to_string(score));
+    }
+    void end(uint64_t cycle, GameEnd reason, uint8_t winner) override {
+        events.push_back("end " + std::to_string(winner));
+    }
+    void skipped(uint64_t cycle, uint64_t end, uint32_t count) override {
+        events.push_back("skipped " + std::to_string(count) + " " + std::to_string(cycle) + "-" +
+                         std::to_string(end));
+    }
+};
+
+TEST(AsyncLogTest, Block) {
+    std::stringstream expected, actual;
+    JsonEventLog reference(expected);
+    {
+        AsyncEventLog log(new JsonEventLog(actual), 4, AsyncEventLog::Policy::BLOCK);
+        log.init(0, {1, 2, 3});
+        reference.init(0, {1, 2, 3});
+        for(uint16_t x = 0; x < 1000; ++x) {
+            log.exec(x, 1, x, x + 1);
+            reference.exec(x, 1, x, x + 1);
+        }
+        log.fault(1000, 2, 7, Fault::READ_ONLY);
+        reference.fault(1000, 2, 7, Fault::READ_ONLY);
+        reference.flush();
+        log.flush();
+        EXPECT_EQ(actual.str(), expected.str());
+        EXPECT_EQ(log.dropped(), 0);
+    }
+    EXPECT_EQ(actual.str(), expected.str());
+}
+
+TEST(AsyncLogTest, Drop) {
+    SlowEventLog* sink = new SlowEventLog;
+    AsyncEventLog log(sink, 4, AsyncEventLog::Policy::DROP);
+    for(uint16_t x = 0; x < 100; ++x) log.exec(x, 1, x, x + 1);
+    log.fault(100, 1, 100, Fault::READ_ONLY); //never dropped
+    sink->released = true;
+    log.flush();
+
+    //at most a full ring and a batch the writer took before it filled got through
+    EXPECT_GE(log.dropped(), 100 - 8);
+    EXPECT_EQ(sink->events.size() + log.dropped(), 101);
+    EXPECT_EQ(sink->events.back(), "fault 100");
+}
+
+TEST(AsyncLogTest, Coalesce) {
+    SlowEventLog* sink = new SlowEventLog;
+    AsyncEventLog log(sink, 4, AsyncEventLog::Policy::COALESCE);
+    for(uint16_t x = 0; x < 100; ++x) log.exec(x, 1, x, x + 1);
+    sink->released = true;
+    log.flush();
+
+    //everything after the ring filled up is one skipped event ending with the last exec
+    const std::string& last = sink->events.back();
+    EXPECT_EQ(last.find("skipped " + std::to_string(log.dropped())), 0);
+    EXPECT_EQ(last.substr(last.find('-')), "-100");
+    EXPECT_EQ(sink->events.size() - 1 + log.dropped(), 100);
+}
@@ -0,0 +1,128 @@
+#include <binary_log.h>
+#include <event_log.h>
+
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+class BinaryLogTest : public ::testing::Test {
+protected:
+    std::stringstream binary, json, expected;
+    BinaryEventLog* log;
+    JsonEventLog* reference;
+
+    BinaryLogTest() : log(new BinaryEventLog(binary)), reference(new JsonEventLog(expected)) {}
+    ~BinaryLogTest() {
+        delete log;
+        delete reference;
+    }
+
+    //Sends the same events to the binary log and the reference JSON log
+    void init(uint64_t cycle, const std::vector<uint16_t>& starts) {
+        log->init(cycle, starts);
+        reference->init(cycle, starts);
+    }
+    void exec(uint64_t cycle, uint8_t pid, uint16_t ip, uint64_t end) {
+        log->exec(cycle, pid, ip, end);
+        reference->exec(cycle, pid, ip, end);
+    }
+    void stall(uint64_t cycle, uint8_t pid, uint16_t ip) {
+        log->stall(cycle, pid, ip);
+        reference->stall(cycle, pid, ip);
+    }
+    void fault(uint64_t cycle, uint8_t pid, uint16_t ip, Fault f) {
+        log->fault(cycle, pid, ip, f);
+        reference->fault(cycle, pid, ip, f);
+    }
+    void turn(uint64_t cycle, uint64_t end, uint8_t pid, uint32_t count) {
+        log->turn(cycle, end, pid, count);
+        reference->turn(cycle, end, pid, count);
+    }
+    void score(uint64_t cycle, uint8_t pid, uint32_t score) {
+        log->score(cycle, pid, score);
+        reference->score(cycle, pid, score);
+    }
+    void end(uint64_t cycle, GameEnd reason, uint8_t winner) {
+        log->end(cycle, reason, winner);
+        reference->end(cycle, reason, winner);
+    }
+    void skipped(uint64_t cycle, uint64_t end, uint32_t count) {
+        log->skipped(cycle, end, count);
+        reference->skipped(cycle, end, count);
+    }
+
+    //Converts what was written to the binary log to JSON
+    std::string dump() {
+        log->flush();
+        JsonEventLog out(json);
+        BinaryLogReader reader(binary);
+        reader.replay(out);
+        return json.str();
+    }
+
+    //What the reference JSON log wrote
+    std::string referenceJson() {
+        reference->flush();
+        return expected.str();
+    }
+};
+
+TEST_F(BinaryLogTest, RoundTrip) {
+    init(0, {0x1000, 0xF000});
+    exec(1, 1, 0x1000, 3);
+    exec(3, 2, 0xF000, 11);
+    exec(11, 1, 0x0FFE, 13); //jump backwards
+    stall(13, 2, 0xF002);
+    fault(14, 1, 0x1234, Fault::DIVIDE_BY_ZERO);
+    exec(20, 2, 0xF002, 30);
+    skipped(30, 90000, 70000);
+    exec(90000, 1, 0x1236, 90004);
+    turn(90004, 90104, 2, 100000);
+    exec(90104, 1, 0x1238, 90106);
+    score(90106, 1, 3000000);
+    score(90106, 2, 0);
+    end(90106, GameEnd::SCORE_LEAD, 1);
+    end(90106, GameEnd::MAX_CYCLES, 0);
+    EXPECT_EQ(dump(), referenceJson());
+}
+
+TEST_F(BinaryLogTest, Size) {
+    init(0, {0x1000});
+    for(uint16_t x = 0; x < 1000; ++x) exec(1 + 2 * x, 1, (uint16_t)(0x1000 + 2 * x), 3 + 2 * x);
+    log->flush();
+    EXPECT_EQ(binary.str().size(), BinaryLog::RECORD_SIZE * 1002);
+    EXPECT_GT(referenceJson().size(), binary.str().size() * 6);
+}
+
+TEST_F(BinaryLogTest, LargeCycles) {
+    init(5, {0});
+    exec(0x123456789AULL, 1, 2, 0x123456789BULL); //needs a sync
+    exec(0x123456789BULL, 1, 4, 0x123456789BULL + 0x10000); //needs an end
+    stall(0x123456789BULL + 0x10000, 1, 6);
+    exec(0x10, 1, 8, 0x12); //cycles going backwards also sync
+    EXPECT_EQ(dump(), referenceJson());
+}
+
+TEST_F(BinaryLogTest, Invalid) {
+    binary.str("not a binary log");
+    JsonEventLog out(json);
+    BinaryLogReader reader(binary);
+    EXPECT_THROW(reader.replay(out), std::runtime_error);
+}
+
+TEST_F(BinaryLogTest, FlushesOnlyWhenAsked) {
+    //a stream buffer which counts how often the stream is flushed
+    struct CountingBuffer : public std::stringbuf {
+        uint32_t syncs = 0;
+        int sync() override { ++syncs; return std::stringbuf::sync(); }
+    } counting;
+    std::ostream out(&counting);
+    {
+        BinaryEventLog counted(out);
+        for(uint32_t x = 0; x < 10000; ++x) counted.exec(x, 1, 0, x + 1);
+        EXPECT_GT(counting.str().size(), 0);
+        EXPECT_EQ(counting.syncs, 0);
+    }
+    EXPECT_EQ(counting.syncs, 1);
+    EXPECT_EQ(counting.str().size(), BinaryLog::RECORD_SIZE * 10001);
+}
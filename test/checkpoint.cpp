@@ -0,0 +1,232 @@
+#include <checkpoint.h>
+#include <codec.h>
+#include <game.h>
+
+#include "fixtures.h"
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+
+//Games where threads die part way through, stopped and carried on from a checkpoint
+class CheckpointTest : public ::testing::Test {
+protected:
+    Json config;
+
+    CheckpointTest() {
+        config = baseConfig();
+        config["seed"] = 7;
+        config["max_player_size"] = 1024;
+        config["cycles_per_turn"] = 50;
+        config["max_cycles"] = 100000;
+        config["num_players"] = 8;
+        config["player_settings"] = Json::array();
+        config["warriors"] = Json::array();
+        config["op_cycles"] = { {"NOP", 1}, {"MOV", 60}, {"ADD", 30} };
+        config["log_events"] = "deaths";
+        for(uint32_t x = 0; x < 8; ++x) {
+            const double modifiers[] = {1, 0.5, 1.7, 3.1};
+            config["player_settings"].push_back({
+                {"name", "Warrior_" + std::to_string(x)}, {"cycle_modifer", modifiers[x % 4]},
+                {"max_threads", 1 + x % 3}
+            });
+            config["warriors"].push_back(bomber((uint16_t)(x * 0x1F3B), (uint16_t)(0x0301 + 0x76 * x), 40));
+        }
+    }
+
+    //RAM, scores, and why it ended
+    static std::string result(const Game& game) {
+        std::stringstream out;
+        out << game;
+        for(uint8_t pid = 1; pid <= 8; ++pid) out << ' ' << game.score(pid);
+        out << ' ' << GameEnd_Strings[(uint8_t)game.endReason()];
+        return out.str();
+    }
+
+    std::string play() {
+        Game game(config);
+        std::stringstream log;
+        game.run(log);
+        return result(game);
+    }
+
+    //the checkpoint of a game paused on a cycle
+    std::string pause(uint64_t cycle) {
+        Game game(config);
+        game.pauseAt(cycle);
+        std::stringstream log, image;
+        game.run(log);
+        EXPECT_EQ(game.endReason(), GameEnd::PAUSED);
+        game.checkpoint(image);
+        return image.str();
+    }
+
+    std::string resume(const std::string& image) {
+        Game game((const uint8_t*)image.data(), image.size());
+        std::stringstream log;
+        game.run(log);
+        return result(game);
+    }
+};
+
+TEST_F(CheckpointTest, ResumesExactly) {
+    Game game(config);
+    std::stringstream log;
+    game.run(log);
+    uint32_t best = 0;
+    for(uint8_t pid = 1; pid <= 8; ++pid) best = std::max(best, game.score(pid));
+    EXPECT_GE(best, 1000) << "some thread should be killed";
+
+    const std::string reference = result(game);
+    for(uint64_t cycle : {2, 1000, 17777, 30000})
+        EXPECT_EQ(resume(pause(cycle)), reference) << cycle;
+}
+
+TEST_F(CheckpointTest, ResumesExactlyWithEachEngine) {
+    for(const char* scheduler : {"events", "rounds"}) {
+        config["scheduler"] = scheduler;
+        config["dispatch"] = "switch";
+        const std::string reference = play();
+        EXPECT_EQ(resume(pause(20000)), reference) << scheduler;
+    }
+
+    config["parallel_turns"] = 2;
+    const std::string reference = play();
+    EXPECT_EQ(resume(pause(20000)), reference);
+}
+
+TEST_F(CheckpointTest, ResumesIdling) {
+    //nothing is written until the first bombs land, how long the game has been idle carries over
+    //so it ends on the same cycle
+    config["termination"] = {"idle"};
+    config["idle_cycles"] = 500;
+    const std::string reference = play();
+    EXPECT_EQ(reference.substr(reference.size() - 5), " idle");
+    EXPECT_EQ(resume(pause(400)), reference);
+}
+
+TEST_F(CheckpointTest, PausedGameCarriesOn) {
+    const std::string reference = play();
+    Game game(config);
+    std::stringstream log;
+    uint32_t runs = 0;
+    do {
+        game.pauseAt(++runs * 5000);
+        game.run(log);
+    } while(game.endReason() == GameEnd::PAUSED);
+    EXPECT_GT(runs, 2);
+    EXPECT_EQ(result(game), reference);
+}
+
+TEST_F(CheckpointTest, Layout) {
+    const std::string image = pause(20000);
+    Game game((const uint8_t*)image.data(), image.size());
+    std::stringstream again;
+    game.checkpoint(again);
+    EXPECT_EQ(again.str(), image);
+
+    //RAM and the pids can be read straight out of the image
+    Game original(config);
+    std::stringstream loaded;
+    original.checkpoint(loaded);
+    const std::string start = loaded.str();
+    uint8_t bytes[Memory::SIZE];
+    uint32_t owned = 0;
+    for(uint32_t addr = 0; addr < Memory::SIZE; ++addr) {
+        bytes[addr] = (uint8_t)start[Checkpoint::RAM_OFFSET + addr];
+        owned += start[Checkpoint::OWNERS_OFFSET + addr] != 0;
+    }
+    std::stringstream dump, expected;
+    Codec::hexDump(dump, bytes, Memory::SIZE, 64);
+    dump.unsetf(std::ios::hex);
+    dump.unsetf(std::ios::uppercase);
+    expected << original;
+    EXPECT_EQ(dump.str(), expected.str());
+    EXPECT_GT(owned, 0);
+    EXPECT_EQ(Checkpoint::config((const uint8_t*)start.data(), start.size()), config);
+}
+
+TEST_F(CheckpointTest, InvalidCheckpoint) {
+    const std::string image = pause(1000);
+    auto load = [](std::string image) { Game game((const uint8_t*)image.data(), image.size()); };
+
+    EXPECT_THROW(load(image.substr(0, 100)), std::runtime_error);
+    EXPECT_THROW(load(image.substr(0, image.size() - 1)), std::runtime_error);
+
+    std::string bad = image;
+    bad[0] = 'X';
+    EXPECT_THROW(load(bad), std::runtime_error);
+
+    bad = image;
+    bad[4] = Checkpoint::VERSION + 1;
+    EXPECT_THROW(load(bad), std::runtime_error);
+
+    bad = image;
+    bad[Checkpoint::OWNERS_OFFSET] = 9;
+    EXPECT_THROW(load(bad), std::runtime_error);
+}
+
+TEST_F(CheckpointTest, ForksCarryOnExactly) {
+    for(const char* engine : {"events", "rounds", "parallel"}) {
+        config["scheduler"] = engine == std::string("rounds") ? "rounds" : "events";
+        if(engine == std::string("parallel")) config["parallel_turns"] = 2;
+        const std::string reference = play();
+
+        Game game(config);
+        std::stringstream log, image;
+        game.pauseAt(15000);
+        game.run(log);
+        game.checkpoint(image);
+
+        //every fork is in the same state as the game and plays out on its own, leaving the game as it was
+        Game* forks[4];
+        for(Game*& fork : forks) fork = game.fork();
+        for(Game* fork : forks) {
+            std::stringstream fork_image;
+            fork->checkpoint(fork_image);
+            EXPECT_EQ(fork_image.str(), image.str()) << engine;
+            fork->pauseAt(UINT64_MAX);
+            fork->run(log);
+            EXPECT_EQ(result(*fork), reference) << engine;
+        }
+        std::stringstream after;
+        game.checkpoint(after);
+        EXPECT_EQ(after.str(), image.str()) << engine;
+
+        game.pauseAt(UINT64_MAX);
+        game.run(log);
+        EXPECT_EQ(result(game), reference) << engine;
+        for(Game* fork : forks) delete fork;
+    }
+}
+
+TEST_F(CheckpointTest, ThreadsCarryOnExactly) {
+    //every player starts with all its threads, so the checkpoint holds each player's queue part way round,
+    //threads charged for turns they have not caught up on, and flags not yet worked out
+    for(const char* engine : {"events", "rounds", "parallel"}) {
+        config["scheduler"] = engine == std::string("rounds") ? "rounds" : "events";
+        if(engine == std::string("parallel")) config["parallel_turns"] = 2;
+        const std::string start = withThreads(config, 8, 6);
+        const std::string reference = resume(start);
+
+        for(uint64_t cycle : {2, 1000, 17777}) {
+            Game game((const uint8_t*)start.data(), start.size());
+            std::stringstream log, image;
+            game.pauseAt(cycle);
+            game.run(log);
+            ASSERT_EQ(game.endReason(), GameEnd::PAUSED) << engine;
+            game.checkpoint(image);
+            EXPECT_EQ(resume(image.str()), reference) << engine << ' ' << cycle;
+
+            Game* fork = game.fork();
+            fork->pauseAt(UINT64_MAX);
+            fork->run(log);
+            EXPECT_EQ(result(*fork), reference) << engine << ' ' << cycle;
+            delete fork;
+
+            game.pauseAt(UINT64_MAX);
+            game.run(log);
+            EXPECT_EQ(result(game), reference) << engine << ' ' << cycle;
+        }
+    }
+}
@@ -0,0 +1,79 @@
+#include <codec.h>
+
+#include "gtest/gtest.h"
+
+#include <base.hpp>
+
+#include <cstdio>
+#include <random>
+#include <sstream>
+
+
+class CodecTest : public ::testing::Test {
+protected:
+    std::default_random_engine generator;
+
+    std::string randomBytes(size_t size) {
+        std::string bytes(size, '\0');
+        for(char& c : bytes) c = (char)generator();
+        return bytes;
+    }
+};
+
+TEST_F(CodecTest, Hex) {
+    //every length up to a few vectors so the SIMD loops and the scalar tail are all covered
+    for(size_t size = 0; size < 100; ++size) {
+        const std::string bytes = randomBytes(size);
+        std::string expected;
+        char buffer[3];
+        for(char c : bytes) {
+            snprintf(buffer, 3, "%02X", (uint8_t)c);
+            expected += buffer;
+        }
+
+        std::string actual(2 * size, '\0');
+        Codec::toHex((const uint8_t*)bytes.data(), size, &actual[0]);
+        EXPECT_EQ(actual, expected);
+    }
+}
+
+TEST_F(CodecTest, HexDump) {
+    const std::string bytes = randomBytes(0x10000);
+    std::stringstream expected, actual;
+    char buffer[3];
+    for(uint32_t x = 0; x < bytes.size(); ++x) {
+        snprintf(buffer, 3, "%02X", (uint8_t)bytes[x]);
+        expected << buffer << ((x + 1) % 64 == 0 ? '\n' : ' ');
+    }
+
+    Codec::hexDump(actual, (const uint8_t*)bytes.data(), bytes.size());
+    EXPECT_EQ(actual.str(), expected.str());
+
+    std::stringstream rows;
+    Codec::hexDump(rows, (const uint8_t*)"\x01\xAB\xFF", 3, 2);
+    EXPECT_EQ(rows.str(), "01 AB\nFF ");
+}
+
+TEST_F(CodecTest, Base64) {
+    for(size_t size = 0; size < 200; ++size) {
+        const std::string bytes = randomBytes(size);
+        const std::string encoded = Codec::base64Encode((const uint8_t*)bytes.data(), size);
+        EXPECT_EQ(encoded, base64::encode(bytes));
+        EXPECT_EQ(Codec::base64Decode(encoded), bytes);
+    }
+}
+
+TEST_F(CodecTest, Base64Invalid) {
+    //decoding stops at the first character outside the alphabet, wherever it is
+    const std::string encoded = base64::encode(randomBytes(300));
+    for(size_t x = 0; x < encoded.size(); x += 7) {
+        for(char bad : {'=', '-', '\n', '\x80', '\0'}) {
+            std::string text = encoded;
+            text[x] = bad;
+            EXPECT_EQ(Codec::base64Decode(text), base64::decode(text));
+        }
+    }
+    EXPECT_EQ(Codec::base64Decode(""), "");
+    EXPECT_EQ(Codec::base64Decode("Q"), base64::decode("Q"));
+    EXPECT_EQ(Codec::base64Decode("QQ"), base64::decode("QQ"));
+}
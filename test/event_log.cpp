@@ -0,0 +1,72 @@
+#include <event_log.h>
+
+#include "gtest/gtest.h"
+
+#include <json.hpp>
+#include <sstream>
+
+using Json = nlohmann::json;
+
+
+//Writes events to a JsonEventLog and the same events with nlohmann::json, which it must match
+class JsonEventLogTest : public ::testing::Test {
+protected:
+    std::stringstream actual, expected;
+    JsonEventLog* log;
+
+    JsonEventLogTest() : log(new JsonEventLog(actual)) {}
+    ~JsonEventLogTest() { delete log; }
+
+    void init(uint64_t cycle, const std::vector<uint16_t>& starts) {
+        log->init(cycle, starts);
+        Json json = { {"type", "init"}, {"cycle", cycle} };
+        for(uint16_t start : starts) json["starts"].push_back(start);
+        expected << json;
+    }
+    void exec(uint64_t cycle, uint8_t pid, uint16_t ip, uint64_t end) {
+        log->exec(cycle, pid, ip, end);
+        expected << Json({ {"type", "exec"}, {"cycle", cycle}, {"pid", pid}, {"ins", ip}, {"end", end} });
+    }
+    void stall(uint64_t cycle, uint8_t pid, uint16_t ip) {
+        log->stall(cycle, pid, ip);
+        expected << Json({ {"type", "exec"}, {"cycle", cycle}, {"pid", pid}, {"ins", ip} });
+    }
+    void fault(uint64_t cycle, uint8_t pid, uint16_t ip, Fault f) {
+        log->fault(cycle, pid, ip, f);
+        expected << Json({ {"type", "exec"}, {"cycle", cycle}, {"pid", pid}, {"ins", ip},
+                           {"error", FaultToString(f)} });
+    }
+
+    //Everything written so far
+    std::string dump() {
+        log->flush();
+        return actual.str();
+    }
+};
+
+TEST_F(JsonEventLogTest, MatchesJson) {
+    init(0, {0x1000, 0xF000, 0});
+    init(7, {});
+    exec(1, 1, 0x1000, 3);
+    exec(9, 10, 0, 10);
+    exec(99, 255, 0xFFFF, 100);
+    stall(100, 2, 0xF002);
+    for(uint8_t f = 0; f < NUM_FAULTS; ++f) fault(101 + f, 1, 0x1234, (Fault)f);
+    exec(UINT64_MAX - 1, 1, 12345, UINT64_MAX);
+    EXPECT_EQ(dump(), expected.str());
+}
+
+TEST_F(JsonEventLogTest, LargerThanBuffer) {
+    std::vector<uint16_t> starts;
+    for(uint32_t x = 0; x < 0x4000; ++x) starts.push_back((uint16_t)(x * 7));
+    init(0, starts);
+    for(uint32_t x = 0; x < 10000; ++x) exec(x * 1000, (uint8_t)x, (uint16_t)(x * 13), x * 1000 + 999);
+    EXPECT_EQ(dump(), expected.str());
+}
+
+TEST_F(JsonEventLogTest, WrittenOnDestruction) {
+    exec(1, 1, 2, 3);
+    delete log;
+    log = new JsonEventLog(actual);
+    EXPECT_EQ(actual.str(), expected.str());
+}
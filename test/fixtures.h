@@ -0,0 +1,107 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <json.hpp>
+using Json = nlohmann::json;
+
+#include <checkpoint.h>
+#include <codec.h>
+#include <game.h>
+#include <instruction.h>
+
+#include <sstream>
+
+
+//The config of a game between two copies of a warrior which only reads, tests override the keys they care about
+inline Json baseConfig() {
+    return {
+        {"seed", 42},
+        {"max_player_size", 4096},
+        {"cycles_per_turn", 100},
+        {"max_cycles", 20000},
+        {"ram_access_cycles", 8},
+        {"ram_double_access_penalty", 8},
+        {"score_for_killing_thread", 1000},
+        {"score_for_killing_process", 1000000},
+        {"score_for_owning_ram", 0.1},
+        {"num_players", 2},
+        {"player_settings", {
+            { {"name", "Joe"}, {"cycle_modifer", 1}, {"max_threads", 3} },
+            { {"name", "Bob"}, {"cycle_modifer", 0.5}, {"max_threads", 3} }
+        }},
+        {"warriors", {"CKb/3gAAEHYJ5//8UAn/9EYN//Q=", "CKb/3gAAEHYJ5//8UAn/9EYN//Q="}},
+        {"op_cycles", { {"NOP", 1}, {"MOV", 2}, {"ADD", 4}, {"TEST", 2}, {"INC", 2} }},
+        {"dispatch", "threaded"}
+    };
+}
+
+//A warrior which fills AX with an invalid instruction and writes it count times every stride bytes from start
+inline std::string bomber(uint16_t start, uint16_t stride, uint32_t count = 64) {
+    Memory ram;
+    uint16_t size = 0;
+    auto ins = [&ram, &size](OPCode op, Location arg1, Location arg2) {
+        Instruction::constructInstruction(ram, size, op, AccessMode::DIRECT, AccessMode::DIRECT, arg1, arg2);
+        size += 2;
+    };
+    auto imd = [&ram, &size](uint16_t value) {
+        ram[size++] = (uint8_t)(value >> 8);
+        ram[size++] = (uint8_t)value;
+    };
+
+    ins(OPCode::MOV, Location::AX, Location::IMD); imd(0xFFFF);
+    ins(OPCode::MOV, Location::BX, Location::IMD); imd(start);
+    for(uint32_t x = 0; x < count; ++x) {
+        ins(OPCode::ADD, Location::BX, Location::IMD); imd(stride);
+        ins(OPCode::MOV, Location::PBX, Location::AX);
+    }
+
+    std::vector<uint8_t> program(size);
+    ram.copyBytes(0, size, program.data());
+    return Codec::base64Encode(program.data(), size);
+}
+
+//A checkpoint of the game a config starts with each player given every thread it may have. Warriors have no
+// instruction which starts a thread, so the others are copies of the first which start offset, offset + spacing,
+// and so on bytes further into the warrior, part way through an instruction, with AX holding an invalid
+// instruction and BX pointing somewhere else
+inline std::string withThreads(const Json& config, uint16_t offset, uint16_t spacing) {
+    Game game(config);
+    std::stringstream out;
+    game.checkpoint(out);
+    const std::string start = out.str();
+    auto get = [&start](size_t at, int bytes) {
+        uint32_t v = 0;
+        for(int x = 0; x < bytes; ++x) v |= (uint32_t)(uint8_t)start[at + x] << (8 * x);
+        return v;
+    };
+    auto set = [](std::string& image, size_t at, uint32_t v, int bytes) {
+        for(int x = 0; x < bytes; ++x) image[at + x] = (char)(uint8_t)(v >> (8 * x));
+    };
+
+    //the players follow the config, each with a thread count and then its one thread
+    size_t from = Checkpoint::CONFIG_OFFSET + get(Checkpoint::CONFIG_SIZE_OFFSET, 4);
+    std::string image = start.substr(0, from);
+    for(uint8_t pid = 1; pid <= (uint8_t)start[Checkpoint::NUM_PLAYERS_OFFSET]; ++pid) {
+        const size_t fields = from + 2 + get(from, 2);
+        const size_t count = fields + Checkpoint::NUM_THREADS_OFFSET;
+        const uint8_t threads = std::max<uint8_t>((uint8_t)start[fields + Checkpoint::MAX_THREADS_OFFSET], 1);
+        image += start.substr(from, count - from);
+        image.push_back((char)threads);
+        const std::string first = start.substr(count + 1, Checkpoint::THREAD_SIZE);
+        const uint16_t ip = (uint16_t)get(count + 1 + Checkpoint::IP_OFFSET, 2);
+        image += first;
+        for(uint8_t t = 1; t < threads; ++t) {
+            std::string thread = first;
+            set(thread, Checkpoint::AX_OFFSET, 0xFFFF, 2);
+            set(thread, Checkpoint::BX_OFFSET, (uint16_t)(ip + t * 0x2F1D), 2);
+            set(thread, Checkpoint::IP_OFFSET, (uint16_t)(ip + offset + (t - 1) * spacing), 2);
+            set(thread, Checkpoint::CYCLES_OFFSET, t * 7u, 4);
+            image += thread;
+        }
+        from = count + 1 + Checkpoint::THREAD_SIZE;
+    }
+    return image;
+}
@@ -0,0 +1,342 @@
+#include <binary_log.h>
+#include <event_log.h>
+#include <game.h>
+
+#include "fixtures.h"
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <thread>
+
+/// Counts the events it is sent
+class CountingEventLog : public EventLog {
+public:
+    uint32_t inits = 0, execs = 0, stalls = 0, faults = 0, turns = 0, turn_instructions = 0, scores = 0, ends = 0;
+    uint64_t end_cycle = 0;
+    GameEnd reason = GameEnd::MAX_CYCLES;
+    uint8_t winner = 0;
+
+    void init(uint64_t cycle, const std::vector<uint16_t>& starts) override { ++inits; }
+    void exec(uint64_t cycle, uint8_t pid, uint16_t ip, uint64_t end) override { ++execs; }
+    void stall(uint64_t cycle, uint8_t pid, uint16_t ip) override { ++stalls; }
+    void fault(uint64_t cycle, uint8_t pid, uint16_t ip, Fault fault) override { ++faults; }
+    void turn(uint64_t cycle, uint64_t end, uint8_t pid, uint32_t count) override {
+        ++turns;
+        turn_instructions += count;
+    }
+    void score(uint64_t cycle, uint8_t pid, uint32_t score) override { ++scores; }
+    void end(uint64_t cycle, GameEnd reason, uint8_t winner) override {
+        ++ends;
+        end_cycle = cycle;
+        this->reason = reason;
+        this->winner = winner;
+    }
+    void skipped(uint64_t cycle, uint64_t end, uint32_t count) override {}
+};
+
+class GameTest : public ::testing::Test {
+protected:
+    Json config;
+
+    GameTest() {
+        config = baseConfig();
+    }
+
+    std::string play(const std::string& dispatch) {
+        config["dispatch"] = dispatch;
+        Game game(config);
+        std::stringstream log;
+        game.run(log);
+        return log.str();
+    }
+
+    CountingEventLog count(const std::string& events) {
+        config["log_format"] = "binary";
+        config["log_events"] = events;
+        std::stringstream binary(play("threaded"));
+        CountingEventLog counts;
+        BinaryLogReader reader(binary);
+        reader.replay(counts);
+        return counts;
+    }
+};
+
+TEST_F(GameTest, Reproducible) {
+    EXPECT_EQ(play("switch"), play("switch"));
+}
+
+TEST_F(GameTest, ThreadedMatchesSwitch) {
+    const std::string reference = play("switch");
+    EXPECT_GT(reference.size(), 1000);
+    EXPECT_EQ(play("threaded"), reference);
+}
+
+TEST_F(GameTest, InvalidDispatch) {
+    EXPECT_THROW(play("indirect"), std::invalid_argument);
+}
+
+TEST_F(GameTest, OptionalKeys) {
+    //the threaded engine is the default
+    const std::string threaded = play("threaded");
+    config.erase("dispatch");
+    Game game(config);
+    std::stringstream log;
+    game.run(log);
+    EXPECT_EQ(log.str(), threaded);
+
+    //without a seed the warriors are placed somewhere different each time
+    config.erase("seed");
+    EXPECT_NO_THROW({
+        Game unseeded(config);
+        unseeded.run(log);
+    });
+}
+
+TEST_F(GameTest, EagerFlagsMatchLazy) {
+    const std::string lazy = play("threaded");
+    config["flags"] = "eager";
+    EXPECT_EQ(play("threaded"), lazy);
+}
+
+TEST_F(GameTest, InvalidFlags) {
+    config["flags"] = "sometimes";
+    EXPECT_THROW(play("threaded"), std::invalid_argument);
+}
+
+TEST_F(GameTest, SettingsArePerGame) {
+    //games with different op cycles give the same logs whether or not another game was
+    // constructed or is running at the same time
+    const std::string slow_reference = play("threaded");
+    Json fast_config = config;
+    fast_config["op_cycles"]["MOV"] = 1;
+    fast_config["op_cycles"]["ADD"] = 1;
+    Game fast(fast_config);
+    std::stringstream fast_log, slow_log;
+    {
+        Game slow(config);
+        std::thread other([&fast, &fast_log]{ fast.run(fast_log); });
+        slow.run(slow_log);
+        other.join();
+    }
+    EXPECT_EQ(slow_log.str(), slow_reference);
+    EXPECT_NE(fast_log.str(), slow_reference);
+
+    config = fast_config;
+    EXPECT_EQ(fast_log.str(), play("threaded"));
+}
+
+TEST_F(GameTest, Reset) {
+    const std::string reference = play("threaded");
+    Game game(config);
+    std::stringstream first, second;
+    game.run(first);
+    config["seed"] = 7;
+    game.reset(config);
+    game.run(second);
+    EXPECT_EQ(first.str(), reference);
+    EXPECT_EQ(second.str(), play("threaded"));
+    EXPECT_NE(second.str(), reference);
+}
+
+TEST_F(GameTest, ThreadedMatchesSwitchAcrossTurns) {
+    //instructions cost more than a turn so most are carried over into the next
+    config["cycles_per_turn"] = 3;
+    const std::string reference = play("switch");
+    EXPECT_EQ(play("threaded"), reference);
+}
+
+TEST_F(GameTest, BinaryLogMatchesJson) {
+    const std::string reference = play("threaded");
+    config["log_format"] = "binary";
+    std::stringstream binary(play("threaded")), json;
+    EXPECT_LT(binary.str().size() * 5, reference.size());
+
+    JsonEventLog out(json);
+    BinaryLogReader reader(binary);
+    reader.replay(out);
+    EXPECT_EQ(json.str(), reference);
+}
+
+TEST_F(GameTest, AsyncLogMatchesSync) {
+    const std::string reference = play("threaded");
+    config["log_async"] = "block";
+    config["log_ring_size"] = 16;
+    EXPECT_EQ(play("threaded"), reference);
+}
+
+TEST_F(GameTest, InvalidLogPolicy) {
+    config["log_async"] = "sometimes";
+    EXPECT_THROW(play("threaded"), std::invalid_argument);
+}
+
+TEST_F(GameTest, LogEvents) {
+    const CountingEventLog full = count("full");
+    EXPECT_EQ(full.inits, 1);
+    EXPECT_GT(full.execs, 1000);
+    EXPECT_EQ(full.turns, 0);
+    EXPECT_EQ(full.scores, 2);
+    EXPECT_EQ(full.ends, 1);
+
+    const CountingEventLog turns = count("turns");
+    EXPECT_EQ(turns.inits, 1);
+    EXPECT_EQ(turns.execs + turns.stalls, 0);
+    EXPECT_GT(turns.turns, 0);
+    EXPECT_EQ(turns.turn_instructions, full.execs);
+    EXPECT_EQ(turns.faults, full.faults);
+    EXPECT_EQ(turns.scores, 2);
+    EXPECT_EQ(turns.ends, 1);
+
+    const CountingEventLog deaths = count("deaths");
+    EXPECT_EQ(deaths.inits + deaths.execs + deaths.stalls + deaths.turns, 0);
+    EXPECT_EQ(deaths.faults, full.faults);
+    EXPECT_EQ(deaths.scores, 2);
+    EXPECT_EQ(deaths.ends, 1);
+}
+
+TEST_F(GameTest, NoLogEvents) {
+    config["log_events"] = "none";
+    EXPECT_EQ(play("threaded"), "");
+}
+
+TEST_F(GameTest, ThreadedMatchesSwitchForLogEvents) {
+    for(const char* events : {"turns", "deaths"}) {
+        config["log_events"] = events;
+        const std::string reference = play("switch");
+        EXPECT_EQ(play("threaded"), reference);
+    }
+}
+
+TEST_F(GameTest, InvalidLogEvents) {
+    config["log_events"] = "some";
+    EXPECT_THROW(play("threaded"), std::invalid_argument);
+}
+
+TEST_F(GameTest, DeadPlayerIsSkipped) {
+    //player 1 dies long before max_cycles, player 2 keeps taking turns until it dies too
+    config["max_cycles"] = 200000;
+    const CountingEventLog counts = count("deaths");
+    EXPECT_EQ(counts.reason, GameEnd::NO_PLAYERS);
+    EXPECT_LT(counts.end_cycle, 200000 - 100);
+    EXPECT_EQ(counts.winner, 2);
+}
+
+TEST_F(GameTest, LastStanding) {
+    config["max_cycles"] = 200000;
+    const CountingEventLog all = count("deaths");
+    config["termination"] = {"last_standing"};
+    const CountingEventLog counts = count("deaths");
+    EXPECT_EQ(counts.reason, GameEnd::LAST_STANDING);
+    EXPECT_LT(counts.end_cycle, all.end_cycle);
+    EXPECT_LT(counts.faults, all.faults);
+    EXPECT_EQ(counts.winner, 2);
+}
+
+TEST_F(GameTest, ScoreLead) {
+    config["max_cycles"] = 200000;
+    config["termination"] = {"last_standing"};
+    const CountingEventLog standing = count("deaths");
+    config["termination"] = {"score_lead"};
+    const CountingEventLog counts = count("deaths");
+    EXPECT_EQ(counts.reason, GameEnd::SCORE_LEAD);
+    EXPECT_LE(counts.end_cycle, standing.end_cycle);
+    EXPECT_EQ(counts.winner, 2);
+
+    //nobody can lead when kills are worth nothing
+    config["score_for_killing_thread"] = 0;
+    config["score_for_killing_process"] = 0;
+    EXPECT_NE(count("deaths").reason, GameEnd::SCORE_LEAD);
+}
+
+TEST_F(GameTest, Idle) {
+    config["termination"] = {"idle"};
+    config["idle_cycles"] = 0;
+    EXPECT_THROW(play("threaded"), std::invalid_argument);
+    config["idle_cycles"] = 1000;
+    const CountingEventLog counts = count("turns");
+    EXPECT_EQ(counts.reason, GameEnd::IDLE);
+    EXPECT_LT(counts.end_cycle, 20000 - 200);
+}
+
+TEST_F(GameTest, TerminationsMatchSpeculative) {
+    config["max_cycles"] = 200000;
+    config["idle_cycles"] = 1000;
+    for(const Json& terminations : {Json{"last_standing", "score_lead"}, Json{"idle"}}) {
+        config["termination"] = terminations;
+        config["parallel_turns"] = 0;
+        const std::string reference = play("threaded");
+        config["parallel_turns"] = 2;
+        EXPECT_EQ(play("threaded"), reference) << terminations;
+    }
+}
+
+TEST_F(GameTest, InvalidTermination) {
+    config["termination"] = "last_standing";
+    EXPECT_THROW(play("threaded"), std::invalid_argument);
+    config["termination"] = {"last_standing", 1};
+    EXPECT_THROW(play("threaded"), std::invalid_argument);
+    config["termination"] = {"never"};
+    EXPECT_THROW(play("threaded"), std::invalid_argument);
+    //ways a game ends which are not chosen by the config
+    for(const char* end : {"max_cycles", "no_players", "repetition", "paused"}) {
+        config["termination"] = {"idle", end};
+        config["idle_cycles"] = 1000;
+        EXPECT_THROW(play("threaded"), std::invalid_argument) << end;
+    }
+}
+
+TEST_F(GameTest, WrongTypes) {
+    //values of the wrong type are reported like any other invalid value rather than as json errors
+    const Json reference = config;
+    auto load = [this]() { Game game(config); };
+    for(const char* key : {"dispatch", "flags", "log_format", "log_async", "log_events", "scheduler"}) {
+        config = reference;
+        config[key] = 5;
+        EXPECT_THROW(load(), std::invalid_argument) << key;
+    }
+    for(const char* key : {"seed", "max_player_size", "num_players", "cycles_per_turn"}) {
+        config = reference;
+        config[key] = "seven";
+        EXPECT_THROW(load(), std::invalid_argument) << key;
+    }
+    config = reference;
+    config["warriors"] = {5, 6};
+    EXPECT_THROW(load(), std::invalid_argument);
+}
+
+TEST_F(GameTest, SwpWithIp) {
+    //the IP can only be the source, and SWP writes its source first, so SWP [AX], IP dies without
+    //writing [AX] as it did when the write to the IP threw
+    Memory ram;
+    Instruction::constructInstruction(ram, 0, OPCode::MOV, AccessMode::DIRECT, AccessMode::DIRECT,
+                                      Location::AX, Location::IMD);
+    ram[2] = 0x80;
+    ram[3] = 0x00;
+    Instruction::constructInstruction(ram, 4, OPCode::SWP, AccessMode::DIRECT, AccessMode::DIRECT,
+                                      Location::PAX, Location::IP);
+    uint8_t program[6];
+    ram.copyBytes(0, 6, program);
+    config["num_players"] = 1;
+    config["warriors"] = {Codec::base64Encode(program, 6)};
+    for(const char* dispatch : {"switch", "threaded"}) {
+        config["dispatch"] = dispatch;
+        Game game(config);
+        std::stringstream log, image;
+        game.run(log);
+        EXPECT_EQ(game.endReason(), GameEnd::NO_PLAYERS) << dispatch;
+        EXPECT_NE(log.str().find(Fault_Strings[(uint8_t)Fault::READ_ONLY]), std::string::npos) << dispatch;
+        game.checkpoint(image);
+        const std::string bytes = image.str();
+        EXPECT_EQ(bytes[Checkpoint::RAM_OFFSET + 0x8000], 0) << dispatch;
+        EXPECT_EQ(bytes[Checkpoint::RAM_OFFSET + 0x8001], 0) << dispatch;
+        EXPECT_EQ(bytes[Checkpoint::OWNERS_OFFSET + 0x8000], 0) << dispatch;
+    }
+}
+
+TEST_F(GameTest, MaxCyclesBelowOneRound) {
+    //there is no time for a round when max_cycles is less than a turn for every player
+    config["max_cycles"] = 150;
+    const CountingEventLog counts = count("full");
+    EXPECT_EQ(counts.execs, 0);
+    EXPECT_EQ(counts.reason, GameEnd::MAX_CYCLES);
+    EXPECT_EQ(counts.end_cycle, 1);
+}
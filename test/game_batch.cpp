@@ -0,0 +1,85 @@
+#include <game.h>
+#include <game_batch.h>
+
+#include "fixtures.h"
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+
+class GameBatchTest : public ::testing::Test {
+protected:
+    Json config;
+    std::vector<Json> games;
+
+    GameBatchTest() {
+        config = baseConfig();
+        for(uint32_t seed = 0; seed < 6; ++seed) games.push_back({{"seed", seed}});
+        games[3]["warriors"] = Json::array({"AAAAAAAA", "CKb/3gAA"});
+        games[4]["player_settings"] = config["player_settings"];
+        games[4]["player_settings"][0]["max_threads"] = 1;
+    }
+
+    //the scores of a game constructed and run alone
+    std::vector<uint32_t> alone(const Json& changes) {
+        Json game_config = config;
+        for(auto itr = changes.begin(); itr != changes.end(); ++itr) game_config[itr.key()] = itr.value();
+        Game game(game_config);
+        std::stringstream log;
+        game.run(log);
+        return {game.score(1), game.score(2)};
+    }
+};
+
+TEST_F(GameBatchTest, MatchesGamesAlone) {
+    GameBatch batch(config);
+    const std::vector<GameBatch::Result> results = batch.run(games);
+    ASSERT_EQ(results.size(), games.size());
+    for(size_t x = 0; x < games.size(); ++x) {
+        SCOPED_TRACE(x);
+        EXPECT_TRUE(results[x].error.empty());
+        EXPECT_EQ(results[x].scores, alone(games[x]));
+    }
+}
+
+TEST_F(GameBatchTest, Errors) {
+    //a game which cannot be loaded does not affect the ones after it
+    games[1]["warriors"] = Json::array({"", ""});
+    GameBatch batch(config);
+    const std::vector<GameBatch::Result> results = batch.run(games);
+    EXPECT_FALSE(results[1].error.empty());
+    EXPECT_TRUE(results[1].scores.empty());
+    EXPECT_EQ(results[2].scores, alone(games[2]));
+
+    //including the first game
+    GameBatch first(config);
+    EXPECT_FALSE(first.play(games[1]).error.empty());
+    EXPECT_EQ(first.play(games[0]).scores, alone(games[0]));
+
+    //errors other than invalid arguments are kept too
+    games[1] = {{"op_cycles", {{"MOV", "slow"}}}};
+    const std::vector<GameBatch::Result> others = batch.run(games);
+    EXPECT_FALSE(others[1].error.empty());
+    EXPECT_TRUE(others[1].scores.empty());
+    EXPECT_EQ(others[2].scores, alone(games[2]));
+}
+
+TEST_F(GameBatchTest, OtherSettings) {
+    //settings a game is constructed with do not carry over to the games after it
+    const Json same_seed = {{"seed", 3}};
+    games.insert(games.begin(), Json{{"seed", 3}, {"max_cycles", 3000}});
+    games.push_back(same_seed);
+    games.push_back({{"seed", 3}, {"max_cycles", 9000}, {"op_cycles", {{"NOP", 1}, {"MOV", 1}, {"ADD", 1}}}});
+    ASSERT_NE(alone(games.front()), alone(same_seed));
+
+    GameBatch batch(config);
+    const std::vector<GameBatch::Result> results = batch.run(games);
+    for(size_t x = 0; x < games.size(); ++x) {
+        SCOPED_TRACE(x);
+        EXPECT_TRUE(results[x].error.empty());
+        EXPECT_EQ(results[x].scores, alone(games[x]));
+    }
+
+    games[1]["num_players"] = 3;
+    EXPECT_FALSE(batch.play(games[1]).error.empty());
+}
@@ -0,0 +1,52 @@
+#include <game_settings.h>
+
+#include "gtest/gtest.h"
+
+
+class GameSettingsTest : public ::testing::Test {
+protected:
+    Json config;
+
+    GameSettingsTest() {
+        config = {
+            {"cycles_per_turn", 100},
+            {"max_cycles", 20000},
+            {"ram_access_cycles", 8},
+            {"ram_double_access_penalty", 4},
+            {"score_for_killing_thread", 1000},
+            {"score_for_killing_process", 1000000},
+            {"score_for_owning_ram", 0.5},
+            {"op_cycles", { {"MOV", 2}, {"IDIV", 6} }}
+        };
+    }
+};
+
+TEST_F(GameSettingsTest, Read) {
+    const GameSettings settings(config);
+    EXPECT_EQ(settings.cycles_per_turn, 100);
+    EXPECT_EQ(settings.max_cycles, 20000);
+    EXPECT_EQ(settings.ram_access_cycles, 8);
+    EXPECT_EQ(settings.ram_double_access_penalty, 4);
+    EXPECT_EQ(settings.score_for_killing_thread, 1000);
+    EXPECT_EQ(settings.score_for_killing_process, 1000000);
+    EXPECT_EQ(settings.score_for_owning_ram, 0.5f);
+    EXPECT_EQ(settings.opCycles(OPCode::MOV), 2);
+    EXPECT_EQ(settings.opCycles(OPCode::IDIV), 6);
+    EXPECT_EQ(settings.opCycles(OPCode::ADD), 1); //not listed
+}
+
+TEST_F(GameSettingsTest, Independent) {
+    const GameSettings first(config);
+    config["op_cycles"]["MOV"] = 9;
+    const GameSettings second(config);
+    EXPECT_EQ(first.opCycles(OPCode::MOV), 2);
+    EXPECT_EQ(second.opCycles(OPCode::MOV), 9);
+}
+
+TEST_F(GameSettingsTest, Invalid) {
+    config["cycles_per_turn"] = 0;
+    EXPECT_THROW(GameSettings{config}, std::invalid_argument);
+    config["cycles_per_turn"] = 100;
+    config["op_cycles"]["FOO"] = 1;
+    EXPECT_THROW(GameSettings{config}, std::invalid_argument);
+}
@@ -0,0 +1,117 @@
+#include <argument.h>
+#include <instruction.h>
+#include <instruction_cache.h>
+#include <thread.h>
+
+#include "gtest/gtest.h"
+
+class InstructionCacheTest : public ::testing::Test {
+protected:
+    Memory ram = {
+            0x00, 0x00, 0x00, 0x04,
+            0x03, 0x11, 0x22, 0x07,
+            0x12, 0x53, 0xC3, 0x32,
+            0x8F, 0x06, 0x02, 0x02
+    };
+    Thread thread;
+    GameSettings settings;
+    InstructionCache cache;
+
+    InstructionCacheTest() : cache(settings) {
+        settings.ram_access_cycles = 8;
+        settings.ram_double_access_penalty = 4;
+        thread.ax = 5;
+        thread.bx = 23;
+        thread.cx = 623;
+    }
+};
+
+TEST_F(InstructionCacheTest, Decode) {
+    Instruction::constructInstruction(ram, 0, OPCode::ADD, AccessMode::DIRECT, AccessMode::RELATIVE,
+                                      Location::PAX, Location::PIMD);
+    const DecodedInstruction& ins = cache.fetch(ram, 0);
+    EXPECT_TRUE(cache.isCached(0));
+    EXPECT_EQ(ins.opcode, Instruction::getOPCode(ram, 0));
+    EXPECT_EQ(ins.size, Instruction::getSize(ram, 0));
+    EXPECT_EQ(ins.arg1.loc, Location::PAX);
+    EXPECT_EQ(ins.arg2.loc, Location::PIMD);
+    EXPECT_EQ(ins.arg2.mode, AccessMode::RELATIVE);
+    EXPECT_EQ(ins.arg2.addr, 0x0004 + 4); //the immediate plus the instruction size
+    EXPECT_EQ(ins.cycles, settings.opCycles(ins.opcode) + 8 + 8 + 4);
+
+    //Arguments from the cache must resolve the same as ones decoded from RAM
+    Argument cached1(thread, ram, ins, 1, &cache), cached2(thread, ram, ins, 2, &cache);
+    Argument arg1(thread, ram, 1), arg2(thread, ram, 2);
+    EXPECT_EQ(cached1.read(), arg1.read());
+    EXPECT_EQ(cached2.read(), arg2.read());
+}
+
+TEST_F(InstructionCacheTest, Cached) {
+    Instruction::constructInstruction(ram, 0, OPCode::MOV, AccessMode::DIRECT, AccessMode::DIRECT,
+                                      Location::AX, Location::IMD);
+    const DecodedInstruction& ins = cache.fetch(ram, 0);
+    EXPECT_EQ(&ins, &cache.fetch(ram, 0));
+
+    //writes which do not go through an Argument are not seen until the cache is cleared
+    ram[1] = RouteToInt(Location::BX, Location::CX);
+    EXPECT_EQ(cache.fetch(ram, 0).arg1.loc, Location::AX);
+    cache.clear();
+    EXPECT_FALSE(cache.isCached(0));
+    EXPECT_EQ(cache.fetch(ram, 0).arg1.loc, Location::BX);
+}
+
+TEST_F(InstructionCacheTest, InvalidateOnWrite) {
+    Instruction::constructInstruction(ram, 0, OPCode::MOV, AccessMode::DIRECT, AccessMode::DIRECT,
+                                      Location::AX, Location::IMD);
+    Instruction::constructInstruction(ram, 8, OPCode::MOV, AccessMode::DIRECT, AccessMode::DIRECT,
+                                      Location::BX, Location::CX);
+    EXPECT_EQ(cache.fetch(ram, 0).arg2.addr, 2);
+    cache.fetch(ram, 8);
+    EXPECT_TRUE(cache.isCached(8));
+
+    //overwrite the route of the instruction at 0 with [AX] <- BL
+    thread.ax = 1;
+    thread.bx = RouteToInt(Location::CX, Location::AL);
+    Instruction::constructInstruction(ram, 0x100, OPCode::MOV, AccessMode::DIRECT, AccessMode::DIRECT,
+                                      Location::PAX, Location::BL);
+    {
+        thread.ip = 0x100;
+        Argument arg1(thread, ram, cache.fetch(ram, 0x100), 1, &cache);
+        Argument arg2(thread, ram, cache.fetch(ram, 0x100), 2, &cache);
+        arg1.write(arg2);
+    }
+    EXPECT_FALSE(cache.isCached(0));
+    EXPECT_TRUE(cache.isCached(8));
+
+    EXPECT_EQ(cache.fetch(ram, 8).arg1.loc, Location::BX);
+    const DecodedInstruction& ins = cache.fetch(ram, 0);
+    EXPECT_EQ(ins.arg1.loc, Location::CX);
+    EXPECT_EQ(ins.arg2.loc, Location::AL);
+    EXPECT_EQ(ins.size, 2);
+}
+
+TEST_F(InstructionCacheTest, InvalidateImd) {
+    Instruction::constructInstruction(ram, 0xFFFE, OPCode::MOV, AccessMode::DIRECT, AccessMode::DIRECT,
+                                      Location::PIMD, Location::IMD);
+    ram[0x0000] = 0x00; ram[0x0001] = 0x10; //first immediate wraps to the start of RAM
+    EXPECT_EQ(cache.fetch(ram, 0xFFFE).arg1.addr, 0x0010);
+
+    cache.invalidate(0x0001);
+    ram[0x0001] = 0x20;
+    EXPECT_EQ(cache.fetch(ram, 0xFFFE).arg1.addr, 0x0020);
+}
+
+TEST_F(InstructionCacheTest, Faults) {
+    Instruction::constructInstruction(ram, 0, OPCode::SWP, AccessMode::DIRECT, AccessMode::DIRECT,
+                                      Location::AX, Location::IP);
+    EXPECT_EQ(cache.fetch(ram, 0).fault, Fault::READ_ONLY);
+
+    Instruction::constructInstruction(ram, 8, OPCode::MOV, AccessMode::DIRECT, AccessMode::DIRECT,
+                                      Location::AX, Location::IP);
+    EXPECT_EQ(cache.fetch(ram, 8).fault, Fault::NONE);
+
+    Instruction::constructInstruction(ram, 16, OPCode::MOV, AccessMode::DIRECT, AccessMode::DIRECT,
+                                      Location::AX, Location::BX);
+    ram[17] = (ram[17] & 0xF0) | 0x0F; //no destination is encoded as 15
+    EXPECT_EQ(cache.fetch(ram, 16).fault, Fault::INVALID_LOCATION);
+}
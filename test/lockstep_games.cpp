@@ -0,0 +1,204 @@
+#include <game.h>
+#include <lockstep_games.h>
+
+#include "fixtures.h"
+#include "gtest/gtest.h"
+
+#include <functional>
+#include <memory>
+#include <random>
+#include <sstream>
+
+
+//Opcodes which are run for every lane at once when their destination is AX, BX, or CX
+static const OPCode COMMON[] = {OPCode::MOV, OPCode::ADD, OPCode::SUB, OPCode::AND, OPCode::OR, OPCode::XOR,
+                                OPCode::CMP, OPCode::TEST};
+
+//Every location which can be written
+static const Location DESTINATIONS[] = {Location::AL, Location::AH, Location::BL, Location::BH, Location::CL,
+                                        Location::CH, Location::AX, Location::BX, Location::CX, Location::PAX,
+                                        Location::PBX, Location::PCX, Location::PIMD};
+
+//A warrior of instructions with random arguments and immediates. Half of them are one of the common opcodes into
+// AX, BX, or CX and the rest are any opcode into any location which can be written.
+static std::string randomWarrior(std::default_random_engine& generator, uint32_t count) {
+    Memory ram;
+    uint16_t size = 0;
+    for(uint32_t x = 0; x < count; ++x) {
+        const bool common = generator() % 2 != 0;
+        const OPCode op = common ? COMMON[generator() % 8] : (OPCode)(generator() % (uint8_t)OPCode::NONE);
+        const Location arg1 = common ? (Location)((uint8_t)Location::AX + generator() % 3) : DESTINATIONS[generator() % 13];
+        const Location arg2 = (Location)(generator() % (uint8_t)Location::NONE);
+        Instruction::constructInstruction(ram, size, op, (AccessMode)(generator() % 2), (AccessMode)(generator() % 2),
+                                          arg1, arg2);
+        const uint8_t ins_size = DecodedInstruction(ram, size).size;
+        for(uint8_t byte = 2; byte < ins_size; ++byte) ram[size + byte] = (uint8_t)generator();
+        size += ins_size;
+    }
+
+    std::vector<uint8_t> program(size);
+    ram.copyBytes(0, size, program.data());
+    return Codec::base64Encode(program.data(), size);
+}
+
+
+class LockstepGamesTest : public ::testing::Test {
+protected:
+    Json config;
+    std::default_random_engine generator;
+
+    LockstepGamesTest() {
+        config = baseConfig();
+        //lazy flags are left pending in a checkpoint, but are always computed in lockstep
+        config["flags"] = "eager";
+        //every turn is played as with the rounds scheduler, the events one can catch up a thread's leftover
+        // cycles differently when a game ends early
+        config["scheduler"] = "rounds";
+    }
+
+    //Configs of games between random warriors, each with its own seed
+    std::vector<Json> randomGames(uint32_t count) {
+        std::vector<Json> games;
+        for(uint32_t x = 0; x < count; ++x) {
+            Json game = config;
+            game["seed"] = x;
+            game["warriors"] = {randomWarrior(generator, 32 + x % 64), randomWarrior(generator, 64)};
+            games.push_back(game);
+        }
+        return games;
+    }
+
+    //The checkpoint of a game, which has everything that carries on to the next run
+    static std::string state(const Game& game) {
+        std::stringstream out;
+        game.checkpoint(out);
+        return out.str();
+    }
+
+    //Runs count games made by make in lockstep and the same games alone, then compares them with same
+    void expectSame(size_t count, const std::function<Game*(size_t)>& make,
+                    const std::function<void(const Game&, const Game&)>& same) {
+        std::vector<std::unique_ptr<Game>> games;
+        std::vector<Game*> lanes;
+        for(size_t x = 0; x < count; ++x) {
+            games.emplace_back(make(x));
+            lanes.push_back(games.back().get());
+        }
+        LockstepGames lockstep;
+        lockstep.run(lanes.data(), lanes.size());
+
+        for(size_t x = 0; x < count; ++x) {
+            SCOPED_TRACE(x);
+            std::unique_ptr<Game> alone(make(x));
+            std::stringstream log;
+            alone->run(log);
+            EXPECT_EQ(games[x]->endReason(), alone->endReason());
+            same(*games[x], *alone);
+        }
+    }
+
+    //Runs the games from configs in lockstep and alone and checks they end up in exactly the same state
+    void expectSame(const std::vector<Json>& configs) {
+        expectSame(configs.size(), [&configs](size_t x) { return new Game(configs[x]); },
+                   [](const Game& lockstep, const Game& alone) { EXPECT_EQ(state(lockstep), state(alone)); });
+    }
+};
+
+TEST_F(LockstepGamesTest, MatchesGamesAlone) {
+    //more games than lanes, so lanes take new games as theirs end
+    expectSame(randomGames(3 * LockstepGames::LANES + 1));
+
+    //including games which fill RAM, and one which is over before it starts
+    std::vector<Json> games = randomGames(LockstepGames::LANES);
+    games[0]["warriors"] = {bomber(0x100, 0x107), bomber(0x8000, 0x20B)};
+    games[1]["warriors"] = {bomber(0x100, 0x107), config["warriors"][1]};
+    games[2]["max_cycles"] = 1;
+    games[3]["player_settings"][1]["cycle_modifer"] = 3;
+    expectSame(games);
+}
+
+TEST_F(LockstepGamesTest, MorePlayers) {
+    std::vector<Json> games = randomGames(LockstepGames::LANES);
+    for(Json& game : games) {
+        game["num_players"] = 4;
+        game["player_settings"].push_back(game["player_settings"][0]);
+        game["player_settings"].push_back(game["player_settings"][1]);
+        game["warriors"].push_back(randomWarrior(generator, 48));
+        game["warriors"].push_back(bomber(0x4000, 0x301));
+    }
+    expectSame(games);
+}
+
+TEST_F(LockstepGamesTest, Threads) {
+    //threads which start part way through an instruction with the cycles of one left to pay
+    const std::vector<Json> games = randomGames(LockstepGames::LANES);
+    std::vector<std::string> images;
+    for(const Json& game : games) images.push_back(withThreads(game, 2, 6));
+    expectSame(images.size(), [&images](size_t x) { return new Game((const uint8_t*)images[x].data(), images[x].size()); },
+               [](const Game& lockstep, const Game& alone) { EXPECT_EQ(state(lockstep), state(alone)); });
+}
+
+TEST_F(LockstepGamesTest, Settings) {
+    //flags left pending and the reference engine give the same results as the flags lockstep computes
+    for(const char* dispatch : {"threaded", "switch"}) {
+        config["dispatch"] = dispatch;
+        config["flags"] = "lazy";
+        const std::vector<Json> games = randomGames(LockstepGames::LANES);
+        expectSame(games.size(), [&games](size_t x) { return new Game(games[x]); },
+                   [](const Game& lockstep, const Game& alone) {
+                       EXPECT_EQ(lockstep.score(1), alone.score(1));
+                       EXPECT_EQ(lockstep.score(2), alone.score(2));
+                       std::stringstream lockstep_ram, alone_ram;
+                       lockstep_ram << lockstep;
+                       alone_ram << alone;
+                       EXPECT_EQ(lockstep_ram.str(), alone_ram.str());
+                   });
+    }
+
+    config["dispatch"] = "threaded";
+    config["flags"] = "eager";
+    config["idle_cycles"] = 500;
+    for(const Json& terminations : {Json{"last_standing", "score_lead"}, Json{"idle"}}) {
+        config["termination"] = terminations;
+        expectSame(randomGames(LockstepGames::LANES));
+    }
+
+    //games which look for loops are run alone
+    config.erase("termination");
+    config["repetition"] = "fast_forward";
+    std::vector<Json> games = randomGames(LockstepGames::LANES);
+    games[0]["warriors"] = {bomber(0x100, 0x107), bomber(0x8000, 0x20B)};
+    expectSame(games);
+}
+
+TEST_F(LockstepGamesTest, Paused) {
+    //games paused in lockstep carry on in lockstep exactly as if they had not stopped
+    const std::vector<Json> configs = randomGames(LockstepGames::LANES);
+    std::vector<std::unique_ptr<Game>> games;
+    std::vector<Game*> lanes;
+    for(const Json& game : configs) {
+        games.emplace_back(new Game(game));
+        games.back()->pauseAt(4321);
+        lanes.push_back(games.back().get());
+    }
+    LockstepGames lockstep;
+    lockstep.run(lanes.data(), lanes.size());
+    //only the games which were paused are run again
+    std::vector<Game*> paused;
+    for(Game* game : lanes) {
+        if(game->endReason() != GameEnd::PAUSED) continue;
+        game->pauseAt(UINT64_MAX);
+        paused.push_back(game);
+    }
+    ASSERT_FALSE(paused.empty());
+    lockstep.run(paused.data(), paused.size());
+
+    for(size_t x = 0; x < configs.size(); ++x) {
+        SCOPED_TRACE(x);
+        Game alone(configs[x]);
+        std::stringstream log;
+        alone.run(log);
+        EXPECT_EQ(games[x]->endReason(), alone.endReason());
+        EXPECT_EQ(state(*games[x]), state(alone));
+    }
+}
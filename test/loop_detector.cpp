@@ -0,0 +1,178 @@
+#include <codec.h>
+#include <game.h>
+#include <instruction.h>
+#include <loop_detector.h>
+#include <ownership.h>
+
+#include "fixtures.h"
+#include "gtest/gtest.h"
+
+#include <random>
+#include <sstream>
+
+
+//Writes through ownership the way instructions do
+static void write(Memory& ram, Ownership& ownership, uint16_t addr, uint8_t byte) {
+    ownership.overwrite(addr, byte);
+    ram[addr] = byte;
+    ownership.write(addr);
+}
+
+TEST(LoopDetectorTest, IncrementalMatchesReset) {
+    Memory ram;
+    Player players[2];
+    Thread slots[64];
+    players[0].threads.init(slots, 32);
+    players[1].threads.init(slots + 32, 32);
+    for(uint16_t x = 0; x < 5; ++x) players[x % 2].threads.spawn(x);
+
+    Ownership ownership(ram);
+    ownership.setPlayers(players, 2);
+    LoopDetector loops;
+    ownership.setDetector(&loops);
+    loops.reset(ram, players, 2, slots, 0);
+
+    std::default_random_engine generator;
+    for(uint32_t x = 0; x < 10000; ++x) {
+        const uint8_t pid = (uint8_t)(1 + generator() % 2);
+        ownership.setWriter(pid);
+        write(ram, ownership, (uint16_t)generator(), (uint8_t)generator());
+
+        //a turn changes the front thread and moves on, the last thread is never killed
+        Player& player = players[pid - 1];
+        player.threads.front().ax = (uint16_t)generator();
+        player.threads.front().cycles = (uint32_t)(generator() % 3);
+        const bool survived = player.threads.size() == 1 || generator() % 100;
+        loops.turn(pid, slots, player, survived);
+        if(survived) player.threads.rotate();
+        else player.threads.kill();
+        loops.moved(pid, slots, player);
+    }
+
+    LoopDetector fresh;
+    fresh.reset(ram, players, 2, slots, 0);
+    EXPECT_EQ(loops.hash(), fresh.hash());
+}
+
+TEST(LoopDetectorTest, FindsLoop) {
+    Memory ram;
+    Player players[1];
+    Ownership ownership(ram);
+    ownership.setPlayers(players, 1);
+    ownership.setWriter(1);
+    LoopDetector loops;
+    ownership.setDetector(&loops);
+    loops.reset(ram, players, 1, nullptr, 0);
+
+    //12 rounds to get into a loop of 5 rounds, each 10 cycles
+    uint64_t found = 0, round;
+    for(round = 1; round < 100 && !found; ++round) {
+        write(ram, ownership, 0x1234, (uint8_t)(round < 12 ? round : 12 + (round - 12) % 5));
+        found = loops.endRound(round * 10);
+    }
+    EXPECT_EQ(found, 5);
+    EXPECT_EQ(loops.loopCycles((round - 1) * 10), 50);
+    EXPECT_LT(round, 2 * (12 + 5));
+}
+
+
+//A warrior which writes AX to the bytes BX points at over and over
+static std::string writer(uint16_t size) {
+    Memory ram;
+    uint16_t addr;
+    for(addr = 0; addr + 2 <= size; addr += 2)
+        Instruction::constructInstruction(ram, addr, OPCode::MOV, AccessMode::DIRECT, AccessMode::DIRECT,
+                                          Location::PBX, Location::AX);
+
+    uint8_t bytes[0x1000];
+    ram.copyBytes(0, addr, bytes);
+    return Codec::base64Encode(bytes, addr);
+}
+
+//Games which settle into a loop: nothing ever dies and the only writes are the same values to the
+// same bytes. Every instruction is 2 bytes and takes a cycle, so each thread gets round RAM in a
+// power of two cycles and the game loops after a few hundred rounds.
+class RepetitionTest : public ::testing::Test {
+protected:
+    Json config;
+
+    RepetitionTest() {
+        config = baseConfig();
+        config["max_player_size"] = 1024;
+        config["cycles_per_turn"] = 64;
+        config["max_cycles"] = 20000000;
+        config["ram_access_cycles"] = 0;
+        config["ram_double_access_penalty"] = 0;
+        config["num_players"] = 3;
+        config["player_settings"].push_back({ {"name", "Amy"}, {"cycle_modifer", 2}, {"max_threads", 3} });
+        //they fight over the same two bytes
+        config["warriors"] = {writer(512), writer(256), writer(1024)};
+        config["op_cycles"] = { {"NOP", 1}, {"MOV", 1} };
+        config["log_events"] = "deaths";
+    }
+
+    //the log, RAM, and scores at the end of the game
+    std::string play(const std::string& repetition, uint64_t* skipped = nullptr) {
+        config["repetition"] = repetition;
+        Game game(config);
+        std::stringstream out;
+        game.run(out);
+        out << game;
+        for(uint8_t pid = 1; pid <= 3; ++pid) out << ' ' << game.score(pid);
+        if(skipped) *skipped = game.skippedCycles();
+        return out.str();
+    }
+};
+
+TEST_F(RepetitionTest, FastForwardMatchesPlaying) {
+    const std::string reference = play("ignore");
+    uint64_t skipped;
+    EXPECT_EQ(play("fast_forward", &skipped), reference);
+    EXPECT_GT(skipped, 10000000);
+}
+
+TEST_F(RepetitionTest, FastForwardMatchesPlayingWithSwitch) {
+    config["dispatch"] = "switch";
+    config["flags"] = "eager";
+    const std::string reference = play("ignore");
+    EXPECT_EQ(play("fast_forward"), reference);
+}
+
+TEST_F(RepetitionTest, FastForwardMatchesPlayingSpeculatively) {
+    const std::string reference = play("ignore");
+    config["parallel_turns"] = 2;
+    EXPECT_EQ(play("fast_forward"), reference);
+}
+
+TEST_F(RepetitionTest, FastForwardMatchesPlayingWithTerminations) {
+    //the writers write whenever a thread is back in their code, which is more often than this
+    config["termination"] = {"idle"};
+    config["idle_cycles"] = 300000;
+    const std::string reference = play("ignore");
+    uint64_t skipped;
+    EXPECT_EQ(play("fast_forward", &skipped), reference);
+    EXPECT_GT(skipped, 0);
+
+    config["termination"] = {"idle", "score_lead"};
+    config["idle_cycles"] = 5000;
+    EXPECT_EQ(play("fast_forward"), play("ignore"));
+}
+
+TEST_F(RepetitionTest, FastForwardReportsSkippedTurns) {
+    config["log_events"] = "turns";
+    EXPECT_EQ(play("ignore").find("\"type\":\"skipped\""), std::string::npos);
+    EXPECT_NE(play("fast_forward").find("\"type\":\"skipped\""), std::string::npos);
+}
+
+TEST_F(RepetitionTest, Draw) {
+    config["repetition"] = "draw";
+    Game draw(config);
+    std::stringstream out;
+    draw.run(out);
+    EXPECT_EQ(draw.endReason(), GameEnd::REPETITION);
+    EXPECT_NE(out.str().find("\"reason\":\"repetition\",\"type\":\"end\",\"winner\":0"), std::string::npos);
+}
+
+TEST_F(RepetitionTest, InvalidRepetition) {
+    EXPECT_THROW(play("sometimes"), std::invalid_argument);
+}
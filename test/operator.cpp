@@ -10,7 +10,7 @@
 
 class OperatorTest : public ::testing::Test {
 protected:
-    uint8_t ram[0x10] = {
+    Memory ram = {
             0x00, 0x00, 0x00, 0x04,
             0x03, 0x11, 0x22, 0x07,
             0x12, 0x53, 0xC3, 0x32,
@@ -149,7 +149,7 @@ TEST_F(OperatorTest, Div8b) {
     thread.cx = 0;
     {
         CONSTRUCT_ARGS;
-        EXPECT_THROW(Operator::div(thread, arg1), std::runtime_error);
+        EXPECT_EQ(Operator::div(thread, arg1), Fault::DIVIDE_BY_ZERO);
     }
 }
 
@@ -176,7 +176,7 @@ TEST_F(OperatorTest, Div16b) {
     thread.cx = 0;
     {
         CONSTRUCT_ARGS;
-        EXPECT_THROW(Operator::div(thread, arg1), std::runtime_error);
+        EXPECT_EQ(Operator::div(thread, arg1), Fault::DIVIDE_BY_ZERO);
     }
 }
 
@@ -203,7 +203,7 @@ TEST_F(OperatorTest, Idiv8b) {
     thread.cx = 0;
     {
         CONSTRUCT_ARGS;
-        EXPECT_THROW(Operator::idiv(thread, arg1), std::runtime_error);
+        EXPECT_EQ(Operator::idiv(thread, arg1), Fault::DIVIDE_BY_ZERO);
     }
 }
 
@@ -230,7 +230,7 @@ TEST_F(OperatorTest, Idiv16b) {
     thread.cx = 0;
     {
         CONSTRUCT_ARGS;
-        EXPECT_THROW(Operator::idiv(thread, arg1), std::runtime_error);
+        EXPECT_EQ(Operator::idiv(thread, arg1), Fault::DIVIDE_BY_ZERO);
     }
 }
 
@@ -938,4 +938,103 @@ TEST_F(OperatorTest, Test16b) {
         EXPECT_FALSE(thread.s);
         EXPECT_TRUE(thread.z);
     }
-}
\ No newline at end of file
+}
+
+//Runs the operator for op on arguments which check their type at runtime
+static Fault runOperator(OPCode op, Thread& thread, Argument& arg1, Argument& arg2) {
+    switch(op) {
+        case OPCode::MOV:  Operator::mov(arg1, arg2); break;
+        case OPCode::SWP:  Operator::swp(arg1, arg2); break;
+        case OPCode::ADD:  Operator::add(thread, arg1, arg2); break;
+        case OPCode::SUB:  Operator::sub(thread, arg1, arg2); break;
+        case OPCode::MUL:  Operator::mul(thread, arg1); break;
+        case OPCode::IMUL: Operator::imul(thread, arg1); break;
+        case OPCode::DIV:  return Operator::div(thread, arg1);
+        case OPCode::IDIV: return Operator::idiv(thread, arg1);
+        case OPCode::SHL:  Operator::shl(thread, arg1, arg2); break;
+        case OPCode::SHR:  Operator::shr(thread, arg1, arg2); break;
+        case OPCode::NEG:  Operator::neg(thread, arg1); break;
+        case OPCode::NOT:  Operator::_not(arg1); break;
+        case OPCode::AND:  Operator::_and(thread, arg1, arg2); break;
+        case OPCode::OR:   Operator::_or(thread, arg1, arg2); break;
+        case OPCode::XOR:  Operator::_xor(thread, arg1, arg2); break;
+        case OPCode::INC:  Operator::inc(thread, arg1); break;
+        case OPCode::DEC:  Operator::dec(thread, arg1); break;
+        case OPCode::CMP:  Operator::cmp(thread, arg1, arg2); break;
+        case OPCode::TEST: Operator::test(thread, arg1, arg2); break;
+        default: break;
+    }
+    return Fault::NONE;
+}
+
+TEST(OperatorHandlerTest, MatchesOperators) {
+    static Memory ram, ram_ref;
+    const OPCode ops[] = {
+            OPCode::MOV, OPCode::SWP, OPCode::ADD, OPCode::SUB, OPCode::MUL, OPCode::IMUL,
+            OPCode::DIV, OPCode::IDIV, OPCode::SHL, OPCode::SHR, OPCode::NEG, OPCode::NOT,
+            OPCode::AND, OPCode::OR, OPCode::XOR, OPCode::INC, OPCode::DEC, OPCode::CMP, OPCode::TEST
+    };
+    const Location locs[] = {
+            Location::AL, Location::BH, Location::CX,
+            Location::PAX, Location::IMD, Location::PIMD
+    };
+    const uint16_t values[] = { 0x0000, 0x0001, 0x007F, 0x0080, 0x00FF, 0x8000, 0xFFFF, 0x1234 };
+
+    for(bool lazy : {false, true})
+    for(OPCode op : ops) for(Location loc1 : locs) for(Location loc2 : locs) for(uint16_t v : values) {
+        for(uint32_t x = 0; x < 0x10000; ++x) ram[x] = (uint8_t)(x * 37 + v);
+        Instruction::constructInstruction(ram, 0, op, AccessMode::DIRECT, AccessMode::DIRECT, loc1, loc2);
+        Thread thread;
+        thread.ax = v; thread.bx = (uint16_t)(v ^ 0x5A5A); thread.cx = 3;
+        ram_ref = ram;
+        Thread thread_ref = thread;
+
+        Argument arg1(thread, ram, 1), arg2(thread, ram, 2);
+        Argument ref1(thread_ref, ram_ref, 1), ref2(thread_ref, ram_ref, 2);
+        const Operator::Handler handler = Operator::getHandler(op, arg1.type(), arg2.type(), lazy);
+        ASSERT_NE(handler, nullptr);
+
+        const Fault fault = handler(thread, arg1, arg2);
+        thread.resolveFlags();
+        const Fault fault_ref = runOperator(op, thread_ref, ref1, ref2);
+
+        SCOPED_TRACE(OPCodeToString(op) + " " + LocationToString(loc1) + ", " + LocationToString(loc2) +
+                     (lazy ? " lazy" : ""));
+        EXPECT_EQ(fault, fault_ref);
+        EXPECT_EQ(thread.ax, thread_ref.ax);
+        EXPECT_EQ(thread.bx, thread_ref.bx);
+        EXPECT_EQ(thread.cx, thread_ref.cx);
+        EXPECT_EQ(thread.ip, thread_ref.ip);
+        EXPECT_EQ(thread.o, thread_ref.o);
+        EXPECT_EQ(thread.s, thread_ref.s);
+        EXPECT_EQ(thread.z, thread_ref.z);
+        EXPECT_EQ(thread.c, thread_ref.c);
+        ASSERT_TRUE(ram == ram_ref);
+    }
+}
+
+TEST(OperatorHandlerTest, LazyFlagsKeptByPartialOperators) {
+    static Memory ram;
+    Instruction::constructInstruction(ram, 0, OPCode::ADD, AccessMode::DIRECT, AccessMode::DIRECT,
+                                      Location::AL, Location::BL);
+    Thread thread;
+    thread.ax = 0x00FF;
+    thread.bx = 0x0001;
+    Argument arg1(thread, ram, 1), arg2(thread, ram, 2);
+
+    //the carry from the add must survive the inc which does not set it
+    Operator::getHandler(OPCode::ADD, arg1.type(), arg2.type(), true)(thread, arg1, arg2);
+    EXPECT_EQ(thread.pending.op, FlagOp::ADD);
+    Operator::getHandler(OPCode::INC, arg1.type(), arg2.type(), true)(thread, arg1, arg2);
+    EXPECT_EQ(thread.pending.op, FlagOp::NONE);
+    EXPECT_EQ(thread.ax, 0x0001);
+    EXPECT_TRUE(thread.c);
+    EXPECT_FALSE(thread.z);
+
+    //an eager operator replaces anything pending
+    Operator::getHandler(OPCode::CMP, arg1.type(), arg2.type(), true)(thread, arg1, arg2);
+    Operator::_xor(thread, arg1, arg2);
+    EXPECT_EQ(thread.pending.op, FlagOp::NONE);
+    EXPECT_FALSE(thread.c);
+    EXPECT_TRUE(thread.z);
+}
@@ -0,0 +1,104 @@
+#include <ownership.h>
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <random>
+
+
+class OwnershipTest : public ::testing::Test {
+protected:
+    Memory ram;
+    Player players[3];
+    Ownership ownership;
+    std::default_random_engine generator;
+
+    OwnershipTest() : ownership(ram) {
+        for(uint16_t x = 0; x < 0x100; ++x) ram.owner(0x1000 + x) = 1;
+        for(uint16_t x = 0; x < 0x80; ++x) ram.owner(0x8000 + x) = 2;
+        ownership.setPlayers(players, 3);
+    }
+};
+
+TEST_F(OwnershipTest, Count) {
+    for(size_t size : {0, 1, 15, 16, 17, 4095, 4096, 4097, 0x10000}) {
+        uint8_t bytes[0x10000];
+        for(size_t x = 0; x < size; ++x) bytes[x] = (uint8_t)(generator() % 4);
+        for(uint8_t owner = 0; owner < 4; ++owner)
+            EXPECT_EQ(Memory::count(bytes, size, owner), std::count(bytes, bytes + size, owner));
+    }
+}
+
+TEST_F(OwnershipTest, CountOwned) {
+    for(uint32_t x = 0; x < 0x10000; ++x) ram.owner((uint16_t)x) = (uint8_t)(generator() % 4);
+    uint8_t owners[0x10000];
+    ram.copyOwners(0, 0x10000, owners);
+    for(uint8_t owner = 0; owner < 4; ++owner)
+        EXPECT_EQ(ram.countOwned(owner), std::count(owners, owners + 0x10000, owner));
+}
+
+TEST_F(OwnershipTest, Loaded) {
+    EXPECT_EQ(players[0].owned_ram, 0x100);
+    EXPECT_EQ(players[1].owned_ram, 0x80);
+    EXPECT_EQ(players[2].owned_ram, 0);
+}
+
+TEST_F(OwnershipTest, Write) {
+    ownership.setWriter(3);
+    ownership.write(0x1000, 2); //taken from player 1
+    ownership.write(0xFFFF, 2); //wraps around to 0, both unowned
+    ownership.write(0xFFFF, 2); //already owned by the writer
+    EXPECT_EQ(players[0].owned_ram, 0xFE);
+    EXPECT_EQ(players[2].owned_ram, 4);
+    EXPECT_EQ(ram.owner(0x1000), 3);
+    EXPECT_EQ(ram.owner(0), 3);
+    EXPECT_TRUE(ownership.recount());
+}
+
+TEST_F(OwnershipTest, MatchesRecount) {
+    std::uniform_int_distribution<uint16_t> addr(0, 0xFFFF);
+    for(uint32_t x = 0; x < 100000; ++x) {
+        ownership.setWriter((uint8_t)(generator() % 3 + 1));
+        ownership.write(addr(generator), (uint8_t)(generator() % 2 + 1));
+    }
+    EXPECT_TRUE(ownership.recount());
+
+    //a drifted count is corrected
+    players[1].owned_ram += 5;
+    EXPECT_FALSE(ownership.recount());
+    EXPECT_TRUE(ownership.recount());
+}
+
+TEST(MemoryTest, CopiesAreIndependent) {
+    Memory ram;
+    for(uint32_t x = 0; x < Memory::SIZE; x += 7) {
+        ram[(uint16_t)x] = (uint8_t)(x / 7);
+        ram.owner((uint16_t)x) = 1;
+    }
+    Memory copy(ram);
+    EXPECT_EQ(copy, ram);
+
+    copy[700] = 0xFF;
+    copy.owner(14000) = 2;
+    EXPECT_NE(copy, ram);
+    EXPECT_EQ(ram[700], 100);
+    EXPECT_EQ(ram.owner(14000), 1);
+    EXPECT_EQ(copy.countOwned(1) + 1, ram.countOwned(1));
+#ifdef OBLIVIOS_PAGED_MEMORY
+    //only the pages which were written were copied
+    EXPECT_EQ(ram.sharedPages(), Memory::NUM_PAGES - 2);
+#else
+    EXPECT_EQ(ram.sharedPages(), 0);
+#endif
+
+    Memory assigned;
+    assigned = copy;
+    assigned.clear();
+    EXPECT_EQ(assigned, Memory());
+    EXPECT_EQ(copy[700], 0xFF);
+
+    //copies out of several pages, wrapping round the end of RAM
+    uint8_t bytes[0x400];
+    copy.copyBytes(0xFF80, sizeof(bytes), bytes);
+    for(uint16_t x = 0; x < sizeof(bytes); ++x) EXPECT_EQ(bytes[x], copy[(uint16_t)(0xFF80 + x)]);
+}
@@ -0,0 +1,89 @@
+#include <run_list.h>
+
+#include "gtest/gtest.h"
+
+#include <deque>
+#include <random>
+
+
+TEST(RunListTest, Rotation) {
+    Thread slots[4];
+    RunList list;
+    list.init(slots, 4);
+    EXPECT_TRUE(list.empty());
+
+    list.spawn(10);
+    list.spawn(20);
+    list.spawn(30);
+    EXPECT_EQ(list.size(), 3);
+    for(uint16_t ip : {10, 20, 30, 10, 20}) {
+        EXPECT_EQ(list.front().ip, ip);
+        list.rotate();
+    }
+
+    //new threads go to the back, after the one whose turn just ended
+    list.spawn(40);
+    for(uint16_t ip : {30, 10, 20, 40, 30}) {
+        EXPECT_EQ(list.front().ip, ip);
+        list.rotate();
+    }
+}
+
+TEST(RunListTest, Capacity) {
+    Thread slots[2];
+    RunList list;
+    list.init(slots, 2);
+    EXPECT_NE(list.spawn(1), nullptr);
+    EXPECT_NE(list.spawn(2), nullptr);
+    EXPECT_EQ(list.spawn(3), nullptr);
+
+    //a dead thread's slot is reused
+    list.kill();
+    Thread* thread = list.spawn(4);
+    ASSERT_NE(thread, nullptr);
+    EXPECT_EQ(thread->ip, 4);
+    EXPECT_EQ(thread->cycles, 0);
+    EXPECT_GE(thread, slots);
+    EXPECT_LT(thread, slots + 2);
+
+    list.kill();
+    list.kill();
+    EXPECT_TRUE(list.empty());
+}
+
+TEST(RunListTest, MatchesQueue) {
+    const size_t CAPACITY = 16;
+    Thread slots[CAPACITY];
+    RunList list;
+    list.init(slots, CAPACITY);
+    std::deque<uint16_t> queue;
+
+    std::default_random_engine generator(7);
+    for(uint16_t x = 0; x < 10000; ++x) {
+        switch(generator() % 3) {
+            case 0:
+                if(queue.size() < CAPACITY) {
+                    list.spawn(x);
+                    queue.push_back(x);
+                }
+                else EXPECT_EQ(list.spawn(x), nullptr);
+                break;
+            case 1:
+                if(queue.empty()) break;
+                list.rotate();
+                queue.push_back(queue.front());
+                queue.pop_front();
+                break;
+            case 2:
+                if(queue.empty()) break;
+                list.kill();
+                queue.pop_front();
+                break;
+        }
+
+        ASSERT_EQ(list.size(), queue.size());
+        if(!queue.empty()) {
+            ASSERT_EQ(list.front().ip, queue.front());
+        }
+    }
+}
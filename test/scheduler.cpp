@@ -0,0 +1,110 @@
+#include <game.h>
+
+#include "fixtures.h"
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+
+//Games where most turns only stall on instructions which take several turns
+class SchedulerTest : public ::testing::Test {
+protected:
+    Json config;
+
+    SchedulerTest() {
+        config = baseConfig();
+        config["max_player_size"] = 256;
+        config["cycles_per_turn"] = 40;
+        config["max_cycles"] = 400000;
+        config["num_players"] = 200;
+        config["player_settings"] = Json::array();
+        config["warriors"] = Json::array();
+        config["op_cycles"] = { {"NOP", 1}, {"MOV", 170}, {"ADD", 90} };
+        for(uint32_t x = 0; x < 200; ++x) {
+            const double modifiers[] = {1, 0.5, 1.7, 3.1};
+            config["player_settings"].push_back({
+                {"name", "Warrior_" + std::to_string(x)}, {"cycle_modifer", modifiers[x % 4]},
+                {"max_threads", 1 + x % 5}
+            });
+            config["warriors"].push_back(bomber((uint16_t)(x * 0x2B9), (uint16_t)(0x0101 + 0x36 * x), 12));
+        }
+    }
+
+    //the log, RAM, and scores at the end of the game
+    std::string play(const std::string& scheduler) {
+        config["scheduler"] = scheduler;
+        Game game(config);
+        std::stringstream out;
+        game.run(out);
+        out << game;
+        for(uint8_t pid = 1; pid <= 200; ++pid) out << ' ' << game.score(pid);
+        return out.str();
+    }
+};
+
+TEST_F(SchedulerTest, MatchesRounds) {
+    for(const char* events : {"full", "turns", "deaths", "none"}) {
+        config["log_events"] = events;
+        const std::string reference = play("rounds");
+        EXPECT_EQ(play("events"), reference) << events;
+    }
+}
+
+TEST_F(SchedulerTest, MatchesRoundsWithSwitch) {
+    config["dispatch"] = "switch";
+    config["log_events"] = "deaths";
+    const std::string reference = play("rounds");
+    EXPECT_EQ(play("events"), reference);
+}
+
+TEST_F(SchedulerTest, MatchesRoundsWithTerminations) {
+    config["log_events"] = "deaths";
+    config["termination"] = {"last_standing", "idle"};
+    config["idle_cycles"] = 20000;
+    const std::string reference = play("rounds");
+    EXPECT_EQ(play("events"), reference);
+}
+
+TEST_F(SchedulerTest, MatchesRoundsWithThreads) {
+    //every player starts with all its threads, so players skip turns of several threads at a time
+    //and lose threads part way through
+    config["log_events"] = "deaths";
+    std::string results[2];
+    for(const std::string scheduler : {"rounds", "events"}) {
+        config["scheduler"] = scheduler;
+        const std::string image = withThreads(config, 8, 6);
+        Game game((const uint8_t*)image.data(), image.size());
+        std::stringstream out;
+        game.run(out);
+        out << game;
+        for(uint8_t pid = 1; pid <= 200; ++pid) out << ' ' << game.score(pid);
+        results[scheduler == "events"] = out.str();
+    }
+    EXPECT_EQ(results[1], results[0]);
+}
+
+TEST_F(SchedulerTest, ThreadsAreUpToDateAfterRun) {
+    //a game which went idle carries on from where its threads were left when it is run again
+    config["log_events"] = "deaths";
+    config["termination"] = {"idle"};
+    config["idle_cycles"] = 1;
+    std::string results[2];
+    for(const std::string scheduler : {"rounds", "events"}) {
+        config["scheduler"] = scheduler;
+        Game game(config);
+        std::stringstream out;
+        uint32_t runs = 0;
+        do {
+            game.run(out);
+            ++runs;
+        } while(game.endReason() == GameEnd::IDLE);
+        out << game << ' ' << runs;
+        results[scheduler == "events"] = out.str();
+        EXPECT_GT(runs, 1);
+    }
+    EXPECT_EQ(results[1], results[0]);
+}
+
+TEST_F(SchedulerTest, InvalidScheduler) {
+    EXPECT_THROW(play("sometimes"), std::invalid_argument);
+}
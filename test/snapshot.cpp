@@ -0,0 +1,145 @@
+#include <game.h>
+#include <snapshot.h>
+
+#include "fixtures.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <random>
+#include <sstream>
+
+
+class SnapshotTest : public ::testing::Test {
+protected:
+    Memory ram;
+    DirtyPages dirty;
+    std::stringstream stream;
+    std::default_random_engine generator;
+
+    //Writes to random places the way an instruction would
+    void scribble(uint32_t writes) {
+        std::uniform_int_distribution<uint16_t> addr(0, 0xFFFF);
+        for(uint32_t x = 0; x < writes; ++x) {
+            const uint16_t a = addr(generator);
+            ram[a] = (uint8_t)generator();
+            ram[(uint16_t)(a + 1)] = (uint8_t)generator();
+            ram.owner(a) = ram.owner((uint16_t)(a + 1)) = (uint8_t)(x % 3 + 1);
+            dirty.mark(a, 2);
+        }
+    }
+
+    //Reads the rest of the stream and checks it ends in the current state
+    void expectState(SnapshotReader& reader, uint64_t cycle) {
+        while(reader.next());
+        EXPECT_TRUE(reader.isSynced());
+        EXPECT_EQ(reader.cycle, cycle);
+        uint8_t bytes[0x10000];
+        ram.copyBytes(0, 0x10000, bytes);
+        EXPECT_TRUE(std::equal(bytes, bytes + 0x10000, reader.ram));
+        ram.copyOwners(0, 0x10000, bytes);
+        EXPECT_TRUE(std::equal(bytes, bytes + 0x10000, reader.pid));
+    }
+};
+
+TEST_F(SnapshotTest, RoundTrip) {
+    SnapshotWriter writer(stream, 1000);
+    for(uint64_t cycle = 0; cycle < 5000; cycle += 100) {
+        scribble(cycle % 700 + 1);
+        writer.write(cycle, ram, dirty);
+        EXPECT_FALSE(dirty.any());
+    }
+
+    SnapshotReader reader(stream);
+    expectState(reader, 4900);
+}
+
+TEST_F(SnapshotTest, DeltasAreSmall) {
+    SnapshotWriter writer(stream, 1000000);
+    writer.write(0, ram, dirty);
+    const std::streamoff keyframe = stream.tellp();
+
+    writer.write(1, ram, dirty); //nothing changed so nothing is written
+    EXPECT_EQ(stream.tellp(), keyframe);
+
+    dirty.mark(0x1234, 2);
+    dirty.mark(0x12FF, 2); //crosses into the next page
+    writer.write(2, ram, dirty);
+    EXPECT_EQ(stream.tellp() - keyframe, 1 + 8 + 2 + 2 + 2 * 2 * DirtyPages::PAGE_SIZE);
+}
+
+TEST_F(SnapshotTest, LateJoin) {
+    SnapshotWriter writer(stream, 1000000);
+    scribble(100);
+    writer.write(0, ram, dirty);
+    scribble(100);
+    writer.write(1, ram, dirty);
+
+    //a viewer joining now only gets the stream from the next keyframe
+    const std::streamoff joined = stream.tellp();
+    scribble(100);
+    writer.keyframe(2, ram);
+    scribble(100);
+    writer.write(3, ram, dirty);
+
+    std::stringstream late(stream.str().substr((size_t)joined));
+    SnapshotReader reader(late);
+    expectState(reader, 3);
+}
+
+TEST_F(SnapshotTest, DeltaBeforeKeyframe) {
+    SnapshotWriter writer(stream, 1000000);
+    writer.write(0, ram, dirty);
+    const std::streamoff joined = stream.tellp();
+    scribble(10);
+    writer.write(1, ram, dirty);
+
+    std::stringstream late(stream.str().substr((size_t)joined));
+    SnapshotReader reader(late);
+    EXPECT_TRUE(reader.next());
+    EXPECT_FALSE(reader.isSynced());
+    EXPECT_FALSE(reader.next());
+}
+
+TEST_F(SnapshotTest, Invalid) {
+    std::stringstream bad(std::string("\x00OBSX\x01", 6));
+    SnapshotReader reader(bad);
+    EXPECT_THROW(reader.next(), std::runtime_error);
+
+    SnapshotWriter writer(stream, 1);
+    writer.write(0, ram, dirty);
+    std::stringstream truncated(stream.str().substr(0, 1000));
+    SnapshotReader reader2(truncated);
+    EXPECT_TRUE(reader2.next());
+    EXPECT_THROW(reader2.next(), std::runtime_error);
+}
+
+TEST(GameSnapshotTest, MatchesRam) {
+    Json config = baseConfig();
+    config["keyframe_cycles"] = 5000;
+    Game game(config);
+    std::stringstream log, snapshots;
+    game.run(log, snapshots);
+
+    SnapshotReader reader(snapshots);
+    uint32_t records = 0;
+    while(reader.next()) ++records;
+    EXPECT_GE(records, 1 + 20000 / 5000); //the header and a keyframe every 5000 cycles
+
+    //print the snapshot's RAM the same way a game prints its RAM
+    std::stringstream expected, actual;
+    expected << game;
+    char buffer[3];
+    for(uint32_t x = 0; x < 0x10000; ++x) {
+        snprintf(buffer, 3, "%02X", reader.ram[x]);
+        actual << buffer << ((x + 1) % 64 == 0 ? '\n' : ' ');
+    }
+    EXPECT_EQ(actual.str(), expected.str());
+    EXPECT_LT(snapshots.str().size(), 0x20000 * 10);
+
+    //scores are kills, which are worth multiples of 1000, plus the RAM owned at the end
+    for(uint8_t p = 1; p <= 2; ++p) {
+        const uint32_t territory = (uint32_t)((float)Memory::count(reader.pid, 0x10000, p) * 0.1f);
+        EXPECT_GE(game.score(p), territory);
+        EXPECT_EQ((game.score(p) - territory) % 1000, 0);
+    }
+}
@@ -0,0 +1,105 @@
+#include <game.h>
+
+#include "fixtures.h"
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+
+class SpeculativeTurnsTest : public ::testing::Test {
+protected:
+    Json config;
+
+    SpeculativeTurnsTest() {
+        config = baseConfig();
+        config["max_player_size"] = 1024;
+        config["num_players"] = 16;
+        config["player_settings"] = Json::array();
+        config["warriors"] = Json::array();
+        for(uint32_t x = 0; x < 16; ++x) {
+            config["player_settings"].push_back({
+                {"name", "Warrior_" + std::to_string(x)}, {"cycle_modifer", x % 3 ? 1 : 0.5}, {"max_threads", 3}
+            });
+            //half bomb the same bytes as each other so their turns conflict, the rest rarely do
+            config["warriors"].push_back(x % 2 ? bomber((uint16_t)(x * 0x1357), (uint16_t)(0x0F0F + 0x22 * x)) :
+                                                 bomber(0x8000, 0x0101));
+        }
+    }
+
+    //the log, RAM, and scores at the end of the game
+    std::string play(uint32_t parallel_turns, uint64_t* reruns = nullptr) {
+        config["parallel_turns"] = parallel_turns;
+        Game game(config);
+        std::stringstream out;
+        game.run(out);
+        out << game;
+        for(uint8_t pid = 1; pid <= 16; ++pid) out << ' ' << game.score(pid);
+        if(reruns) *reruns = game.rerunTurns();
+        return out.str();
+    }
+};
+
+TEST_F(SpeculativeTurnsTest, MatchesTurnsInOrder) {
+    const std::string reference = play(0);
+    uint64_t reruns;
+    EXPECT_EQ(play(1, &reruns), reference);
+    EXPECT_GT(reruns, 0);
+    EXPECT_EQ(play(4), reference);
+    EXPECT_EQ(play(16), reference);
+}
+
+TEST_F(SpeculativeTurnsTest, MatchesTurnsInOrderForLogEvents) {
+    for(const char* events : {"turns", "deaths", "none"}) {
+        config["log_events"] = events;
+        const std::string reference = play(0);
+        EXPECT_EQ(play(3), reference);
+    }
+}
+
+TEST_F(SpeculativeTurnsTest, MatchesTurnsInOrderRewriting) {
+    //bombing the same byte over and over changes nothing after the first time, but it still keeps
+    //the game from going idle and marks the byte's page for the snapshots
+    for(uint32_t x = 0; x < 16; ++x) config["warriors"][x] = bomber((uint16_t)(0x0800 + x * 0x1000), 0);
+    auto snapshots = [this](uint32_t parallel_turns) {
+        config["parallel_turns"] = parallel_turns;
+        Game game(config);
+        std::stringstream log, out;
+        game.run(log, out);
+        return out.str();
+    };
+    config["keyframe_cycles"] = 5000;
+    const std::string reference = snapshots(0);
+    EXPECT_EQ(snapshots(3), reference);
+
+    config["max_cycles"] = 200000;
+    config["termination"] = {"idle"};
+    config["idle_cycles"] = 1000;
+    const std::string idle = play(0);
+    EXPECT_EQ(play(3), idle);
+}
+
+TEST_F(SpeculativeTurnsTest, MatchesTurnsInOrderWithSwitch) {
+    config["dispatch"] = "switch";
+    config["cycles_per_turn"] = 3;
+    const std::string reference = play(0);
+    EXPECT_EQ(play(5), reference);
+}
+
+TEST_F(SpeculativeTurnsTest, Reset) {
+    config["parallel_turns"] = 2;
+    Game game(config);
+    std::stringstream first, second;
+    game.run(first);
+    config["seed"] = 7;
+    game.reset(config);
+    game.run(second);
+    second << game;
+    for(uint8_t pid = 1; pid <= 16; ++pid) second << ' ' << game.score(pid);
+    EXPECT_EQ(second.str(), play(0));
+}
+
+TEST_F(SpeculativeTurnsTest, NotSpeculative) {
+    uint64_t reruns;
+    play(0, &reruns);
+    EXPECT_EQ(reruns, 0);
+}
@@ -0,0 +1,119 @@
+#include <game.h>
+#include <tournament.h>
+
+#include "fixtures.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+
+
+class TournamentTest : public ::testing::Test {
+protected:
+    Json config, pool;
+
+    TournamentTest() {
+        config = baseConfig();
+        pool = {
+            {"seeds", 3},
+            {"warriors", {
+                { {"name", "Joe"}, {"cycle_modifer", 1}, {"max_threads", 3},
+                  {"warrior", "CKb/3gAAEHYJ5//8UAn/9EYN//Q="} },
+                { {"name", "Bob"}, {"cycle_modifer", 1}, {"max_threads", 1},
+                  {"warrior", "CKb/3gAAEHYJ5//8UAn/9EYN//Q="} },
+                { {"name", "Sue"}, {"cycle_modifer", 1}, {"max_threads", 3}, {"warrior", "AAAAAAAA"} },
+                { {"name", "Ann"}, {"cycle_modifer", 0.5}, {"max_threads", 3}, {"warrior", "CKb/3gAA"} }
+            }}
+        };
+    }
+};
+
+TEST_F(TournamentTest, Matches) {
+    Tournament tournament(config, pool);
+    const std::vector<MatchResult>& matches = tournament.getMatches();
+    ASSERT_EQ(matches.size(), 6 * 3 * 2);
+    EXPECT_EQ(matches[0].players[0], 0);
+    EXPECT_EQ(matches[0].players[1], 1);
+    EXPECT_EQ(matches[1].players[0], 1);
+    EXPECT_EQ(matches[1].players[1], 0);
+    EXPECT_EQ(matches[1].seed, 42);
+    EXPECT_EQ(matches[4].seed, 44);
+    EXPECT_EQ(matches.back().players[0], 3);
+    EXPECT_EQ(matches.back().players[1], 2);
+}
+
+TEST_F(TournamentTest, SeatsAreFair) {
+    //the standings are the same whichever order the warriors are listed in
+    auto standings = [this]() {
+        Tournament tournament(config, pool);
+        tournament.run(4);
+        const Json results = tournament.results();
+        std::map<std::string, Json> by_name;
+        for(const Json& standing : results["standings"]) by_name[standing["name"]] = standing;
+        return by_name;
+    };
+    const std::map<std::string, Json> reference = standings();
+    ASSERT_EQ(reference.size(), 4);
+    std::reverse(pool["warriors"].begin(), pool["warriors"].end());
+    EXPECT_EQ(standings(), reference);
+    std::swap(pool["warriors"][0], pool["warriors"][2]);
+    EXPECT_EQ(standings(), reference);
+}
+
+TEST_F(TournamentTest, MatchesSingleGames) {
+    Tournament tournament(config, pool);
+    tournament.run(4);
+
+    for(const MatchResult& match : tournament.getMatches()) {
+        Json game_config = config;
+        game_config["num_players"] = 2;
+        game_config["seed"] = match.seed;
+        game_config["player_settings"] = Json::array({pool["warriors"][match.players[0]],
+                                                      pool["warriors"][match.players[1]]});
+        game_config["warriors"] = Json::array({pool["warriors"][match.players[0]]["warrior"],
+                                               pool["warriors"][match.players[1]]["warrior"]});
+        Game game(game_config);
+        std::stringstream log;
+        game.run(log);
+
+        EXPECT_TRUE(match.error.empty());
+        EXPECT_EQ(match.scores[0], game.score(1));
+        EXPECT_EQ(match.scores[1], game.score(2));
+    }
+}
+
+TEST_F(TournamentTest, Results) {
+    Tournament tournament(config, pool);
+    tournament.run();
+    const Json results = tournament.results();
+
+    ASSERT_EQ(results["matches"].size(), 36);
+    EXPECT_EQ(results["matches"][0]["players"], Json::array({"Joe", "Bob"}));
+    EXPECT_EQ(results["matches"][0]["seed"], 42);
+
+    const Json& standings = results["standings"];
+    ASSERT_EQ(standings.size(), 4);
+    uint32_t games = 0;
+    for(const Json& s : standings) games += (uint32_t)s["wins"] + (uint32_t)s["draws"] + (uint32_t)s["losses"];
+    EXPECT_EQ(games, 36 * 2);
+    for(size_t x = 1; x < standings.size(); ++x) {
+        const uint32_t prev = 3 * (uint32_t)standings[x - 1]["wins"] + (uint32_t)standings[x - 1]["draws"];
+        const uint32_t cur = 3 * (uint32_t)standings[x]["wins"] + (uint32_t)standings[x]["draws"];
+        EXPECT_GE(prev, cur);
+    }
+}
+
+TEST_F(TournamentTest, Errors) {
+    //a warrior which cannot be loaded loses nothing, its games are reported as errors
+    pool["warriors"][2]["warrior"] = "";
+    Tournament tournament(config, pool);
+    tournament.run(2);
+    for(const MatchResult& match : tournament.getMatches())
+        EXPECT_EQ(match.error.empty(), match.players[0] != 2 && match.players[1] != 2);
+
+    EXPECT_THROW(Tournament(config, Json::object()), std::invalid_argument);
+    EXPECT_THROW(Tournament(config, {{"warriors", Json::array({pool["warriors"][0]})}}), std::invalid_argument);
+    pool["warriors"][1].erase("warrior");
+    EXPECT_THROW(Tournament(config, pool), std::invalid_argument);
+}
@@ -0,0 +1,48 @@
+#include <work_stealing_pool.h>
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <thread>
+
+
+TEST(WorkStealingPoolTest, RunsEveryTask) {
+    WorkStealingPool pool(4);
+    EXPECT_EQ(pool.size(), 4);
+
+    std::atomic<uint32_t> sum(0);
+    for(uint32_t x = 1; x <= 1000; ++x) pool.submit([&sum, x]{ sum += x; });
+    pool.wait();
+    EXPECT_EQ(sum, 500500);
+
+    //the pool can be reused after waiting
+    for(uint32_t x = 0; x < 10; ++x) pool.submit([&sum]{ ++sum; });
+    pool.wait();
+    EXPECT_EQ(sum, 500510);
+}
+
+TEST(WorkStealingPoolTest, StealsFromBusyWorkers) {
+    //every 4th task goes to the first worker and is slow, the others must take some of the rest of
+    // its queue or it would run all of them itself
+    std::mutex mutex;
+    std::set<std::thread::id> runners;
+    {
+        WorkStealingPool pool(4);
+        for(uint32_t x = 0; x < 64; ++x) {
+            const bool slow = x % 4 == 0;
+            pool.submit([&, slow]{
+                if(slow) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                std::lock_guard<std::mutex> lock(mutex);
+                if(slow) runners.insert(std::this_thread::get_id());
+            });
+        }
+    }
+    EXPECT_GT(runners.size(), 1);
+}
+
+TEST(WorkStealingPoolTest, DefaultSize) {
+    WorkStealingPool pool;
+    EXPECT_GE(pool.size(), 1);
+}
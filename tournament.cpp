@@ -0,0 +1,60 @@
+#include "tournament.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+
+static bool readJson(const char* path, Json& json) {
+    std::ifstream file(path);
+    if(!file) {
+        std::cerr << "Could not open " << path << std::endl;
+        return false;
+    }
+    try { file >> json; }
+    catch(std::exception& e) {
+        std::cerr << path << ": " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+//Plays every pair of warriors in a pool against each other and writes the results as JSON
+//usage: oblivios_tournament [config] [pool] [results] [threads]
+//  config is the base game config such as data/default.json, pool is described in Tournament,
+//  results go to stdout if not given, and threads defaults to one per core
+int main(int argc, char** argv) {
+    if(argc < 3) {
+        std::cerr << "usage: " << argv[0] << " [config] [pool] [results] [threads]" << std::endl;
+        return 1;
+    }
+
+    Json config, pool;
+    if(!readJson(argv[1], config) || !readJson(argv[2], pool)) return 1;
+    const size_t threads = argc > 4 ? (size_t)std::strtoul(argv[4], nullptr, 10) : 0;
+
+    try {
+        Tournament tournament(config, pool);
+        const auto start = std::chrono::steady_clock::now();
+        tournament.run(threads);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cerr << tournament.getMatches().size() << " matches in " << elapsed.count() << "s" << std::endl;
+
+        if(argc > 3) {
+            std::ofstream out(argv[3]);
+            if(!out) {
+                std::cerr << "Could not open " << argv[3] << std::endl;
+                return 1;
+            }
+            out << tournament.results().dump(2) << std::endl;
+        }
+        else std::cout << tournament.results().dump(2) << std::endl;
+    }
+    catch(std::invalid_argument& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}